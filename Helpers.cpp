@@ -6,7 +6,13 @@
 #include <algorithm>
 #include <atomic>
 #include <chrono>
+#include <cmath>
 #include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <climits>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -14,11 +20,369 @@
 #include <stdexcept>
 #include <vector>
 #include <limits>
+#include <map>
+#include <mutex>
 #include <random>
+#include <set>
 #include "Helpers.h"
 
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <cpuid.h>
+#endif
+
+#if defined(__linux__)
+#include <cerrno>
+#include <dirent.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/uio.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
 namespace Helpers
 {
+	namespace Memory
+	{
+		static const size_t HugePageSize = 2U * 1024U * 1024U;
+
+		Arena::Arena(const size_t blockSize, const bool hugePages) :
+			m_blockSize(std::max<size_t>(blockSize, 256U)),
+			m_hugePages(hugePages),
+			m_first(NULL),
+			m_current(NULL),
+			m_cursor(NULL),
+			m_end(NULL),
+			m_usedBytes(0U)
+		{
+		}
+
+		Arena::~Arena()
+		{
+			Release();
+		}
+
+		char* Arena::CopyString(const char* str, const size_t length)
+		{
+			char* copy = static_cast<char*>(Allocate(length + 1U, 1U));
+			memcpy(copy, str, length);
+			copy[length] = '\0';
+			return copy;
+		}
+
+		void Arena::Reset()
+		{
+			m_current = NULL;
+			m_cursor = NULL;
+			m_end = NULL;
+			m_usedBytes = 0U;
+		}
+
+		void Arena::Release()
+		{
+			Reset();
+			while(NULL != m_first)
+			{
+				Block* next = m_first->next;
+#if defined(__linux__)
+				if(0U != m_first->mappedBytes)
+				{
+					munmap(m_first, m_first->mappedBytes);
+				}
+				else
+#endif
+				{
+					free(m_first);
+				}
+				m_first = next;
+			}
+		}
+
+		size_t Arena::BytesUsed() const
+		{
+			return m_usedBytes + ((NULL != m_current) ? static_cast<size_t>(m_cursor - BlockData(m_current)) : 0U);
+		}
+
+		size_t Arena::BytesReserved() const
+		{
+			size_t reserved = 0U;
+			for(const Block* block = m_first; NULL != block; block = block->next)
+			{
+				reserved += block->capacity;
+			}
+			return reserved;
+		}
+
+		size_t Arena::BlockCount() const
+		{
+			size_t count = 0U;
+			for(const Block* block = m_first; NULL != block; block = block->next)
+			{
+				count++;
+			}
+			return count;
+		}
+
+		void* Arena::AllocateSlow(const size_t size, const size_t alignment)
+		{
+			if(0U == alignment || 0U != (alignment & (alignment - 1U)) || size > std::numeric_limits<size_t>::max() / 2U)
+			{
+				throw std::bad_alloc();
+			}
+
+			if(NULL != m_current)
+			{
+				m_usedBytes += static_cast<size_t>(m_cursor - BlockData(m_current));
+			}
+
+			// Block data is max_align_t aligned, so only stricter alignments need slack.
+			const size_t needed = size + ((alignment > alignof(std::max_align_t)) ? alignment : 0U);
+			Block* next = (NULL != m_current) ? m_current->next : m_first;
+			if(NULL == next || next->capacity < needed)
+			{
+				Block* block = NewBlock(std::max(m_blockSize, needed));
+				block->next = next;
+				if(NULL != m_current)
+				{
+					m_current->next = block;
+				}
+				else
+				{
+					m_first = block;
+				}
+				next = block;
+			}
+
+			m_current = next;
+			m_cursor = BlockData(next);
+			m_end = m_cursor + next->capacity;
+			return Allocate(size, alignment);
+		}
+
+		Arena::Block* Arena::NewBlock(const size_t minCapacity)
+		{
+			Block* block = NULL;
+			size_t totalBytes = HeaderSize + minCapacity;
+
+#if defined(__linux__)
+			if(m_hugePages)
+			{
+				totalBytes = (totalBytes + HugePageSize - 1U) & ~(HugePageSize - 1U);
+				void* mapped = mmap(NULL, totalBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if(MAP_FAILED == mapped)
+				{
+					mapped = mmap(NULL, totalBytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+					if(MAP_FAILED != mapped)
+					{
+						madvise(mapped, totalBytes, MADV_HUGEPAGE);
+					}
+				}
+				if(MAP_FAILED == mapped)
+				{
+					throw std::bad_alloc();
+				}
+				block = static_cast<Block*>(mapped);
+				block->mappedBytes = totalBytes;
+			}
+#endif
+			if(NULL == block)
+			{
+				block = static_cast<Block*>(malloc(totalBytes));
+				if(NULL == block)
+				{
+					throw std::bad_alloc();
+				}
+				block->mappedBytes = 0U;
+			}
+
+			block->next = NULL;
+			block->capacity = totalBytes - HeaderSize;
+			return block;
+		}
+
+		char* Arena::BlockData(Block* block)
+		{
+			return reinterpret_cast<char*>(block) + HeaderSize;
+		}
+
+		static const size_t SlabClassSizes[] = { 16U, 32U, 48U, 64U, 96U, 128U, 192U, 256U, 384U, 512U, 768U, 1024U, 1536U, 2048U, 3072U, 4096U };
+		static const size_t SlabClassCount = sizeof(SlabClassSizes) / sizeof(SlabClassSizes[0]);
+		static const size_t SlabBytes = 64U * 1024U;
+		// Objects moved between a thread cache and the depot at a time; a cache holding twice this many flushes.
+		static const unsigned int SlabBatch = 32U;
+
+		struct SlabNode
+		{
+			SlabNode* next;
+		};
+
+		struct SlabDepot
+		{
+			std::mutex mutex;
+			SlabNode* freeList;
+			// Every slab carved for the class, chained through its first 16 bytes.
+			SlabNode* slabs;
+		};
+
+		static SlabDepot slabDepots[SlabClassCount];
+
+		struct SlabCache
+		{
+			SlabNode* freeLists[SlabClassCount];
+			unsigned int counts[SlabClassCount];
+
+			SlabCache()
+			{
+				for(size_t index = 0U; index < SlabClassCount; index++)
+				{
+					freeLists[index] = NULL;
+					counts[index] = 0U;
+				}
+			}
+
+			~SlabCache()
+			{
+				for(size_t index = 0U; index < SlabClassCount; index++)
+				{
+					Flush(index, counts[index]);
+				}
+			}
+
+			// Moves the first count objects of a class to the depot.
+			void Flush(const size_t index, const unsigned int count)
+			{
+				if(0U == count)
+				{
+					return;
+				}
+				SlabNode* first = freeLists[index];
+				SlabNode* last = first;
+				for(unsigned int moved = 1U; moved < count; moved++)
+				{
+					last = last->next;
+				}
+				freeLists[index] = last->next;
+				counts[index] -= count;
+
+				std::lock_guard<std::mutex> lock(slabDepots[index].mutex);
+				last->next = slabDepots[index].freeList;
+				slabDepots[index].freeList = first;
+			}
+
+			void Refill(const size_t index)
+			{
+				SlabDepot& depot = slabDepots[index];
+				std::lock_guard<std::mutex> lock(depot.mutex);
+
+				while(counts[index] < SlabBatch && NULL != depot.freeList)
+				{
+					SlabNode* node = depot.freeList;
+					depot.freeList = node->next;
+					node->next = freeLists[index];
+					freeLists[index] = node;
+					counts[index]++;
+				}
+				if(0U != counts[index])
+				{
+					return;
+				}
+
+				char* slab = static_cast<char*>(malloc(SlabBytes));
+				if(NULL == slab)
+				{
+					throw std::bad_alloc();
+				}
+				reinterpret_cast<SlabNode*>(slab)->next = depot.slabs;
+				depot.slabs = reinterpret_cast<SlabNode*>(slab);
+
+				const size_t objectSize = SlabClassSizes[index];
+				for(size_t offset = 16U; offset + objectSize <= SlabBytes; offset += objectSize)
+				{
+					SlabNode* node = reinterpret_cast<SlabNode*>(slab + offset);
+					node->next = freeLists[index];
+					freeLists[index] = node;
+					counts[index]++;
+				}
+			}
+		};
+
+		static SlabCache& CurrentSlabCache()
+		{
+			static thread_local SlabCache cache;
+			return cache;
+		}
+
+		// 16 byte steps up to 64, then two classes per power of two.
+		static size_t SlabClassIndex(const size_t size)
+		{
+			if(size <= 64U)
+			{
+				return (size <= 16U) ? 0U : (size - 1U) >> 4;
+			}
+			const unsigned int highBit = 63U - static_cast<unsigned int>(__builtin_clzll(static_cast<unsigned long long>(size - 1U)));
+			const size_t half = (static_cast<size_t>(3U) << highBit) >> 1;
+			return 4U + (highBit - 6U) * 2U + ((size > half) ? 1U : 0U);
+		}
+
+		void* SlabAllocate(const size_t size)
+		{
+			if(size > SlabMaxSize)
+			{
+				return ::operator new(size);
+			}
+
+			const size_t index = SlabClassIndex(size);
+			SlabCache& cache = CurrentSlabCache();
+			if(NULL == cache.freeLists[index])
+			{
+				cache.Refill(index);
+			}
+			SlabNode* node = cache.freeLists[index];
+			cache.freeLists[index] = node->next;
+			cache.counts[index]--;
+			return node;
+		}
+
+		unsigned int CurrentThreadSlot()
+		{
+			static std::atomic<unsigned int> nextSlot(0U);
+			static thread_local unsigned int slot = nextSlot.fetch_add(1U, std::memory_order_relaxed);
+			return slot;
+		}
+
+		void SlabFree(void* ptr, const size_t size)
+		{
+			if(NULL == ptr)
+			{
+				return;
+			}
+			if(size > SlabMaxSize)
+			{
+				::operator delete(ptr);
+				return;
+			}
+
+			const size_t index = SlabClassIndex(size);
+			SlabCache& cache = CurrentSlabCache();
+			SlabNode* node = static_cast<SlabNode*>(ptr);
+			node->next = cache.freeLists[index];
+			cache.freeLists[index] = node;
+			if(++cache.counts[index] >= 2U * SlabBatch)
+			{
+				cache.Flush(index, SlabBatch);
+			}
+		}
+	} // namespace Memory
+
 	namespace Text
 	{
 		bool CStrEq(const char* __restrict__ a, const char* __restrict__ b)
@@ -164,28 +528,41 @@ namespace Helpers
 			return length;
 		}
 
-		std::string HexTable(const void* ptr, const unsigned int num, const unsigned int voffset)
+		// Shared by the std::string and arena overloads. Appends rows of "offset | hex bytes | chars", padding
+		// the hex column of a short last row.
+		template<typename S>
+		static void AppendHexTable(S& table, const void* ptr, const unsigned int num, const unsigned int voffset)
 		{
+			static const char hexDigits[] = "0123456789abcdef";
 			const unsigned char* data = static_cast<const unsigned char*>(ptr);
 			unsigned int numread = 0;
-			std::string chars;
-			std::string hexchars;
-			std::string table;
 
+			table.reserve(table.size() + ((num + 15U) / 16U) * 80U);
 			while (numread < num)
 			{
-				hexchars = Text::Stringf("%08x | ", voffset + numread);
+				const unsigned int offset = voffset + numread;
+				for (int shift = 28; shift >= 0; shift -= 4)
+				{
+					table.push_back(hexDigits[(offset >> shift) & 0xFU]);
+				}
+				table.append(" | ", 3U);
+
+				char chars[16];
 				int col = 0;
+				int charCount = 0;
 				for (; col < 16; col++)
 				{
-					hexchars += Text::Stringf("%02x ", data[numread]);
-					if (std::isprint(data[numread]) && '\n' != data[numread] && '\r' != data[numread] && '\b' != data[numread])
+					const unsigned char byte = data[numread];
+					table.push_back(hexDigits[byte >> 4]);
+					table.push_back(hexDigits[byte & 0xFU]);
+					table.push_back(' ');
+					if (std::isprint(byte) && '\n' != byte && '\r' != byte && '\b' != byte)
 					{
-						chars += static_cast<char>(data[numread]);
+						chars[charCount++] = static_cast<char>(byte);
 					}
 					else
 					{
-						chars += ".";
+						chars[charCount++] = '.';
 					}
 					numread += 1;
 					if (numread == num)
@@ -193,16 +570,21 @@ namespace Helpers
 				}
 				while (++col < 16)
 				{
-					hexchars += "   ";
+					table.append("   ", 3U);
 				}
-				table += hexchars + " | " + chars;
+				table.append(" | ", 3U);
+				table.append(chars, static_cast<size_t>(charCount));
 				if (numread < num)
 				{
-					table += "\n";
+					table.push_back('\n');
 				}
-				hexchars.clear();
-				chars.clear();
 			}
+		}
+
+		std::string HexTable(const void* ptr, const unsigned int num, const unsigned int voffset)
+		{
+			std::string table;
+			AppendHexTable(table, ptr, num, voffset);
 			return table;
 		}
 
@@ -210,6 +592,137 @@ namespace Helpers
 		{
 			std::cout << HexTable(ptr, num, voffset) << "\n";
 		}
+
+		Memory::ArenaString Stringf(Memory::Arena& arena, const char* __restrict__ const fmt, ...)
+		{
+			Memory::ArenaString result{Memory::ArenaAllocator<char>(arena)};
+			std::va_list args;
+			std::va_list argsCopy;
+			va_start(args, fmt);
+			va_copy(argsCopy, args);
+			const int requiredBufLenInclTerm = 1 + std::vsnprintf((char*)NULL, 0, fmt, args);
+			va_end(args);
+			if (requiredBufLenInclTerm > 1)
+			{
+				result.resize(requiredBufLenInclTerm);
+				std::vsnprintf(&result[0], requiredBufLenInclTerm, fmt, argsCopy);
+				result.resize(requiredBufLenInclTerm - 1);
+			}
+			va_end(argsCopy);
+			return result;
+		}
+
+		Memory::ArenaString StringReplace(Memory::Arena& arena, const char* str, const char* what, const char* with)
+		{
+			// Same result as the std::string overload, built in one pass instead of replacing in place.
+			const size_t length = strlen(str);
+			const size_t whatLength = strlen(what);
+			const size_t withLength = strlen(with);
+			Memory::ArenaString result{Memory::ArenaAllocator<char>(arena)};
+			result.reserve(length);
+
+			const char* begin = str;
+			if(length > whatLength && whatLength > 0U)
+			{
+				for(const char* found = strstr(begin, what); NULL != found; found = strstr(begin, what))
+				{
+					result.append(begin, static_cast<size_t>(found - begin));
+					result.append(with, withLength);
+					begin = found + whatLength;
+				}
+			}
+			result.append(begin);
+			return result;
+		}
+
+		Memory::ArenaVector<Memory::ArenaString> StringSplit(Memory::Arena& arena, const char* str, const char* delim)
+		{
+			const size_t length = strlen(str);
+			const size_t delimLength = strlen(delim);
+			Memory::ArenaVector<Memory::ArenaString> split{Memory::ArenaAllocator<Memory::ArenaString>(arena)};
+			const Memory::ArenaAllocator<char> allocator(arena);
+
+			if(length > delimLength)
+			{
+				const char* begin = str;
+				if(delimLength > 0U)
+				{
+					for(const char* end = strstr(begin, delim); NULL != end; end = strstr(begin, delim))
+					{
+						split.push_back(Memory::ArenaString(begin, static_cast<size_t>(end - begin), allocator));
+						begin = end + delimLength;
+					}
+				}
+				if('\0' != *begin)
+				{
+					split.push_back(Memory::ArenaString(begin, allocator));
+				}
+			}
+
+			return split;
+		}
+
+		Memory::ArenaString HexTable(Memory::Arena& arena, const void* ptr, const unsigned int num, const unsigned int voffset)
+		{
+			Memory::ArenaString table{Memory::ArenaAllocator<char>(arena)};
+			AppendHexTable(table, ptr, num, voffset);
+			return table;
+		}
+
+		bool HexTableFile(const std::string& path, std::ostream& out)
+		{
+			// Pieces of a multiple of 16 bytes keep the rows aligned, so the joined tables match one HexTable.
+			const size_t pieceBytes = 64U * 1024U;
+			std::string table;
+			bool first = true;
+			unsigned char carry[16];
+			size_t carried = 0U;
+			unsigned long long carryOffset = 0ULL;
+
+			const bool read = Io::ForEachChunk(path, [&](const unsigned char* data, size_t size, unsigned long long offset) {
+				// Chunks are not necessarily multiples of 16 bytes; complete a partial row from the last one first.
+				if(carried > 0U)
+				{
+					const size_t take = std::min(size, 16U - carried);
+					memcpy(carry + carried, data, take);
+					carried += take;
+					data += take;
+					size -= take;
+					offset += take;
+					if(carried < 16U)
+					{
+						return;
+					}
+					table.clear();
+					AppendHexTable(table, carry, 16U, static_cast<unsigned int>(carryOffset));
+					out << (first ? "" : "\n") << table;
+					first = false;
+					carried = 0U;
+				}
+				while(size >= 16U)
+				{
+					const size_t piece = std::min(size, pieceBytes) & ~static_cast<size_t>(15U);
+					table.clear();
+					AppendHexTable(table, data, static_cast<unsigned int>(piece), static_cast<unsigned int>(offset));
+					out << (first ? "" : "\n") << table;
+					first = false;
+					data += piece;
+					size -= piece;
+					offset += piece;
+				}
+				memcpy(carry, data, size);
+				carried = size;
+				carryOffset = offset;
+			});
+
+			if(read && carried > 0U)
+			{
+				table.clear();
+				AppendHexTable(table, carry, static_cast<unsigned int>(carried), static_cast<unsigned int>(carryOffset));
+				out << (first ? "" : "\n") << table;
+			}
+			return read && static_cast<bool>(out);
+		}
 	} // namespace Text
 
 	namespace Random
@@ -225,55 +738,803 @@ namespace Helpers
 
 	namespace Numeric
 	{
-		uint16_t BitReflect16(uint16_t val)
+		// Pre-calculated bit reflection of every byte value.
+		static const uint8_t BitReflectTable[256] = {
+			0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0,
+			0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8, 0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8,
+			0x04, 0x84, 0x44, 0xC4, 0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+			0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC, 0x3C, 0xBC, 0x7C, 0xFC,
+			0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2, 0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2,
+			0x0A, 0x8A, 0x4A, 0xCA, 0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+			0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6, 0x36, 0xB6, 0x76, 0xF6,
+			0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE, 0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE,
+			0x01, 0x81, 0x41, 0xC1, 0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+			0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9, 0x39, 0xB9, 0x79, 0xF9,
+			0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5, 0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5,
+			0x0D, 0x8D, 0x4D, 0xCD, 0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+			0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3, 0x33, 0xB3, 0x73, 0xF3,
+			0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB, 0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB,
+			0x07, 0x87, 0x47, 0xC7, 0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+			0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF, 0x3F, 0xBF, 0x7F, 0xFF
+		};
+
+#if defined(__SSSE3__)
+		// Nibble reflection tables for the pshufb byte reflection kernel.
+		static const uint8_t ReflectNibbleLowTable[16] = {
+			0x00, 0x08, 0x04, 0x0C, 0x02, 0x0A, 0x06, 0x0E, 0x01, 0x09, 0x05, 0x0D, 0x03, 0x0B, 0x07, 0x0F
+		};
+
+		static const uint8_t ReflectNibbleHighTable[16] = {
+			0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0, 0x30, 0xB0, 0x70, 0xF0
+		};
+
+		// pshufb masks that reverse the byte order of each 16, 32 and 64 bit lane.
+		static const uint8_t ByteSwapShuffle16[16] = { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+		static const uint8_t ByteSwapShuffle32[16] = { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+		static const uint8_t ByteSwapShuffle64[16] = { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+#else
+		static const uint8_t* const ByteSwapShuffle16 = NULL;
+		static const uint8_t* const ByteSwapShuffle32 = NULL;
+		static const uint8_t* const ByteSwapShuffle64 = NULL;
+#endif
+
+		template<typename T>
+		static void ReflectArrayKernel(T* data, const size_t count, const uint8_t* byteShuffle, const bool reflectBits, T (*scalarOp)(T))
 		{
-			for(unsigned int i = 0; i < (sizeof(val) * 8) / 2; i++)
+			size_t offset = 0;
+
+#if defined(__SSSE3__)
+			uint8_t* bytes = reinterpret_cast<uint8_t*>(data);
+			const size_t dataSizeBytes = count * sizeof(T);
+#else
+			(void)byteShuffle;
+			(void)reflectBits;
+#endif
+
+#if defined(__AVX2__)
+			{
+				const __m256i lowMask = _mm256_set1_epi8(0x0F);
+				const __m256i nibbleLow = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ReflectNibbleLowTable)));
+				const __m256i nibbleHigh = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ReflectNibbleHighTable)));
+				const __m256i shuffle = byteShuffle ? _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(byteShuffle))) : _mm256_setzero_si256();
+
+				for(; offset + sizeof(__m256i) <= dataSizeBytes; offset += sizeof(__m256i))
+				{
+					__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + offset));
+					if(byteShuffle)
+					{
+						v = _mm256_shuffle_epi8(v, shuffle);
+					}
+					if(reflectBits)
+					{
+						const __m256i lo = _mm256_and_si256(v, lowMask);
+						const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+						v = _mm256_or_si256(_mm256_shuffle_epi8(nibbleHigh, lo), _mm256_shuffle_epi8(nibbleLow, hi));
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(bytes + offset), v);
+				}
+			}
+#endif
+#if defined(__SSSE3__)
+			{
+				const __m128i lowMask = _mm_set1_epi8(0x0F);
+				const __m128i nibbleLow = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ReflectNibbleLowTable));
+				const __m128i nibbleHigh = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ReflectNibbleHighTable));
+				const __m128i shuffle = byteShuffle ? _mm_loadu_si128(reinterpret_cast<const __m128i*>(byteShuffle)) : _mm_setzero_si128();
+
+				for(; offset + sizeof(__m128i) <= dataSizeBytes; offset += sizeof(__m128i))
+				{
+					__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + offset));
+					if(byteShuffle)
+					{
+						v = _mm_shuffle_epi8(v, shuffle);
+					}
+					if(reflectBits)
+					{
+						const __m128i lo = _mm_and_si128(v, lowMask);
+						const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), lowMask);
+						v = _mm_or_si128(_mm_shuffle_epi8(nibbleHigh, lo), _mm_shuffle_epi8(nibbleLow, hi));
+					}
+					_mm_storeu_si128(reinterpret_cast<__m128i*>(bytes + offset), v);
+				}
+			}
+#endif
+
+			for(size_t index = offset / sizeof(T); index < count; index++)
 			{
-				uint8_t msb = !!(val & (1 << ((sizeof(val) * 8) - 1 - i)));
-				uint8_t lsb = !!(val & (1 << i));
-				val &= ~((1 << ((sizeof(val) * 8) - 1 - i)) | (1 << i));
-				val |= lsb << ((sizeof(val) * 8) - 1 - i);
-				val |= msb << i;
+				data[index] = scalarOp(data[index]);
 			}
-			return val;
+		}
+
+		uint8_t BitReflect8(uint8_t val)
+		{
+#if HELPERS_HAS_BUILTIN(__builtin_bitreverse8)
+			return __builtin_bitreverse8(val);
+#else
+			return BitReflectTable[val];
+#endif
+		}
+
+		uint16_t BitReflect16(uint16_t val)
+		{
+#if HELPERS_HAS_BUILTIN(__builtin_bitreverse16)
+			return __builtin_bitreverse16(val);
+#else
+			return static_cast<uint16_t>((BitReflectTable[val & 0xFF] << 8) | BitReflectTable[val >> 8]);
+#endif
 		}
 
 		uint32_t BitReflect32(uint32_t val)
 		{
-			for(unsigned int i = 0; i < (sizeof(val) * 8) / 2; i++)
-			{
-				uint8_t msb = !!(val & (1 << ((sizeof(val) * 8) - 1 - i)));
-				uint8_t lsb = !!(val & (1 << i));
-				val &= ~((1 << ((sizeof(val) * 8) - 1 - i)) | (1 << i));
-				val |= lsb << ((sizeof(val) * 8) - 1 - i);
-				val |= msb << i;
-			}
-			return val;
+#if HELPERS_HAS_BUILTIN(__builtin_bitreverse32)
+			return __builtin_bitreverse32(val);
+#else
+			val = ((val >> 1) & 0x55555555U) | ((val & 0x55555555U) << 1);
+			val = ((val >> 2) & 0x33333333U) | ((val & 0x33333333U) << 2);
+			val = ((val >> 4) & 0x0F0F0F0FU) | ((val & 0x0F0F0F0FU) << 4);
+			return ByteSwap32(val);
+#endif
 		}
 
-		int BCDToDec(const int bcd)
+		uint64_t BitReflect64(uint64_t val)
 		{
-			const int dec = ((bcd >> 4) * 10) + (bcd & 0x0F);
-			return dec;
+#if HELPERS_HAS_BUILTIN(__builtin_bitreverse64)
+			return __builtin_bitreverse64(val);
+#else
+			val = ((val >> 1) & 0x5555555555555555ULL) | ((val & 0x5555555555555555ULL) << 1);
+			val = ((val >> 2) & 0x3333333333333333ULL) | ((val & 0x3333333333333333ULL) << 2);
+			val = ((val >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((val & 0x0F0F0F0F0F0F0F0FULL) << 4);
+			return ByteSwap64(val);
+#endif
 		}
 
-		int DecToBCD(const int dec)
+		uint16_t ByteSwap16(uint16_t val)
 		{
-			const int bcd = ((dec / 10) << 4) | (dec % 10);
-			return bcd;
+#if defined(__GNUC__)
+			return __builtin_bswap16(val);
+#else
+			return static_cast<uint16_t>((val << 8) | (val >> 8));
+#endif
 		}
 
-		bool IsDoubleEqual(const double a, const double b, const double epsilon)
+		uint32_t ByteSwap32(uint32_t val)
 		{
-			return static_cast<bool>(std::fabs(std::max(a,b)) - std::fabs(std::min(a,b)) < epsilon);
+#if defined(__GNUC__)
+			return __builtin_bswap32(val);
+#else
+			return ((val << 24) | ((val << 8) & 0x00FF0000U) | ((val >> 8) & 0x0000FF00U) | (val >> 24));
+#endif
 		}
-	} // namespace Numeric
 
-	namespace Checksum
-	{
-		namespace CRC32
+		uint64_t ByteSwap64(uint64_t val)
 		{
-			// Pre-calculated CRC32 lookup table using 0xEDB88320U as the reflected polynomial.
+#if defined(__GNUC__)
+			return __builtin_bswap64(val);
+#else
+			return (static_cast<uint64_t>(ByteSwap32(static_cast<uint32_t>(val))) << 32) | ByteSwap32(static_cast<uint32_t>(val >> 32));
+#endif
+		}
+
+		void BitReflectBytes(void* data, const size_t dataSizeBytes)
+		{
+			ReflectArrayKernel<uint8_t>(static_cast<uint8_t*>(data), dataSizeBytes, NULL, true, BitReflect8);
+		}
+
+		void BitReflect16Array(uint16_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint16_t>(data, count, ByteSwapShuffle16, true, BitReflect16);
+		}
+
+		void BitReflect32Array(uint32_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint32_t>(data, count, ByteSwapShuffle32, true, BitReflect32);
+		}
+
+		void BitReflect64Array(uint64_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint64_t>(data, count, ByteSwapShuffle64, true, BitReflect64);
+		}
+
+		void ByteSwap16Array(uint16_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint16_t>(data, count, ByteSwapShuffle16, false, ByteSwap16);
+		}
+
+		void ByteSwap32Array(uint32_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint32_t>(data, count, ByteSwapShuffle32, false, ByteSwap32);
+		}
+
+		void ByteSwap64Array(uint64_t* data, const size_t count)
+		{
+			ReflectArrayKernel<uint64_t>(data, count, ByteSwapShuffle64, false, ByteSwap64);
+		}
+
+		int BCDToDec(const int bcd)
+		{
+			const int dec = ((bcd >> 4) * 10) + (bcd & 0x0F);
+			return dec;
+		}
+
+		int DecToBCD(const int dec)
+		{
+			const int bcd = ((dec / 10) << 4) | (dec % 10);
+			return bcd;
+		}
+
+		uint32_t BCDToDec32(uint32_t bcd)
+		{
+			// Fold digit pairs, then digit quads, then the two halves by subtracting the excess of each radix.
+			bcd -= ((bcd >> 4) & 0x0F0F0F0FU) * 6U;
+			bcd -= ((bcd >> 8) & 0x00FF00FFU) * 156U;
+			bcd -= ((bcd >> 16) & 0x0000FFFFU) * 55536U;
+			return bcd;
+		}
+
+		uint32_t DecToBCD32(uint32_t dec)
+		{
+			dec %= 100000000U;
+
+			// Split into four digit halves held in 32 bit lanes, then into digit pairs and digits with
+			// reciprocal multiplies that stay exact for the lane ranges involved.
+			const uint32_t high = dec / 10000U;
+			uint64_t lanes = (static_cast<uint64_t>(high) << 32) | (dec - (high * 10000U));
+			uint64_t quot = ((lanes * 5243U) >> 19) & 0x0000007F0000007FULL;
+			lanes = (quot << 16) | (lanes - (quot * 100U));
+			quot = ((lanes * 103U) >> 10) & 0x000F000F000F000FULL;
+			lanes = (quot << 4) | (lanes - (quot * 10U));
+
+			lanes = (lanes | (lanes >> 8)) & 0x0000FFFF0000FFFFULL;
+			lanes = (lanes | (lanes >> 16)) & 0x00000000FFFFFFFFULL;
+			return static_cast<uint32_t>(lanes);
+		}
+
+		uint64_t BCDToDec64(uint64_t bcd)
+		{
+			bcd -= ((bcd >> 4) & 0x0F0F0F0F0F0F0F0FULL) * 6U;
+			bcd -= ((bcd >> 8) & 0x00FF00FF00FF00FFULL) * 156U;
+			bcd -= ((bcd >> 16) & 0x0000FFFF0000FFFFULL) * 55536U;
+			bcd -= (bcd >> 32) * 4194967296ULL;
+			return bcd;
+		}
+
+		uint64_t DecToBCD64(uint64_t dec)
+		{
+			const uint64_t high = (dec / 100000000ULL) % 100000000ULL;
+			const uint64_t low = dec % 100000000ULL;
+			return (static_cast<uint64_t>(DecToBCD32(static_cast<uint32_t>(high))) << 32) | DecToBCD32(static_cast<uint32_t>(low));
+		}
+
+		bool IsValidBCD32(const uint32_t bcd)
+		{
+			// A nibble is above nine when its top bit is set together with either of the two below it.
+			return 0U == ((bcd >> 3) & ((bcd >> 2) | (bcd >> 1)) & 0x11111111U);
+		}
+
+		bool IsValidBCD64(const uint64_t bcd)
+		{
+			return 0U == ((bcd >> 3) & ((bcd >> 2) | (bcd >> 1)) & 0x1111111111111111ULL);
+		}
+
+#if defined(__SSE2__)
+		static inline __m128i InvalidBCDNibbles(const __m128i v)
+		{
+			const __m128i lowNibbles = _mm_set1_epi8(0x0F);
+			const __m128i nine = _mm_set1_epi8(9);
+			return _mm_or_si128(_mm_cmpgt_epi8(_mm_and_si128(v, lowNibbles), nine),
+				_mm_cmpgt_epi8(_mm_and_si128(_mm_srli_epi16(v, 4), lowNibbles), nine));
+		}
+
+		static inline __m128i BCDBytesToBinary(const __m128i v)
+		{
+			const __m128i high = _mm_and_si128(_mm_srli_epi16(v, 4), _mm_set1_epi8(0x0F));
+			const __m128i high2 = _mm_add_epi8(high, high);
+			return _mm_sub_epi8(v, _mm_add_epi8(high2, _mm_add_epi8(high2, high2)));
+		}
+
+		static inline __m128i BCDToBinary32(__m128i v)
+		{
+			v = BCDBytesToBinary(v);
+			v = _mm_add_epi16(_mm_mullo_epi16(_mm_srli_epi16(v, 8), _mm_set1_epi16(100)), _mm_and_si128(v, _mm_set1_epi16(0x00FF)));
+			return _mm_madd_epi16(v, _mm_set1_epi32((10000 << 16) | 1));
+		}
+
+		static inline __m128i BCDToBinary64(const __m128i v)
+		{
+			const __m128i halves = BCDToBinary32(v);
+			return _mm_add_epi64(_mm_and_si128(halves, _mm_set1_epi64x(0xFFFFFFFFLL)),
+				_mm_mul_epu32(_mm_srli_epi64(halves, 32), _mm_set1_epi64x(100000000LL)));
+		}
+#endif
+
+#if defined(__AVX2__)
+		static inline __m256i InvalidBCDNibbles(const __m256i v)
+		{
+			const __m256i lowNibbles = _mm256_set1_epi8(0x0F);
+			const __m256i nine = _mm256_set1_epi8(9);
+			return _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_and_si256(v, lowNibbles), nine),
+				_mm256_cmpgt_epi8(_mm256_and_si256(_mm256_srli_epi16(v, 4), lowNibbles), nine));
+		}
+
+		static inline __m256i BCDBytesToBinary(const __m256i v)
+		{
+			const __m256i high = _mm256_and_si256(_mm256_srli_epi16(v, 4), _mm256_set1_epi8(0x0F));
+			const __m256i high2 = _mm256_add_epi8(high, high);
+			return _mm256_sub_epi8(v, _mm256_add_epi8(high2, _mm256_add_epi8(high2, high2)));
+		}
+
+		static inline __m256i BCDToBinary32(__m256i v)
+		{
+			v = BCDBytesToBinary(v);
+			v = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_srli_epi16(v, 8), _mm256_set1_epi16(100)), _mm256_and_si256(v, _mm256_set1_epi16(0x00FF)));
+			return _mm256_madd_epi16(v, _mm256_set1_epi32((10000 << 16) | 1));
+		}
+
+		static inline __m256i BCDToBinary64(const __m256i v)
+		{
+			const __m256i halves = BCDToBinary32(v);
+			return _mm256_add_epi64(_mm256_and_si256(halves, _mm256_set1_epi64x(0xFFFFFFFFLL)),
+				_mm256_mul_epu32(_mm256_srli_epi64(halves, 32), _mm256_set1_epi64x(100000000LL)));
+		}
+#endif
+
+		bool IsValidBCD(const void* data, const size_t dataSizeBytes)
+		{
+			const uint8_t* bytes = static_cast<const uint8_t*>(data);
+			size_t index = 0;
+
+#if defined(__AVX2__)
+			for(; index + sizeof(__m256i) <= dataSizeBytes; index += sizeof(__m256i))
+			{
+				const __m256i invalid = InvalidBCDNibbles(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + index)));
+				if(!_mm256_testz_si256(invalid, invalid))
+				{
+					return false;
+				}
+			}
+#endif
+#if defined(__SSE2__)
+			for(; index + sizeof(__m128i) <= dataSizeBytes; index += sizeof(__m128i))
+			{
+				if(0 != _mm_movemask_epi8(InvalidBCDNibbles(_mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + index)))))
+				{
+					return false;
+				}
+			}
+#endif
+
+			for(; index < dataSizeBytes; index++)
+			{
+				if((bytes[index] & 0x0F) > 9 || (bytes[index] >> 4) > 9)
+				{
+					return false;
+				}
+			}
+
+			return true;
+		}
+
+		bool BCDToDec32Array(const uint32_t* bcd, uint32_t* dec, const size_t count)
+		{
+			bool valid = true;
+			size_t index = 0;
+
+#if defined(__AVX2__)
+			__m256i invalid256 = _mm256_setzero_si256();
+			for(; index + 8 <= count; index += 8)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bcd + index));
+				invalid256 = _mm256_or_si256(invalid256, InvalidBCDNibbles(v));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dec + index), BCDToBinary32(v));
+			}
+			valid = static_cast<bool>(_mm256_testz_si256(invalid256, invalid256));
+#endif
+#if defined(__SSE2__)
+			__m128i invalid = _mm_setzero_si128();
+			for(; index + 4 <= count; index += 4)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bcd + index));
+				invalid = _mm_or_si128(invalid, InvalidBCDNibbles(v));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dec + index), BCDToBinary32(v));
+			}
+			valid = valid && (0 == _mm_movemask_epi8(invalid));
+#endif
+
+			for(; index < count; index++)
+			{
+				if(!IsValidBCD32(bcd[index]))
+				{
+					valid = false;
+				}
+				dec[index] = BCDToDec32(bcd[index]);
+			}
+
+			return valid;
+		}
+
+		bool BCDToDec64Array(const uint64_t* bcd, uint64_t* dec, const size_t count)
+		{
+			bool valid = true;
+			size_t index = 0;
+
+#if defined(__AVX2__)
+			__m256i invalid256 = _mm256_setzero_si256();
+			for(; index + 4 <= count; index += 4)
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bcd + index));
+				invalid256 = _mm256_or_si256(invalid256, InvalidBCDNibbles(v));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dec + index), BCDToBinary64(v));
+			}
+			valid = static_cast<bool>(_mm256_testz_si256(invalid256, invalid256));
+#endif
+#if defined(__SSE2__)
+			__m128i invalid = _mm_setzero_si128();
+			for(; index + 2 <= count; index += 2)
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bcd + index));
+				invalid = _mm_or_si128(invalid, InvalidBCDNibbles(v));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dec + index), BCDToBinary64(v));
+			}
+			valid = valid && (0 == _mm_movemask_epi8(invalid));
+#endif
+
+			for(; index < count; index++)
+			{
+				if(!IsValidBCD64(bcd[index]))
+				{
+					valid = false;
+				}
+				dec[index] = BCDToDec64(bcd[index]);
+			}
+
+			return valid;
+		}
+
+		void DecToBCD32Array(const uint32_t* dec, uint32_t* bcd, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				bcd[index] = DecToBCD32(dec[index]);
+			}
+		}
+
+		void DecToBCD64Array(const uint64_t* dec, uint64_t* bcd, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				bcd[index] = DecToBCD64(dec[index]);
+			}
+		}
+
+		bool BCDToDecBytes(const uint8_t* bcd, uint8_t* dec, const size_t count)
+		{
+			bool valid = true;
+			size_t index = 0;
+
+#if defined(__AVX2__)
+			__m256i invalid256 = _mm256_setzero_si256();
+			for(; index + sizeof(__m256i) <= count; index += sizeof(__m256i))
+			{
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bcd + index));
+				invalid256 = _mm256_or_si256(invalid256, InvalidBCDNibbles(v));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dec + index), BCDBytesToBinary(v));
+			}
+			valid = static_cast<bool>(_mm256_testz_si256(invalid256, invalid256));
+#endif
+#if defined(__SSE2__)
+			__m128i invalid = _mm_setzero_si128();
+			for(; index + sizeof(__m128i) <= count; index += sizeof(__m128i))
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bcd + index));
+				invalid = _mm_or_si128(invalid, InvalidBCDNibbles(v));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dec + index), BCDBytesToBinary(v));
+			}
+			valid = valid && (0 == _mm_movemask_epi8(invalid));
+#endif
+
+			for(; index < count; index++)
+			{
+				if((bcd[index] & 0x0F) > 9 || (bcd[index] >> 4) > 9)
+				{
+					valid = false;
+				}
+				dec[index] = static_cast<uint8_t>(BCDToDec(bcd[index]));
+			}
+
+			return valid;
+		}
+
+		bool DecToBCDBytes(const uint8_t* dec, uint8_t* bcd, const size_t count)
+		{
+			bool valid = true;
+			size_t index = 0;
+
+#if defined(__SSE2__)
+			// tens = (dec * 6554) >> 16 is exact for every byte value; bcd = dec + tens * 6.
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i reciprocal = _mm_set1_epi16(6554);
+			const __m128i hundred = _mm_set1_epi8(100);
+			__m128i invalid = _mm_setzero_si128();
+			for(; index + sizeof(__m128i) <= count; index += sizeof(__m128i))
+			{
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dec + index));
+				invalid = _mm_or_si128(invalid, _mm_cmpeq_epi8(_mm_max_epu8(v, hundred), v));
+				const __m128i tens = _mm_packus_epi16(_mm_mulhi_epu16(_mm_unpacklo_epi8(v, zero), reciprocal),
+					_mm_mulhi_epu16(_mm_unpackhi_epi8(v, zero), reciprocal));
+				const __m128i tens2 = _mm_add_epi8(tens, tens);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(bcd + index), _mm_add_epi8(v, _mm_add_epi8(tens2, _mm_add_epi8(tens2, tens2))));
+			}
+			valid = (0 == _mm_movemask_epi8(invalid));
+#endif
+
+			for(; index < count; index++)
+			{
+				if(dec[index] > 99)
+				{
+					valid = false;
+				}
+				bcd[index] = static_cast<uint8_t>(DecToBCD(dec[index]));
+			}
+
+			return valid;
+		}
+
+		bool IsDoubleEqual(const double a, const double b, const double epsilon)
+		{
+			return static_cast<bool>(a == b || std::fabs(a - b) < epsilon);
+		}
+
+		bool IsNearlyEqualAbs(const double a, const double b, const double absTolerance)
+		{
+			return static_cast<bool>(a == b || std::fabs(a - b) <= absTolerance);
+		}
+
+		bool IsNearlyEqualAbs(const float a, const float b, const float absTolerance)
+		{
+			return static_cast<bool>(a == b || std::fabs(a - b) <= absTolerance);
+		}
+
+		template<typename T>
+		static inline bool IsClose(const T a, const T b, const T relTolerance, const T absTolerance)
+		{
+			const T magnitudeA = std::fabs(a);
+			const T magnitudeB = std::fabs(b);
+			const T relative = relTolerance * ((magnitudeA > magnitudeB) ? magnitudeA : magnitudeB);
+			// An infinite tolerance would make infinities close to everything, so non-finite values need a == b.
+			return static_cast<bool>(a == b || (std::isfinite(a) && std::isfinite(b) && std::fabs(a - b) <= ((absTolerance > relative) ? absTolerance : relative)));
+		}
+
+		bool IsNearlyEqualRel(const double a, const double b, const double relTolerance, const double absTolerance)
+		{
+			return IsClose(a, b, relTolerance, absTolerance);
+		}
+
+		bool IsNearlyEqualRel(const float a, const float b, const float relTolerance, const float absTolerance)
+		{
+			return IsClose(a, b, relTolerance, absTolerance);
+		}
+
+		// Maps the sign-magnitude bit pattern onto an unsigned scale that is monotonic in the represented value.
+		template<typename Bits, typename T>
+		static inline Bits OrderedBits(const T value)
+		{
+			const Bits signBit = static_cast<Bits>(1U) << (sizeof(Bits) * 8 - 1);
+			Bits bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return (bits & signBit) ? static_cast<Bits>(signBit - (bits & ~signBit)) : static_cast<Bits>(signBit + bits);
+		}
+
+		uint64_t UlpDistance(const double a, const double b)
+		{
+			if(std::isnan(a) || std::isnan(b))
+			{
+				return std::numeric_limits<uint64_t>::max();
+			}
+			const uint64_t orderedA = OrderedBits<uint64_t>(a);
+			const uint64_t orderedB = OrderedBits<uint64_t>(b);
+			return (orderedA > orderedB) ? (orderedA - orderedB) : (orderedB - orderedA);
+		}
+
+		uint32_t UlpDistance(const float a, const float b)
+		{
+			if(std::isnan(a) || std::isnan(b))
+			{
+				return std::numeric_limits<uint32_t>::max();
+			}
+			const uint32_t orderedA = OrderedBits<uint32_t>(a);
+			const uint32_t orderedB = OrderedBits<uint32_t>(b);
+			return (orderedA > orderedB) ? (orderedA - orderedB) : (orderedB - orderedA);
+		}
+
+		bool IsNearlyEqualUlps(const double a, const double b, const uint64_t maxUlps)
+		{
+			return !std::isnan(a) && !std::isnan(b) && UlpDistance(a, b) <= maxUlps;
+		}
+
+		bool IsNearlyEqualUlps(const float a, const float b, const uint64_t maxUlps)
+		{
+			return !std::isnan(a) && !std::isnan(b) && UlpDistance(a, b) <= maxUlps;
+		}
+
+		// The vector helpers return a lane bitmask of the elements that are not close. A lane compares by tolerance only
+		// when both magnitudes are at most the largest finite value, which also rejects NaN.
+#if defined(__AVX2__)
+		static inline int NotCloseMask256(const double* a, const double* b, const double relTolerance, const double absTolerance)
+		{
+			const __m256d signMask = _mm256_set1_pd(-0.0);
+			const __m256d va = _mm256_loadu_pd(a);
+			const __m256d vb = _mm256_loadu_pd(b);
+			const __m256d diff = _mm256_andnot_pd(signMask, _mm256_sub_pd(va, vb));
+			const __m256d magnitudeA = _mm256_andnot_pd(signMask, va);
+			const __m256d magnitudeB = _mm256_andnot_pd(signMask, vb);
+			const __m256d largest = _mm256_set1_pd(std::numeric_limits<double>::max());
+			const __m256d finite = _mm256_and_pd(_mm256_cmp_pd(magnitudeA, largest, _CMP_LE_OQ), _mm256_cmp_pd(magnitudeB, largest, _CMP_LE_OQ));
+			const __m256d larger = _mm256_max_pd(magnitudeA, magnitudeB);
+			const __m256d tolerance = _mm256_max_pd(_mm256_set1_pd(absTolerance), _mm256_mul_pd(_mm256_set1_pd(relTolerance), larger));
+			const __m256d close = _mm256_or_pd(_mm256_cmp_pd(va, vb, _CMP_EQ_OQ), _mm256_and_pd(finite, _mm256_cmp_pd(diff, tolerance, _CMP_LE_OQ)));
+			return 0x0F & ~_mm256_movemask_pd(close);
+		}
+
+		static inline int NotCloseMask256(const float* a, const float* b, const float relTolerance, const float absTolerance)
+		{
+			const __m256 signMask = _mm256_set1_ps(-0.0f);
+			const __m256 va = _mm256_loadu_ps(a);
+			const __m256 vb = _mm256_loadu_ps(b);
+			const __m256 diff = _mm256_andnot_ps(signMask, _mm256_sub_ps(va, vb));
+			const __m256 magnitudeA = _mm256_andnot_ps(signMask, va);
+			const __m256 magnitudeB = _mm256_andnot_ps(signMask, vb);
+			const __m256 largest = _mm256_set1_ps(std::numeric_limits<float>::max());
+			const __m256 finite = _mm256_and_ps(_mm256_cmp_ps(magnitudeA, largest, _CMP_LE_OQ), _mm256_cmp_ps(magnitudeB, largest, _CMP_LE_OQ));
+			const __m256 larger = _mm256_max_ps(magnitudeA, magnitudeB);
+			const __m256 tolerance = _mm256_max_ps(_mm256_set1_ps(absTolerance), _mm256_mul_ps(_mm256_set1_ps(relTolerance), larger));
+			const __m256 close = _mm256_or_ps(_mm256_cmp_ps(va, vb, _CMP_EQ_OQ), _mm256_and_ps(finite, _mm256_cmp_ps(diff, tolerance, _CMP_LE_OQ)));
+			return 0xFF & ~_mm256_movemask_ps(close);
+		}
+#endif
+
+#if defined(__SSE2__)
+		static inline int NotCloseMask128(const double* a, const double* b, const double relTolerance, const double absTolerance)
+		{
+			const __m128d signMask = _mm_set1_pd(-0.0);
+			const __m128d va = _mm_loadu_pd(a);
+			const __m128d vb = _mm_loadu_pd(b);
+			const __m128d diff = _mm_andnot_pd(signMask, _mm_sub_pd(va, vb));
+			const __m128d magnitudeA = _mm_andnot_pd(signMask, va);
+			const __m128d magnitudeB = _mm_andnot_pd(signMask, vb);
+			const __m128d largest = _mm_set1_pd(std::numeric_limits<double>::max());
+			const __m128d finite = _mm_and_pd(_mm_cmple_pd(magnitudeA, largest), _mm_cmple_pd(magnitudeB, largest));
+			const __m128d larger = _mm_max_pd(magnitudeA, magnitudeB);
+			const __m128d tolerance = _mm_max_pd(_mm_set1_pd(absTolerance), _mm_mul_pd(_mm_set1_pd(relTolerance), larger));
+			const __m128d close = _mm_or_pd(_mm_cmpeq_pd(va, vb), _mm_and_pd(finite, _mm_cmple_pd(diff, tolerance)));
+			return 0x03 & ~_mm_movemask_pd(close);
+		}
+
+		static inline int NotCloseMask128(const float* a, const float* b, const float relTolerance, const float absTolerance)
+		{
+			const __m128 signMask = _mm_set1_ps(-0.0f);
+			const __m128 va = _mm_loadu_ps(a);
+			const __m128 vb = _mm_loadu_ps(b);
+			const __m128 diff = _mm_andnot_ps(signMask, _mm_sub_ps(va, vb));
+			const __m128 magnitudeA = _mm_andnot_ps(signMask, va);
+			const __m128 magnitudeB = _mm_andnot_ps(signMask, vb);
+			const __m128 largest = _mm_set1_ps(std::numeric_limits<float>::max());
+			const __m128 finite = _mm_and_ps(_mm_cmple_ps(magnitudeA, largest), _mm_cmple_ps(magnitudeB, largest));
+			const __m128 larger = _mm_max_ps(magnitudeA, magnitudeB);
+			const __m128 tolerance = _mm_max_ps(_mm_set1_ps(absTolerance), _mm_mul_ps(_mm_set1_ps(relTolerance), larger));
+			const __m128 close = _mm_or_ps(_mm_cmpeq_ps(va, vb), _mm_and_ps(finite, _mm_cmple_ps(diff, tolerance)));
+			return 0x0F & ~_mm_movemask_ps(close);
+		}
+#endif
+
+		// Returns the index of the first mismatch (count when none); counts every mismatch unless stopAtFirst.
+		template<typename T>
+		static size_t ScanMismatches(const T* a, const T* b, const size_t count, const T relTolerance, const T absTolerance,
+			const bool stopAtFirst, size_t* mismatches)
+		{
+			size_t first = count;
+			size_t found = 0;
+			size_t index = 0;
+
+#if defined(__AVX2__)
+			for(; index + (32 / sizeof(T)) <= count; index += (32 / sizeof(T)))
+			{
+				const int notClose = NotCloseMask256(a + index, b + index, relTolerance, absTolerance);
+				if(0 != notClose)
+				{
+					if(first == count)
+					{
+						first = index + static_cast<size_t>(CountTrailingZeros(notClose));
+					}
+					if(stopAtFirst)
+					{
+						return first;
+					}
+					found += static_cast<size_t>(PopCount(notClose));
+				}
+			}
+#endif
+#if defined(__SSE2__)
+			for(; index + (16 / sizeof(T)) <= count; index += (16 / sizeof(T)))
+			{
+				const int notClose = NotCloseMask128(a + index, b + index, relTolerance, absTolerance);
+				if(0 != notClose)
+				{
+					if(first == count)
+					{
+						first = index + static_cast<size_t>(CountTrailingZeros(notClose));
+					}
+					if(stopAtFirst)
+					{
+						return first;
+					}
+					found += static_cast<size_t>(PopCount(notClose));
+				}
+			}
+#endif
+
+			for(; index < count; index++)
+			{
+				if(!IsClose(a[index], b[index], relTolerance, absTolerance))
+				{
+					if(first == count)
+					{
+						first = index;
+					}
+					if(stopAtFirst)
+					{
+						return first;
+					}
+					found++;
+				}
+			}
+
+			if(mismatches)
+			{
+				*mismatches = found;
+			}
+			return first;
+		}
+
+		bool AllClose(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance)
+		{
+			return count == ScanMismatches(a, b, count, relTolerance, absTolerance, true, NULL);
+		}
+
+		bool AllClose(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance)
+		{
+			return count == ScanMismatches(a, b, count, relTolerance, absTolerance, true, NULL);
+		}
+
+		size_t CountMismatches(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance)
+		{
+			size_t mismatches = 0;
+			ScanMismatches(a, b, count, relTolerance, absTolerance, false, &mismatches);
+			return mismatches;
+		}
+
+		size_t CountMismatches(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance)
+		{
+			size_t mismatches = 0;
+			ScanMismatches(a, b, count, relTolerance, absTolerance, false, &mismatches);
+			return mismatches;
+		}
+
+		size_t FirstMismatch(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance)
+		{
+			return ScanMismatches(a, b, count, relTolerance, absTolerance, true, NULL);
+		}
+
+		size_t FirstMismatch(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance)
+		{
+			return ScanMismatches(a, b, count, relTolerance, absTolerance, true, NULL);
+		}
+	} // namespace Numeric
+
+	namespace Checksum
+	{
+		namespace CRC32
+		{
+			// Pre-calculated CRC32 lookup table using 0xEDB88320U as the reflected polynomial.
 			static const uint32_t DefaultCRC32Table[256] = {
 				0x00000000, 0x77073096, 0xEE0E612C, 0x990951BA, 0x076DC419, 0x706AF48F, 0xE963A535, 0x9E6495A3, 0x0EDB8832, 0x79DCB8A4,
 				0xE0D5E91E, 0x97D2D988, 0x09B64C2B, 0x7EB17CBD, 0xE7B82D07, 0x90BF1D91, 0x1DB71064, 0x6AB020F2, 0xF3B97148, 0x84BE41DE, 0x1ADAD47D,
@@ -301,546 +1562,4973 @@ namespace Helpers
 				0xB40BBE37, 0xC30C8EA1, 0x5A05DF1B, 0x2D02EF8D
 			};
 
-			static inline uint32_t GetTableValue(uint32_t tableOffset, const uint32_t polynomial)
+			static inline uint32_t GetTableValue(uint32_t tableOffset, const uint32_t polynomial)
+			{
+				uint32_t tableValue = 0;
+				uint32_t crc = 0;
+
+				if (CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL == polynomial)
+				{
+					return DefaultCRC32Table[static_cast<uint8_t>(tableOffset)];
+				}
+
+				for(uint32_t c = 0; c <= tableOffset; c++)
+				{
+					crc = ((crc ^ c) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 1)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 2)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 3)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 4)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 5)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 6)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 7)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+
+					tableValue = crc;
+				}
+
+				return tableValue;
+			}
+
+			uint32_t Calculate(const void* data, const size_t dataSizeBytes, const uint32_t polynomial)
+			{
+				return Recalculate(CRC32_DEFAULT, data, dataSizeBytes, polynomial);
+			}
+
+			// Runs the CRC register over the data without the final XOR.
+			static uint32_t UpdateRegister(uint32_t crc, const void* data, const size_t dataSizeBytes, const uint32_t polynomial)
+			{
+				const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data);
+				uint32_t tableIndex;
+				size_t dataIndex;
+
+				for(dataIndex = 0; dataIndex < dataSizeBytes; dataIndex++)
+				{
+					tableIndex = crc ^ static_cast<uint32_t>(dataPtr[dataIndex]);
+					crc = (crc >> 8) ^ GetTableValue(tableIndex, polynomial);
+				}
+
+				return crc;
+			}
+
+			uint32_t Recalculate(uint32_t crc, const void* data, const size_t dataSizeBytes, const uint32_t polynomial)
+			{
+				if(CRC32_DEFAULT != crc)
+				{
+					crc ^= CRC32_XOR;
+				}
+
+				crc = UpdateRegister(crc, data, dataSizeBytes, polynomial);
+
+				crc ^= CRC32_XOR;
+
+				return crc;
+			}
+
+			bool CalculateFile(const std::string& path, uint32_t& crc, const uint32_t polynomial)
+			{
+				// The register is carried between chunks unfinalised, so no CRC value has to double as a marker for
+				// "nothing read yet" (an empty file, or a chunk whose CRC happens to be CRC32_DEFAULT).
+				uint32_t state = CRC32_DEFAULT;
+				const bool read = Io::ForEachChunk(path, [&state, polynomial](const unsigned char* data, const size_t size, const unsigned long long) {
+					state = UpdateRegister(state, data, size, polynomial);
+				});
+				if(read)
+				{
+					crc = state ^ CRC32_XOR;
+				}
+				return read;
+			}
+		} // namespace CRC32
+
+		namespace CRC16
+		{
+			// Pre-calculated CRC16 lookup table with 0x8005
+			static const uint16_t DefaultCRC16Table[256] = {
+				0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0, 0x0780, 0xC741,
+				0x0500, 0xC5C1, 0xC481, 0x0440, 0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
+				0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841, 0xD801, 0x18C0, 0x1980, 0xD941,
+				0x1B00, 0xDBC1, 0xDA81, 0x1A40, 0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
+				0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641, 0xD201, 0x12C0, 0x1380, 0xD341,
+				0x1100, 0xD1C1, 0xD081, 0x1040, 0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
+				0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441, 0x3C00, 0xFCC1, 0xFD81, 0x3D40,
+				0xFF01, 0x3FC0, 0x3E80, 0xFE41, 0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
+				0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41, 0xEE01, 0x2EC0, 0x2F80, 0xEF41,
+				0x2D00, 0xEDC1, 0xEC81, 0x2C40, 0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
+				0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041, 0xA001, 0x60C0, 0x6180, 0xA141,
+				0x6300, 0xA3C1, 0xA281, 0x6240, 0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
+				0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41, 0xAA01, 0x6AC0, 0x6B80, 0xAB41,
+				0x6900, 0xA9C1, 0xA881, 0x6840, 0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
+				0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40, 0xB401, 0x74C0, 0x7580, 0xB541,
+				0x7700, 0xB7C1, 0xB681, 0x7640, 0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
+				0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241, 0x9601, 0x56C0, 0x5780, 0x9741,
+				0x5500, 0x95C1, 0x9481, 0x5440, 0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
+				0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841, 0x8801, 0x48C0, 0x4980, 0x8941,
+				0x4B00, 0x8BC1, 0x8A81, 0x4A40, 0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
+				0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641, 0x8201, 0x42C0, 0x4380, 0x8341,
+				0x4100, 0x81C1, 0x8081, 0x4040
+			};
+
+			static inline uint16_t GetTableValue(const uint16_t tableOffset, const uint16_t polynomial)
+			{
+				uint16_t tableValue = 0;
+				uint16_t crc = 0;
+
+				if(CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL == polynomial)
+				{
+					return DefaultCRC16Table[static_cast<uint8_t>(tableOffset)];
+				}
+
+				for(uint16_t c = 0; c <= tableOffset; c++)
+				{
+					crc = ((crc ^ c) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 1)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 2)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 3)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 4)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 5)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 6)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					crc = ((crc ^ (c >> 7)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+
+					tableValue = crc;
+				}
+
+				return tableValue;
+			}
+
+			uint16_t Calculate(const void* data, const size_t dataSizeBytes, const uint16_t polynomial)
+			{
+				return Recalculate(CRC16_DEFAULT, data, dataSizeBytes, polynomial);
+			}
+
+			uint16_t Recalculate(uint16_t crc, const void* data, const size_t dataSizeBytes, const uint16_t polynomial)
+			{
+				const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data);
+				uint16_t tableIndex;
+				size_t dataIndex;
+
+				if(CRC16_DEFAULT != crc)
+				{
+					crc ^= CRC16_XOR;
+				}
+
+				for(dataIndex = 0; dataIndex < dataSizeBytes; dataIndex++)
+				{
+					tableIndex = crc ^ static_cast<uint16_t>(dataPtr[dataIndex]);
+					crc = (crc >> 8) ^ GetTableValue(tableIndex, polynomial);
+				}
+
+				crc ^= CRC16_XOR;
+
+				return crc;
+			}
+		} // namespace CRC16
+	} // namespace Checksum
+
+	namespace Time
+	{
+		static long long MonotonicNanos()
+		{
+#if defined(__linux__)
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return (static_cast<long long>(now.tv_sec) * 1000000000LL) + static_cast<long long>(now.tv_nsec);
+#else
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+		}
+
+		// Tick source behind Nanos(): the TSC scaled by a 32.32 fixed-point multiplier when the TSC is invariant
+		// and the kernel trusts it as its clocksource, otherwise CLOCK_MONOTONIC nanoseconds at a 1:1 scale.
+		// The TSC rate is first estimated over a 100 us window, then refined against CLOCK_MONOTONIC by the reads
+		// that find a ten times longer baseline has passed, so no caller pays for a long calibration.
+		struct TickClock
+		{
+			// nanos = baseNanos + (ticks - baseTicks) * nanosPerTickFixed / 2^32, in nanoseconds since
+			// baseMonotonicNanos.
+			struct Scale
+			{
+				unsigned long long baseTicks;
+				long long baseNanos;
+				unsigned long long nanosPerTickFixed;
+				double ticksPerSecond;
+			};
+
+#if defined(__x86_64__) || defined(__i386__)
+			// A TSC value paired with a CLOCK_MONOTONIC read, taken as the midpoint of the rdtsc bracket around it.
+			struct ClockSample
+			{
+				unsigned long long ticks;
+				unsigned long long width;
+				long long nanos;
+			};
+#endif
+
+			bool useTsc;
+			long long baseMonotonicNanos;
+			// Scale while it is still being refined; once refineAtTicks is published as ~0ULL (release), the final
+			// scale sits in settled and is never written again.
+			Threading::SeqLock<Scale> scale;
+			Scale settled;
+			std::atomic<unsigned long long> refineAtTicks;
+			std::atomic<bool> refining;
+#if defined(__x86_64__) || defined(__i386__)
+			ClockSample anchor;
+#endif
+
+			TickClock() :
+				useTsc(false),
+				baseMonotonicNanos(0LL),
+				scale(),
+				refineAtTicks(~0ULL),
+				refining(false)
+			{
+				useTsc = IsTscReliable();
+				if(useTsc)
+				{
+					Calibrate();
+				}
+				else
+				{
+					baseMonotonicNanos = MonotonicNanos();
+					const Scale identity = { static_cast<unsigned long long>(baseMonotonicNanos), 0LL, 1ULL << 32, 1000000000.0 };
+					settled = identity;
+				}
+			}
+
+			unsigned long long Read() const
+			{
+#if defined(__x86_64__) || defined(__i386__)
+				if(useTsc)
+				{
+					return __builtin_ia32_rdtsc();
+				}
+#endif
+				return static_cast<unsigned long long>(MonotonicNanos());
+			}
+
+			static long long ScaleTicks(const unsigned long long ticks, const unsigned long long nanosPerTickFixed)
+			{
+				// (ticks * multiplier) >> 32 split so that no intermediate overflows 64 bits for years of ticks.
+				return static_cast<long long>(((ticks >> 32) * nanosPerTickFixed) + (((ticks & 0xFFFFFFFFULL) * nanosPerTickFixed) >> 32));
+			}
+
+			Scale Current() const
+			{
+				return (~0ULL == refineAtTicks.load(std::memory_order_acquire)) ? settled : scale.Load();
+			}
+
+			long long ToNanos(const unsigned long long ticks) const
+			{
+				return ScaleTicks(ticks, Current().nanosPerTickFixed);
+			}
+
+			long long ToEpochNanos(const unsigned long long ticks)
+			{
+				const unsigned long long refineAt = refineAtTicks.load(std::memory_order_acquire);
+#if defined(__x86_64__) || defined(__i386__)
+				if(~0ULL != refineAt && ticks >= refineAt)
+				{
+					Refine();
+				}
+#endif
+				const Scale current = (~0ULL == refineAt) ? settled : scale.Load();
+				const unsigned long long elapsed = ticks - current.baseTicks;
+				// A read on another core can land a few ticks before the base point.
+				return current.baseNanos + ((static_cast<long long>(elapsed) < 0) ? -ScaleTicks(0ULL - elapsed, current.nanosPerTickFixed)
+					: ScaleTicks(elapsed, current.nanosPerTickFixed));
+			}
+
+			static bool IsTscReliable()
+			{
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+				unsigned int eax = 0;
+				unsigned int ebx = 0;
+				unsigned int ecx = 0;
+				unsigned int edx = 0;
+
+				if(!__get_cpuid(0x80000007U, &eax, &ebx, &ecx, &edx) || !(edx & (1U << 8)))
+				{
+					return false;
+				}
+#if defined(__linux__)
+				std::ifstream clocksource("/sys/devices/system/clocksource/clocksource0/current_clocksource");
+				std::string name;
+				if(clocksource >> name)
+				{
+					return name == "tsc";
+				}
+#endif
+				return true;
+#else
+				return false;
+#endif
+			}
+
+#if defined(__x86_64__) || defined(__i386__)
+			// An interrupt or preemption inside a bracket widens it and moves its midpoint, so keep the narrowest.
+			static ClockSample SampleClocks()
+			{
+				ClockSample best = { 0ULL, ~0ULL, 0LL };
+				for(int sample = 0; sample < 16; sample++)
+				{
+					const unsigned long long before = __builtin_ia32_rdtsc();
+					const long long nanos = MonotonicNanos();
+					const unsigned long long width = __builtin_ia32_rdtsc() - before;
+					if(width < best.width)
+					{
+						best.ticks = before + (width / 2ULL);
+						best.width = width;
+						best.nanos = nanos;
+					}
+				}
+				return best;
+			}
+
+			Scale ScaleFromAnchor(const ClockSample& sample) const
+			{
+				Scale next;
+				next.ticksPerSecond = static_cast<double>(sample.ticks - anchor.ticks) * 1000000000.0 / static_cast<double>(sample.nanos - anchor.nanos);
+				next.nanosPerTickFixed = static_cast<unsigned long long>((4294967296.0 * 1000000000.0 / next.ticksPerSecond) + 0.5);
+				next.baseTicks = sample.ticks;
+				next.baseNanos = sample.nanos - baseMonotonicNanos;
+				return next;
+			}
+
+			// Each refinement measures from the anchor, so the pairing error shrinks as the baseline grows; the
+			// last one runs about ten seconds after the first read.
+			void ScheduleRefine(const Scale& next, const unsigned long long windowTicks)
+			{
+				if(static_cast<double>(windowTicks) >= 10.0 * next.ticksPerSecond)
+				{
+					settled = next;
+					refineAtTicks.store(~0ULL, std::memory_order_release);
+				}
+				else
+				{
+					scale.Store(next);
+					refineAtTicks.store(anchor.ticks + (windowTicks * 10ULL), std::memory_order_relaxed);
+				}
+			}
+#endif
+
+			void Calibrate()
+			{
+#if defined(__x86_64__) || defined(__i386__)
+				anchor = SampleClocks();
+				baseMonotonicNanos = anchor.nanos;
+				ClockSample end;
+				do
+				{
+					end = SampleClocks();
+				}
+				while(end.nanos - anchor.nanos < 100000LL);
+
+				ScheduleRefine(ScaleFromAnchor(end), end.ticks - anchor.ticks);
+#endif
+			}
+
+#if defined(__x86_64__) || defined(__i386__)
+			void Refine()
+			{
+				bool expected = false;
+				if(!refining.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				{
+					return;
+				}
+
+				const ClockSample sample = SampleClocks();
+				const unsigned long long windowTicks = sample.ticks - anchor.ticks;
+				if(sample.ticks >= refineAtTicks.load(std::memory_order_relaxed))
+				{
+					const Scale current = scale.Load();
+					if((anchor.width + sample.width) * 1000ULL > windowTicks)
+					{
+						// Both brackets were disturbed; try again a little later.
+						refineAtTicks.store(sample.ticks + (windowTicks / 4ULL), std::memory_order_relaxed);
+					}
+					else
+					{
+						// Continue from the current mapping so that Nanos() never steps back, catching up with
+						// CLOCK_MONOTONIC only when behind it.
+						Scale next = ScaleFromAnchor(sample);
+						next.baseNanos = std::max(next.baseNanos, current.baseNanos + ScaleTicks(sample.ticks - current.baseTicks, current.nanosPerTickFixed));
+						ScheduleRefine(next, windowTicks);
+					}
+				}
+
+				refining.store(false, std::memory_order_release);
+			}
+#endif
+		};
+
+		static TickClock& GetTickClock()
+		{
+			static TickClock tickClock;
+			return tickClock;
+		}
+
+		static long long TicksToEpochNanos(const unsigned long long ticks)
+		{
+			return GetTickClock().ToEpochNanos(ticks);
+		}
+
+		long long Nanos()
+		{
+			return TicksToEpochNanos(GetTickClock().Read());
+		}
+
+		unsigned long long Ticks()
+		{
+			return GetTickClock().Read();
+		}
+
+		long long TicksToNanos(const unsigned long long ticks)
+		{
+			return GetTickClock().ToNanos(ticks);
+		}
+
+		double TicksPerSecond()
+		{
+			return GetTickClock().Current().ticksPerSecond;
+		}
+
+		bool IsTscClock()
+		{
+			return GetTickClock().useTsc;
+		}
+
+		long long Micros()
+		{
+			return Nanos() / 1000LL;
+		}
+
+		long long Millis()
+		{
+			return  Micros() / 1000LL;
+		}
+
+		double Seconds()
+		{
+			return MicrosToSeconds(Micros());
+		}
+
+		double MicrosToSeconds(long long micros)
+		{
+			return static_cast<double>(micros) / 1000000.0;
+		}
+
+		double MillisToSeconds(long long millis)
+		{
+			return static_cast<double>(millis) / 1000.0;
+		}
+
+		long long SecondsToMicros(double seconds)
+		{
+			double partSeconds;
+			partSeconds = std::modf(seconds, &seconds);
+			return (static_cast<long long>(seconds) * 1000000LL)
+					+ static_cast<long long>(partSeconds * 1000000.0);
+		}
+
+		long long SecondsToMillis(double seconds)
+		{
+			return SecondsToMicros(seconds) / 1000LL;
+		}
+
+		static void SleepUntilMonotonicNanos(const long long deadline)
+		{
+#if defined(__linux__)
+			struct timespec until;
+			until.tv_sec = static_cast<time_t>(deadline / 1000000000LL);
+			until.tv_nsec = static_cast<long>(deadline % 1000000000LL);
+			while(EINTR == clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL))
+			{
+			}
+#else
+			std::this_thread::sleep_until(std::chrono::steady_clock::time_point(
+				std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(deadline))));
+#endif
+		}
+
+		static const long long WaitSpinMinNanos = 20000LL;
+		static const long long WaitSpinMaxNanos = 2000000LL;
+		static std::atomic<long long> waitSpinNanos(-1LL);
+
+		long long CalibrateWaitSpin()
+		{
+			// Sample how late short absolute sleeps wake up and spin for the worst of them plus some margin,
+			// discarding the single largest sample as a likely preemption outlier.
+			const int samples = 16;
+			const long long requested = 100000LL;
+			std::vector<long long> lateness;
+
+			for(int i = 0; i < samples; i++)
+			{
+				const long long deadline = MonotonicNanos() + requested;
+				SleepUntilMonotonicNanos(deadline);
+				lateness.push_back(MonotonicNanos() - deadline);
+			}
+
+			std::sort(lateness.begin(), lateness.end());
+			const long long spin = std::min(WaitSpinMaxNanos, std::max(WaitSpinMinNanos, lateness[samples - 2] + (lateness[samples - 2] / 4)));
+			waitSpinNanos.store(spin);
+			return spin;
+		}
+
+		long long GetWaitSpinNanos()
+		{
+			const long long spin = waitSpinNanos.load(std::memory_order_relaxed);
+			return (spin >= 0) ? spin : CalibrateWaitSpin();
+		}
+
+		void SetWaitSpinNanos(const long long nanos)
+		{
+			waitSpinNanos.store(std::max(0LL, nanos));
+		}
+
+		static void WaitUntilMonotonicNanos(const long long deadline)
+		{
+			const long long spin = GetWaitSpinNanos();
+
+			if(deadline - MonotonicNanos() > spin)
+			{
+				SleepUntilMonotonicNanos(deadline - spin);
+			}
+
+			while(MonotonicNanos() < deadline)
+			{
+				Threading::CpuRelax();
+			}
+		}
+
+		void WaitSeconds(double seconds)
+		{
+			WaitNanos(static_cast<long long>(seconds * 1000000000.0));
+		}
+
+		void WaitMillis(long long millis)
+		{
+			WaitNanos(millis * 1000000LL);
+		}
+
+		void WaitMicros(long long micros)
+		{
+			WaitNanos(micros * 1000LL);
+		}
+
+		void WaitNanos(long long nanos)
+		{
+			if(nanos > 0)
+			{
+				WaitUntilMonotonicNanos(MonotonicNanos() + nanos);
+			}
+		}
+
+		Stopwatch::Stopwatch()
+		{
+			Set(0LL);
+		}
+
+		Stopwatch::Stopwatch(const int micros)
+		{
+			Set(micros);
+		}
+
+		Stopwatch::Stopwatch(const unsigned int micros)
+		{
+			Set(micros);
+		}
+
+		Stopwatch::Stopwatch(const long long micros)
+		{
+			Set(micros);
+		}
+
+		Stopwatch::Stopwatch(const unsigned long long micros)
+		{
+			Set(micros);
+		}
+
+		Stopwatch::Stopwatch(const double seconds)
+		{
+			Set(seconds);
+		}
+
+		void Stopwatch::Reset()
+		{
+			Set(0LL);
+		}
+
+		void Stopwatch::Set(const long long micros)
+		{
+			m_beganAt = Micros() + micros;
+		}
+
+		void Stopwatch::Set(const unsigned long long micros)
+		{
+			Set(static_cast<long long>(micros));
+		}
+
+		void Stopwatch::Set(const int micros)
+		{
+			Set(static_cast<long long>(micros));
+		}
+
+		void Stopwatch::Set(const unsigned int micros)
+		{
+			Set(static_cast<long long>(micros));
+		}
+
+		void Stopwatch::Set(const double seconds)
+		{
+			Set(SecondsToMicros(seconds));
+		}
+
+		long long Stopwatch::Get() const
+		{
+			return Micros() - m_beganAt;
+		}
+
+		long long Stopwatch::GetMillis() const
+		{
+			return Get() / 1000LL;
+		}
+
+		double Stopwatch::GetSeconds() const
+		{
+			return MicrosToSeconds(Get());
+		}
+
+		bool Stopwatch::HasExceded(const long long micros) const
+		{
+			return static_cast<bool>(Get() >= micros);
+		}
+
+		bool Stopwatch::HasExceded(const unsigned long long micros) const
+		{
+			return static_cast<bool>(Get() >= static_cast<long long>(micros));
+		}
+
+		bool Stopwatch::HasExceded(const int micros) const
+		{
+			return static_cast<bool>(Get() >= static_cast<long long>(micros));
+		}
+
+		bool Stopwatch::HasExceded(const unsigned int micros) const
+		{
+			return static_cast<bool>(Get() >= static_cast<long long>(micros));
+		}
+
+		bool Stopwatch::HasExceded(const double seconds) const
+		{
+			return static_cast<bool>(GetSeconds() > seconds || Numeric::IsDoubleEqual(GetSeconds(), seconds));
+		}
+
+		void Stopwatch::operator=(const long long& value)
+		{
+			Set(value);
+		}
+
+		void Stopwatch::operator=(const unsigned long long& value)
+		{
+			Set(value);
+		}
+
+		void Stopwatch::operator=(const int& value)
+		{
+			Set(value);
+		}
+
+		void Stopwatch::operator=(const unsigned int& value)
+		{
+			Set(value);
+		}
+
+		void Stopwatch::operator=(const double& value)
+		{
+			Set(value);
+		}
+
+		bool Stopwatch::operator>(const long long& value)
+		{
+			return Get() > value;
+		}
+
+		bool Stopwatch::operator>(const unsigned long long& value)
+		{
+			return Get() > static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>(const int& value)
+		{
+			return Get() > static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>(const unsigned int& value)
+		{
+			return Get() > static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>(const double& value)
+		{
+			return MicrosToSeconds(Get()) > value;
+		}
+
+		bool Stopwatch::operator<(const long long& value)
+		{
+			return Get() < value;
+		}
+
+		bool Stopwatch::operator<(const unsigned long long& value)
+		{
+			return Get() < static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<(const int& value)
+		{
+			return Get() < static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<(const unsigned int& value)
+		{
+			return Get() < static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<(const double& value)
+		{
+			return MicrosToSeconds(Get()) < value;
+		}
+
+		bool Stopwatch::operator>=(const long long& value)
+		{
+			return Get() >= value;
+		}
+
+		bool Stopwatch::operator>=(const unsigned long long& value)
+		{
+			return Get() >= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>=(const int& value)
+		{
+			return Get() >= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>=(const unsigned int& value)
+		{
+			return Get() >= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator>=(const double& value)
+		{
+			const double seconds = GetSeconds();
+			return static_cast<bool>((seconds > value) || Numeric::IsDoubleEqual(seconds, value));
+		}
+
+		bool Stopwatch::operator<=(const long long& value)
+		{
+			return Get() <= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<=(const unsigned long long& value)
+		{
+			return Get() <= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<=(const int& value)
+		{
+			return Get() <= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<=(const unsigned int& value)
+		{
+			return Get() <= static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator<=(const double& value)
+		{
+			const double seconds = GetSeconds();
+			return static_cast<bool>((seconds < value) || Numeric::IsDoubleEqual(seconds, value));
+		}
+
+		bool Stopwatch::operator==(const long long& value)
+		{
+			return Get() == value;
+		}
+
+		bool Stopwatch::operator==(const unsigned long long& value)
+		{
+			return Get() == static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator==(const int& value)
+		{
+			return Get() == static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator==(const unsigned int& value)
+		{
+			return Get() == static_cast<long long>(value);
+		}
+
+		bool Stopwatch::operator==(const double& value)
+		{
+			return Numeric::IsDoubleEqual(MicrosToSeconds(Get()), value);
+		}
+
+		LatencyHistogram::LatencyHistogram(const unsigned int subBucketBits) :
+			m_subBucketBits(std::min(12U, std::max(2U, subBucketBits))),
+			m_bucketCount(0),
+			m_counts(),
+			m_totalCount(0ULL),
+			m_sum(0LL),
+			m_min(std::numeric_limits<long long>::max()),
+			m_max(0LL)
+		{
+			// Values reach 2^63 - 1, so the last octave starts at shift 63 - subBucketBits.
+			m_bucketCount = static_cast<size_t>(65U - m_subBucketBits) << (m_subBucketBits - 1U);
+			m_counts.reset(new std::atomic<unsigned long long>[m_bucketCount]);
+			Reset();
+		}
+
+		LatencyHistogram::LatencyHistogram(const LatencyHistogram& other) :
+			LatencyHistogram(other.m_subBucketBits)
+		{
+			Merge(other);
+		}
+
+		size_t LatencyHistogram::BucketIndex(const unsigned long long value) const
+		{
+			if(value < (1ULL << m_subBucketBits))
+			{
+				return static_cast<size_t>(value);
+			}
+			const unsigned int shift = static_cast<unsigned int>(Numeric::Log2Floor(value)) - m_subBucketBits + 1U;
+			return (static_cast<size_t>(shift) << (m_subBucketBits - 1U)) + static_cast<size_t>(value >> shift);
+		}
+
+		long long LatencyHistogram::BucketUpperBound(const size_t index) const
+		{
+			if(index < (static_cast<size_t>(1) << m_subBucketBits))
+			{
+				return static_cast<long long>(index);
+			}
+			const unsigned int shift = static_cast<unsigned int>(index >> (m_subBucketBits - 1U)) - 1U;
+			const unsigned long long lower = static_cast<unsigned long long>(index - (static_cast<size_t>(shift) << (m_subBucketBits - 1U))) << shift;
+			return static_cast<long long>(lower + ((1ULL << shift) - 1ULL));
+		}
+
+		void LatencyHistogram::Record(const long long value)
+		{
+			Record(value, 1ULL);
+		}
+
+		void LatencyHistogram::Record(const long long value, const unsigned long long count)
+		{
+			const long long clamped = std::max(0LL, value);
+
+			m_counts[BucketIndex(static_cast<unsigned long long>(clamped))].fetch_add(count, std::memory_order_relaxed);
+			m_totalCount.fetch_add(count, std::memory_order_relaxed);
+			m_sum.fetch_add(clamped * static_cast<long long>(count), std::memory_order_relaxed);
+
+			long long extreme = m_min.load(std::memory_order_relaxed);
+			while(clamped < extreme && !m_min.compare_exchange_weak(extreme, clamped, std::memory_order_relaxed))
+			{
+			}
+			extreme = m_max.load(std::memory_order_relaxed);
+			while(clamped > extreme && !m_max.compare_exchange_weak(extreme, clamped, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void LatencyHistogram::RecordElapsed(const Stopwatch& stopwatch)
+		{
+			// Nanoseconds, like ScopedLatency, so both can share a histogram.
+			Record(stopwatch.Get() * 1000LL);
+		}
+
+		void LatencyHistogram::Merge(const LatencyHistogram& other)
+		{
+			if(other.m_subBucketBits != m_subBucketBits)
+			{
+				throw std::invalid_argument("LatencyHistogram::Merge requires matching sub-bucket precision");
+			}
+
+			for(size_t index = 0; index < m_bucketCount; index++)
+			{
+				const unsigned long long count = other.m_counts[index].load(std::memory_order_relaxed);
+				if(count > 0ULL)
+				{
+					m_counts[index].fetch_add(count, std::memory_order_relaxed);
+				}
+			}
+			m_totalCount.fetch_add(other.m_totalCount.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			m_sum.fetch_add(other.m_sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+
+			const long long otherMin = other.m_min.load(std::memory_order_relaxed);
+			long long extreme = m_min.load(std::memory_order_relaxed);
+			while(otherMin < extreme && !m_min.compare_exchange_weak(extreme, otherMin, std::memory_order_relaxed))
+			{
+			}
+			const long long otherMax = other.m_max.load(std::memory_order_relaxed);
+			extreme = m_max.load(std::memory_order_relaxed);
+			while(otherMax > extreme && !m_max.compare_exchange_weak(extreme, otherMax, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void LatencyHistogram::Reset()
+		{
+			for(size_t index = 0; index < m_bucketCount; index++)
+			{
+				m_counts[index].store(0ULL, std::memory_order_relaxed);
+			}
+			m_totalCount.store(0ULL, std::memory_order_relaxed);
+			m_sum.store(0LL, std::memory_order_relaxed);
+			m_min.store(std::numeric_limits<long long>::max(), std::memory_order_relaxed);
+			m_max.store(0LL, std::memory_order_relaxed);
+		}
+
+		unsigned long long LatencyHistogram::Count() const
+		{
+			return m_totalCount.load(std::memory_order_relaxed);
+		}
+
+		long long LatencyHistogram::Min() const
+		{
+			return (0ULL == Count()) ? 0LL : m_min.load(std::memory_order_relaxed);
+		}
+
+		long long LatencyHistogram::Max() const
+		{
+			return m_max.load(std::memory_order_relaxed);
+		}
+
+		double LatencyHistogram::Mean() const
+		{
+			const unsigned long long count = Count();
+			return (0ULL == count) ? 0.0 : static_cast<double>(m_sum.load(std::memory_order_relaxed)) / static_cast<double>(count);
+		}
+
+		long long LatencyHistogram::Percentile(const double percentile) const
+		{
+			const unsigned long long count = Count();
+
+			if(0ULL == count || percentile <= 0.0)
+			{
+				return Min();
+			}
+
+			const unsigned long long target = std::max(1ULL, static_cast<unsigned long long>(std::ceil(std::min(100.0, percentile) / 100.0 * static_cast<double>(count))));
+			unsigned long long seen = 0ULL;
+
+			for(size_t index = 0; index < m_bucketCount; index++)
+			{
+				seen += m_counts[index].load(std::memory_order_relaxed);
+				if(seen >= target)
+				{
+					return std::min(BucketUpperBound(index), Max());
+				}
+			}
+
+			return Max();
+		}
+
+		unsigned int LatencyHistogram::SubBucketBits() const
+		{
+			return m_subBucketBits;
+		}
+
+		static const double ReportedPercentiles[] = { 50.0, 90.0, 99.0, 99.9, 99.99 };
+
+		std::string LatencyHistogram::ToString(const char* unit) const
+		{
+			std::string text = Text::Stringf("count=%llu min=%lld%s mean=%.1f%s max=%lld%s",
+				Count(), Min(), unit, Mean(), unit, Max(), unit);
+
+			for(const double percentile : ReportedPercentiles)
+			{
+				text += Text::Stringf(" p%g=%lld%s", percentile, Percentile(percentile), unit);
+			}
+
+			return text;
+		}
+
+		std::string LatencyHistogram::ToJson() const
+		{
+			std::string json = Text::Stringf("{\"count\":%llu,\"min\":%lld,\"max\":%lld,\"mean\":%.3f,\"percentiles\":{",
+				Count(), Min(), Max(), Mean());
+
+			bool first = true;
+			for(const double percentile : ReportedPercentiles)
+			{
+				json += Text::Stringf("%s\"%g\":%lld", first ? "" : ",", percentile, Percentile(percentile));
+				first = false;
+			}
+
+			// Non-empty buckets as [upper bound, count] pairs so that other tools can re-aggregate them.
+			json += "},\"buckets\":[";
+			first = true;
+			for(size_t index = 0; index < m_bucketCount; index++)
+			{
+				const unsigned long long count = m_counts[index].load(std::memory_order_relaxed);
+				if(count > 0ULL)
+				{
+					json += Text::Stringf("%s[%lld,%llu]", first ? "" : ",", BucketUpperBound(index), count);
+					first = false;
+				}
+			}
+			json += "]}";
+
+			return json;
+		}
+
+		ScopedLatency::~ScopedLatency()
+		{
+			const unsigned long long elapsedTicks = Ticks() - m_beganTicks;
+			m_histogram.Record((static_cast<long long>(elapsedTicks) < 0) ? 0LL : TicksToNanos(elapsedTicks));
+		}
+
+		struct TraceEvent
+		{
+			const char* name;
+			unsigned long long beganTicks;
+			unsigned long long endedTicks;
+		};
+
+		// Single-producer ring owned by one thread; the drain is the only consumer and runs under traceRegistryMutex.
+		struct TraceBuffer
+		{
+			std::unique_ptr<TraceEvent[]> events;
+			size_t mask;
+			unsigned int threadId;
+			std::atomic<size_t> head;
+			std::atomic<size_t> tail;
+			std::atomic<unsigned long long> dropped;
+			std::atomic<bool> retired;
+
+			TraceBuffer(const size_t capacity, const unsigned int id) :
+				events(new TraceEvent[capacity]),
+				mask(capacity - 1U),
+				threadId(id),
+				head(0U),
+				tail(0U),
+				dropped(0ULL),
+				retired(false)
+			{
+			}
+		};
+
+		// Marks the ring retired when its thread exits so the next drain can release it.
+		struct TraceThreadHandle
+		{
+			std::shared_ptr<TraceBuffer> buffer;
+
+			~TraceThreadHandle()
+			{
+				if(buffer)
+				{
+					buffer->retired.store(true, std::memory_order_release);
+				}
+			}
+		};
+
+		static std::atomic<bool> traceEnabled(false);
+		static std::atomic<size_t> traceBufferCapacity(16384U);
+		static std::atomic<unsigned long long> traceRetiredDropped(0ULL);
+		static std::mutex traceRegistryMutex;
+		static std::vector<std::shared_ptr<TraceBuffer>> traceRegistry;
+		static unsigned int traceNextThreadId = 1U;
+
+		static TraceBuffer* GetThreadTraceBuffer()
+		{
+			static thread_local TraceThreadHandle handle;
+
+			if(!handle.buffer)
+			{
+				std::lock_guard<std::mutex> lock(traceRegistryMutex);
+				handle.buffer = std::make_shared<TraceBuffer>(traceBufferCapacity.load(std::memory_order_relaxed), traceNextThreadId++);
+				traceRegistry.push_back(handle.buffer);
+			}
+
+			return handle.buffer.get();
+		}
+
+		void SetTraceEnabled(const bool enabled)
+		{
+			traceEnabled.store(enabled, std::memory_order_relaxed);
+		}
+
+		bool IsTraceEnabled()
+		{
+			return traceEnabled.load(std::memory_order_relaxed);
+		}
+
+		void SetTraceBufferCapacity(const size_t events)
+		{
+			traceBufferCapacity.store(static_cast<size_t>(Numeric::NextPow2(std::max(static_cast<size_t>(2U), events))), std::memory_order_relaxed);
+		}
+
+		void RecordTraceSpan(const char* name, const unsigned long long beganTicks, const unsigned long long endedTicks)
+		{
+			TraceBuffer* buffer = GetThreadTraceBuffer();
+			const size_t head = buffer->head.load(std::memory_order_relaxed);
+
+			if(head - buffer->tail.load(std::memory_order_acquire) > buffer->mask)
+			{
+				buffer->dropped.fetch_add(1ULL, std::memory_order_relaxed);
+				return;
+			}
+
+			TraceEvent& event = buffer->events[head & buffer->mask];
+			event.name = name;
+			event.beganTicks = beganTicks;
+			event.endedTicks = endedTicks;
+			buffer->head.store(head + 1U, std::memory_order_release);
+		}
+
+		static void AppendJsonEscaped(std::string& json, const char* text)
+		{
+			for(const char* c = (text != nullptr) ? text : ""; *c != '\0'; c++)
+			{
+				const unsigned char ch = static_cast<unsigned char>(*c);
+				if('"' == ch || '\\' == ch)
+				{
+					json += '\\';
+					json += static_cast<char>(ch);
+				}
+				else if(ch < 0x20U)
+				{
+					json += Text::Stringf("\\u%04x", static_cast<unsigned int>(ch));
+				}
+				else
+				{
+					json += static_cast<char>(ch);
+				}
+			}
+		}
+
+		std::string DrainTraceJson()
+		{
+#if defined(__linux__)
+			const long long processId = static_cast<long long>(getpid());
+#else
+			const long long processId = 1LL;
+#endif
+			std::string json = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+			bool first = true;
+			std::lock_guard<std::mutex> lock(traceRegistryMutex);
+
+			for(std::vector<std::shared_ptr<TraceBuffer>>::iterator it = traceRegistry.begin(); it != traceRegistry.end();)
+			{
+				TraceBuffer& buffer = **it;
+				// Read retired before head so that a ring seen as retired is drained completely.
+				const bool retired = buffer.retired.load(std::memory_order_acquire);
+				const size_t head = buffer.head.load(std::memory_order_acquire);
+				size_t tail = buffer.tail.load(std::memory_order_relaxed);
+
+				for(; tail != head; tail++)
+				{
+					const TraceEvent& event = buffer.events[tail & buffer.mask];
+					const long long began = std::max(0LL, TicksToEpochNanos(event.beganTicks));
+					const long long duration = std::max(0LL, TicksToEpochNanos(event.endedTicks) - began);
+
+					// Chrome trace timestamps are microseconds; keep nanosecond resolution in the fraction.
+					json += first ? "{\"name\":\"" : ",{\"name\":\"";
+					AppendJsonEscaped(json, event.name);
+					json += Text::Stringf("\",\"ph\":\"X\",\"ts\":%lld.%03lld,\"dur\":%lld.%03lld,\"pid\":%lld,\"tid\":%u}",
+						began / 1000LL, began % 1000LL, duration / 1000LL, duration % 1000LL, processId, buffer.threadId);
+					first = false;
+				}
+				buffer.tail.store(tail, std::memory_order_release);
+
+				if(retired)
+				{
+					traceRetiredDropped.fetch_add(buffer.dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+					it = traceRegistry.erase(it);
+				}
+				else
+				{
+					++it;
+				}
+			}
+			json += "]}";
+
+			return json;
+		}
+
+		unsigned long long TraceDroppedCount()
+		{
+			std::lock_guard<std::mutex> lock(traceRegistryMutex);
+			unsigned long long dropped = traceRetiredDropped.load(std::memory_order_relaxed);
+
+			for(const std::shared_ptr<TraceBuffer>& buffer : traceRegistry)
+			{
+				dropped += buffer->dropped.load(std::memory_order_relaxed);
+			}
+
+			return dropped;
+		}
+
+		CoarseClock::CoarseClock(const long long tickMicros, const Source source) :
+			m_source(source),
+			m_tickNanos(std::max(1LL, tickMicros) * 1000LL),
+			m_nanos(0LL),
+			m_maxGapNanos(0LL),
+			m_stopRequested(false),
+			m_updateMutex(),
+			m_updateStopCond(),
+			m_updateThread()
+		{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+			if(Source::Kernel == m_source)
+			{
+				struct timespec resolution;
+				if(0 == clock_getres(CLOCK_MONOTONIC_COARSE, &resolution))
+				{
+					m_tickNanos = (static_cast<long long>(resolution.tv_sec) * 1000000000LL) + static_cast<long long>(resolution.tv_nsec);
+				}
+				// The coarse clock advances once per jiffy, and a tickless kernel can be up to a jiffy late with that.
+				m_maxGapNanos.store(2LL * m_tickNanos, std::memory_order_relaxed);
+				return;
+			}
+#endif
+			m_source = Source::Thread;
+			m_nanos.store(Time::Nanos(), std::memory_order_relaxed);
+			m_updateThread.reset(new std::thread(CoarseClock::InternalUpdateFunc, this));
+		}
+
+		CoarseClock::~CoarseClock()
+		{
+			if(m_updateThread)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_updateMutex);
+					m_stopRequested = true;
+				}
+				m_updateStopCond.notify_all();
+				m_updateThread->join();
+			}
+		}
+
+		long long CoarseClock::KernelNanos() const
+		{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+			const long long nanos = (static_cast<long long>(now.tv_sec) * 1000000000LL) + static_cast<long long>(now.tv_nsec)
+				- GetTickClock().baseMonotonicNanos;
+			// The coarse clock can trail the calibration point by up to one jiffy right after startup.
+			return std::max(0LL, nanos);
+#else
+			return m_nanos.load(std::memory_order_relaxed);
+#endif
+		}
+
+		long long CoarseClock::ReferenceNanos() const
+		{
+#if defined(__linux__) && defined(CLOCK_MONOTONIC_COARSE)
+			if(Source::Kernel == m_source)
+			{
+				return std::max(0LL, MonotonicNanos() - GetTickClock().baseMonotonicNanos);
+			}
+#endif
+			return Time::Nanos();
+		}
+
+		void CoarseClock::Publish(const long long nanos)
+		{
+			// Refresh() and the update thread can race; keep whichever is later so readers never see time step back.
+			long long current = m_nanos.load(std::memory_order_relaxed);
+			while(nanos > current && !m_nanos.compare_exchange_weak(current, nanos, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void CoarseClock::Refresh()
+		{
+			if(Source::Thread == m_source)
+			{
+				Publish(Time::Nanos());
+			}
+		}
+
+		CoarseClock::Source CoarseClock::GetSource() const
+		{
+			return m_source;
+		}
+
+		long long CoarseClock::TickNanos() const
+		{
+			return m_tickNanos;
+		}
+
+		long long CoarseClock::MaxStalenessNanos() const
+		{
+			return std::max(m_tickNanos, m_maxGapNanos.load(std::memory_order_relaxed));
+		}
+
+		CoarseClock& CoarseClock::Global()
+		{
+			static CoarseClock globalClock;
+			return globalClock;
+		}
+
+		void CoarseClock::InternalUpdateFunc(CoarseClock* clock)
+		{
+			const std::chrono::nanoseconds tick(clock->m_tickNanos);
+			std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + tick;
+			long long published = clock->m_nanos.load(std::memory_order_relaxed);
+			std::unique_lock<std::mutex> lock(clock->m_updateMutex);
+
+			while(!clock->m_stopRequested)
+			{
+				if(clock->m_updateStopCond.wait_until(lock, deadline, [clock]() { return clock->m_stopRequested; }))
+				{
+					break;
+				}
+
+				// The gap between two publishes is the longest a reader could have seen the older value.
+				const long long nanos = Time::Nanos();
+				clock->Publish(nanos);
+				if(nanos - published > clock->m_maxGapNanos.load(std::memory_order_relaxed))
+				{
+					clock->m_maxGapNanos.store(nanos - published, std::memory_order_relaxed);
+				}
+				published = nanos;
+
+				const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+				// Stay on the tick grid, but after a long stall restart from now rather than bursting to catch up.
+				deadline += tick;
+				if(deadline < now)
+				{
+					deadline = now + tick;
+				}
+			}
+		}
+	} // namespace Time
+
+	namespace Threading
+	{
+#if defined(__linux__)
+		static_assert(sizeof(std::atomic<unsigned int>) == sizeof(unsigned int), "futex words must be plain 32-bit integers");
+
+		bool FutexWait(std::atomic<unsigned int>& word, const unsigned int expected, const long long timeoutMicros)
+		{
+			struct timespec timeout;
+			if(timeoutMicros >= 0LL)
+			{
+				timeout.tv_sec = static_cast<time_t>(timeoutMicros / 1000000LL);
+				timeout.tv_nsec = static_cast<long>((timeoutMicros % 1000000LL) * 1000LL);
+			}
+
+			const long result = syscall(SYS_futex, reinterpret_cast<unsigned int*>(&word), FUTEX_WAIT_PRIVATE, expected,
+				(timeoutMicros >= 0LL) ? &timeout : NULL, NULL, 0);
+			return !(-1L == result && ETIMEDOUT == errno);
+		}
+
+		void FutexWake(std::atomic<unsigned int>& word, const int count)
+		{
+			syscall(SYS_futex, reinterpret_cast<unsigned int*>(&word), FUTEX_WAKE_PRIVATE, count, NULL, NULL, 0);
+		}
+#else
+		struct FutexBucket
+		{
+			std::mutex mutex;
+			std::condition_variable wakeCond;
+		};
+
+		static FutexBucket& GetFutexBucket(const void* address)
+		{
+			static FutexBucket buckets[64];
+			return buckets[(reinterpret_cast<uintptr_t>(address) >> 2) & 63U];
+		}
+
+		bool FutexWait(std::atomic<unsigned int>& word, const unsigned int expected, const long long timeoutMicros)
+		{
+			FutexBucket& bucket = GetFutexBucket(&word);
+			std::unique_lock<std::mutex> lock(bucket.mutex);
+
+			if(word.load() != expected)
+			{
+				return true;
+			}
+			if(timeoutMicros < 0LL)
+			{
+				bucket.wakeCond.wait(lock);
+				return true;
+			}
+			return std::cv_status::no_timeout == bucket.wakeCond.wait_for(lock, std::chrono::microseconds(timeoutMicros));
+		}
+
+		void FutexWake(std::atomic<unsigned int>& word, const int count)
+		{
+			FutexBucket& bucket = GetFutexBucket(&word);
+			(void)count;
+			{
+				std::lock_guard<std::mutex> lock(bucket.mutex);
+			}
+			bucket.wakeCond.notify_all();
+		}
+#endif
+
+		void FutexWakeAll(std::atomic<unsigned int>& word)
+		{
+			FutexWake(word, std::numeric_limits<int>::max());
+		}
+
+#if defined(__linux__)
+		// Parses sysfs CPU lists such as "0-3,8,10-11".
+		static std::vector<int> ParseCpuList(const std::string& list)
+		{
+			std::vector<int> cpus;
+			std::stringstream stream(list);
+			std::string range;
+
+			while(std::getline(stream, range, ','))
+			{
+				int first = 0;
+				int last = 0;
+				const int fields = sscanf(range.c_str(), "%d-%d", &first, &last);
+				if(fields < 1)
+				{
+					continue;
+				}
+				if(fields < 2)
+				{
+					last = first;
+				}
+				for(int cpu = first; cpu <= last; cpu++)
+				{
+					cpus.push_back(cpu);
+				}
+			}
+			return cpus;
+		}
+
+		static std::string ReadSysfsLine(const std::string& path)
+		{
+			std::ifstream file(path.c_str());
+			std::string line;
+			std::getline(file, line);
+			return line;
+		}
+
+		static int ReadSysfsInt(const std::string& path, const int fallback)
+		{
+			const std::string line = ReadSysfsLine(path);
+			return line.empty() ? fallback : atoi(line.c_str());
+		}
+
+		static std::vector<int> ListNumaNodes()
+		{
+			std::vector<int> nodes;
+			DIR* dir = opendir("/sys/devices/system/node");
+			if(NULL != dir)
+			{
+				for(struct dirent* entry = readdir(dir); NULL != entry; entry = readdir(dir))
+				{
+					int node = 0;
+					if(1 == sscanf(entry->d_name, "node%d", &node))
+					{
+						nodes.push_back(node);
+					}
+				}
+				closedir(dir);
+			}
+			std::sort(nodes.begin(), nodes.end());
+			return nodes;
+		}
+
+		static std::vector<int> NumaNodeCpus(const int node)
+		{
+			return ParseCpuList(ReadSysfsLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+		}
+
+		bool ApplyThreadConfig(const ThreadConfig& config)
+		{
+			bool applied = true;
+
+			if(config.numaNode >= 0)
+			{
+				// Preferred rather than bound, so allocations fall back to other nodes instead of failing.
+				unsigned long nodeMask[16] = {};
+				const unsigned long bitsPerWord = sizeof(unsigned long) * 8U;
+				if(static_cast<unsigned long>(config.numaNode) < sizeof(nodeMask) * 8U)
+				{
+					nodeMask[config.numaNode / bitsPerWord] |= 1UL << (config.numaNode % bitsPerWord);
+					applied &= (0L == syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodeMask, sizeof(nodeMask) * 8U));
+				}
+				else
+				{
+					applied = false;
+				}
+			}
+
+			const std::vector<int> cpus = (config.cpus.empty() && config.numaNode >= 0) ? NumaNodeCpus(config.numaNode) : config.cpus;
+			if(!cpus.empty())
+			{
+				cpu_set_t cpuSet;
+				CPU_ZERO(&cpuSet);
+				for(const int cpu : cpus)
+				{
+					if(cpu >= 0 && cpu < CPU_SETSIZE)
+					{
+						CPU_SET(cpu, &cpuSet);
+					}
+				}
+				applied &= (0 == pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet));
+			}
+
+			if(ThreadConfig::Policy::Default != config.policy)
+			{
+				const int policy = (ThreadConfig::Policy::Fifo == config.policy) ? SCHED_FIFO : SCHED_RR;
+				struct sched_param param;
+				memset(&param, 0, sizeof(param));
+				param.sched_priority = std::min(std::max(config.priority, sched_get_priority_min(policy)), sched_get_priority_max(policy));
+				applied &= (0 == pthread_setschedparam(pthread_self(), policy, &param));
+			}
+
+			if(!config.name.empty())
+			{
+				applied &= (0 == pthread_setname_np(pthread_self(), config.name.substr(0U, 15U).c_str()));
+			}
+
+			return applied;
+		}
+
+		std::string CurrentThreadName()
+		{
+			char name[16] = {};
+			return (0 == pthread_getname_np(pthread_self(), name, sizeof(name))) ? std::string(name) : std::string();
+		}
+
+		int CurrentCpu()
+		{
+			return sched_getcpu();
+		}
+
+		CpuTopology CpuTopology::Query()
+		{
+			CpuTopology topology;
+			std::vector<int> online = ParseCpuList(ReadSysfsLine("/sys/devices/system/cpu/online"));
+			if(online.empty())
+			{
+				for(unsigned int cpu = 0U; cpu < std::max(1U, std::thread::hardware_concurrency()); cpu++)
+				{
+					online.push_back(static_cast<int>(cpu));
+				}
+			}
+
+			std::vector<int> nodeOfCpu;
+			for(const int node : ListNumaNodes())
+			{
+				for(const int cpu : NumaNodeCpus(node))
+				{
+					if(static_cast<size_t>(cpu) >= nodeOfCpu.size())
+					{
+						nodeOfCpu.resize(static_cast<size_t>(cpu) + 1U, 0);
+					}
+					nodeOfCpu[static_cast<size_t>(cpu)] = node;
+				}
+			}
+
+			for(const int id : online)
+			{
+				const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology/";
+				Cpu cpu;
+				cpu.id = id;
+				cpu.core = ReadSysfsInt(base + "core_id", id);
+				cpu.package = ReadSysfsInt(base + "physical_package_id", 0);
+				cpu.numaNode = (static_cast<size_t>(id) < nodeOfCpu.size()) ? nodeOfCpu[static_cast<size_t>(id)] : 0;
+				cpu.siblings = ParseCpuList(ReadSysfsLine(base + "thread_siblings_list"));
+				if(cpu.siblings.empty())
+				{
+					cpu.siblings.push_back(id);
+				}
+				topology.cpus.push_back(cpu);
+			}
+			return topology;
+		}
+#else
+		bool ApplyThreadConfig(const ThreadConfig& config)
+		{
+			return config.cpus.empty() && config.numaNode < 0 && ThreadConfig::Policy::Default == config.policy && config.name.empty();
+		}
+
+		std::string CurrentThreadName()
+		{
+			return std::string();
+		}
+
+		int CurrentCpu()
+		{
+			return -1;
+		}
+
+		CpuTopology CpuTopology::Query()
+		{
+			CpuTopology topology;
+			for(unsigned int id = 0U; id < std::max(1U, std::thread::hardware_concurrency()); id++)
+			{
+				Cpu cpu;
+				cpu.id = static_cast<int>(id);
+				cpu.core = static_cast<int>(id);
+				cpu.package = 0;
+				cpu.numaNode = 0;
+				cpu.siblings.push_back(static_cast<int>(id));
+				topology.cpus.push_back(cpu);
+			}
+			return topology;
+		}
+#endif
+
+		int CpuTopology::PhysicalCoreCount() const
+		{
+			return static_cast<int>(OnePerCore().size());
+		}
+
+		int CpuTopology::NumaNodeCount() const
+		{
+			std::vector<int> nodes;
+			for(const Cpu& cpu : cpus)
+			{
+				if(std::find(nodes.begin(), nodes.end(), cpu.numaNode) == nodes.end())
+				{
+					nodes.push_back(cpu.numaNode);
+				}
+			}
+			return static_cast<int>(nodes.size());
+		}
+
+		std::vector<int> CpuTopology::CpusOfNode(const int numaNode) const
+		{
+			std::vector<int> result;
+			for(const Cpu& cpu : cpus)
+			{
+				if(cpu.numaNode == numaNode)
+				{
+					result.push_back(cpu.id);
+				}
+			}
+			return result;
+		}
+
+		std::vector<int> CpuTopology::OnePerCore(const int numaNode) const
+		{
+			std::vector<int> result;
+			for(const Cpu& cpu : cpus)
+			{
+				// A CPU represents its core when it is the lowest online sibling.
+				bool first = true;
+				for(const int sibling : cpu.siblings)
+				{
+					if(sibling < cpu.id && std::any_of(cpus.begin(), cpus.end(), [sibling](const Cpu& other) { return other.id == sibling; }))
+					{
+						first = false;
+						break;
+					}
+				}
+				if(first && (numaNode < 0 || cpu.numaNode == numaNode))
+				{
+					result.push_back(cpu.id);
+				}
+			}
+			return result;
+		}
+
+		// Spinning only pays off when the thread being waited for can run on another CPU at the same time.
+		static bool SpinAllowed()
+		{
+			static const bool spinAllowed = std::thread::hardware_concurrency() > 1U;
+			return spinAllowed;
+		}
+
+		// Spins with backoff until ready() holds or the spin budget is used up; returns ready()'s last result.
+		template<typename P>
+		static bool SpinUntil(P ready)
+		{
+			if(SpinAllowed())
+			{
+				Backoff backoff;
+				while(backoff.Spinning())
+				{
+					if(ready())
+					{
+						return true;
+					}
+					backoff.Pause();
+				}
+			}
+			return ready();
+		}
+
+		// Parks while word holds expected; deadlineNanos < 0 waits without a timeout. Returns false once the
+		// deadline has passed.
+		static bool ParkUntil(std::atomic<unsigned int>& word, const unsigned int expected, const long long deadlineNanos)
+		{
+			if(deadlineNanos < 0LL)
+			{
+				FutexWait(word, expected);
+				return true;
+			}
+			const long long remainingNanos = deadlineNanos - Time::Nanos();
+			if(remainingNanos <= 0LL)
+			{
+				return false;
+			}
+			FutexWait(word, expected, (remainingNanos + 999LL) / 1000LL);
+			return true;
+		}
+
+		static long long DeadlineFromTimeout(const long long timeoutMicros)
+		{
+			return (timeoutMicros < 0LL) ? -1LL : Time::Nanos() + (timeoutMicros * 1000LL);
+		}
+
+		void AdaptiveMutex::LockSlow()
+		{
+			if(SpinAllowed())
+			{
+				Backoff backoff;
+				while(backoff.Spinning())
+				{
+					unsigned int state = m_state.load(std::memory_order_relaxed);
+					if(0U == state && m_state.compare_exchange_weak(state, 1U, std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						return;
+					}
+					// Others are already parked, so the holder is not about to hand over quickly.
+					if(2U == state)
+					{
+						break;
+					}
+					backoff.Pause();
+				}
+			}
+
+			// Taking the lock as 2 is conservative: the next unlock makes one wake even if no one else is parked.
+			while(0U != m_state.exchange(2U, std::memory_order_acquire))
+			{
+				FutexWait(m_state, 2U);
+			}
+		}
+
+		void TicketLock::WaitForTurn(const unsigned int ticket)
+		{
+			// Pausing in proportion to the queue position keeps waiters off the cache line until they are close. A
+			// ticket holder that is not running blocks everyone behind it, so waiters yield once spinning stops paying.
+			unsigned int spins = 0U;
+			while(true)
+			{
+				const unsigned int serving = m_serving.load(std::memory_order_acquire);
+				if(serving == ticket)
+				{
+					return;
+				}
+				if(SpinAllowed() && ++spins < 256U)
+				{
+					for(unsigned int i = (ticket - serving) * 8U; i > 0U; i--)
+					{
+						CpuRelax();
+					}
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		}
+
+		void RWSpinLock::lock()
+		{
+			Backoff backoff;
+			while(true)
+			{
+				unsigned int state = m_state.load(std::memory_order_relaxed);
+				if(0U == (state & ~WriterPending))
+				{
+					if(m_state.compare_exchange_weak(state, Writer, std::memory_order_acquire, std::memory_order_relaxed))
+					{
+						return;
+					}
+				}
+				else if(0U == (state & WriterPending))
+				{
+					m_state.fetch_or(WriterPending, std::memory_order_relaxed);
+				}
+				backoff.Pause();
+			}
+		}
+
+		void RWSpinLock::lock_shared()
+		{
+			Backoff backoff;
+			while(!try_lock_shared())
+			{
+				backoff.Pause();
+			}
+		}
+
+		Event::Event(const Mode mode, const bool signaled) :
+			m_mode(mode),
+			m_signaled(signaled ? 1U : 0U),
+			m_waiters(0U)
+		{
+		}
+
+		void Event::Set()
+		{
+			// Sequentially consistent with the waiter's increment: either the setter sees the waiter or the waiter's
+			// futex sees the signal.
+			if(1U != m_signaled.exchange(1U) && 0U != m_waiters.load())
+			{
+				if(Mode::AutoReset == m_mode)
+				{
+					FutexWake(m_signaled, 1);
+				}
+				else
+				{
+					FutexWakeAll(m_signaled);
+				}
+			}
+		}
+
+		void Event::Reset()
+		{
+			m_signaled.store(0U);
+		}
+
+		bool Event::IsSet() const
+		{
+			return 1U == m_signaled.load(std::memory_order_acquire);
+		}
+
+		void Event::Wait()
+		{
+			WaitMicros(-1LL);
+		}
+
+		bool Event::WaitMicros(const long long timeoutMicros)
+		{
+			if(SpinUntil([this]() -> bool { return TryConsume(); }))
+			{
+				return true;
+			}
+
+			const long long deadline = DeadlineFromTimeout(timeoutMicros);
+			bool consumed = false;
+			m_waiters.fetch_add(1U);
+			while(!(consumed = TryConsume()) && ParkUntil(m_signaled, 0U, deadline))
+			{
+			}
+			m_waiters.fetch_sub(1U);
+			return consumed || TryConsume();
+		}
+
+		bool Event::TryConsume()
+		{
+			if(Mode::ManualReset == m_mode)
+			{
+				return 1U == m_signaled.load(std::memory_order_acquire);
+			}
+			unsigned int expected = 1U;
+			return m_signaled.compare_exchange_strong(expected, 0U, std::memory_order_acquire, std::memory_order_relaxed);
+		}
+
+		Latch::Latch(const unsigned int count) :
+			m_count(count)
+		{
+		}
+
+		void Latch::CountDown(const unsigned int count)
+		{
+			if(count > 0U && count == m_count.fetch_sub(count, std::memory_order_acq_rel))
+			{
+				FutexWakeAll(m_count);
+			}
+		}
+
+		bool Latch::TryWait() const
+		{
+			return 0U == m_count.load(std::memory_order_acquire);
+		}
+
+		void Latch::Wait()
+		{
+			WaitMicros(-1LL);
+		}
+
+		bool Latch::WaitMicros(const long long timeoutMicros)
+		{
+			if(SpinUntil([this]() -> bool { return TryWait(); }))
+			{
+				return true;
+			}
+
+			const long long deadline = DeadlineFromTimeout(timeoutMicros);
+			for(unsigned int count = m_count.load(std::memory_order_acquire); 0U != count; count = m_count.load(std::memory_order_acquire))
+			{
+				if(!ParkUntil(m_count, count, deadline))
+				{
+					return TryWait();
+				}
+			}
+			return true;
+		}
+
+		void Latch::ArriveAndWait()
+		{
+			CountDown(1U);
+			Wait();
+		}
+
+		Barrier::Barrier(const unsigned int participants) :
+			m_participants(std::max(1U, participants)),
+			m_arrived(0U),
+			m_generation(0U)
+		{
+		}
+
+		bool Barrier::ArriveAndWait()
+		{
+			const unsigned int generation = m_generation.load(std::memory_order_acquire);
+
+			if(m_arrived.fetch_add(1U, std::memory_order_acq_rel) + 1U == m_participants)
+			{
+				// Nobody can arrive for the next phase before the generation moves on, so the reset is not racy.
+				m_arrived.store(0U, std::memory_order_relaxed);
+				m_generation.fetch_add(1U, std::memory_order_release);
+				FutexWakeAll(m_generation);
+				return true;
+			}
+
+			if(!SpinUntil([this, generation]() -> bool { return m_generation.load(std::memory_order_acquire) != generation; }))
+			{
+				while(m_generation.load(std::memory_order_acquire) == generation)
+				{
+					FutexWait(m_generation, generation);
+				}
+			}
+			return false;
+		}
+
+		unsigned int Barrier::Participants() const
+		{
+			return m_participants;
+		}
+
+		Semaphore::Semaphore(const unsigned int initialCount) :
+			m_count(initialCount),
+			m_waiters(0U)
+		{
+		}
+
+		void Semaphore::Release(const unsigned int count)
+		{
+			m_count.fetch_add(count);
+			if(0U != m_waiters.load())
+			{
+				FutexWake(m_count, static_cast<int>(std::min(count, static_cast<unsigned int>(std::numeric_limits<int>::max()))));
+			}
+		}
+
+		void Semaphore::Acquire()
+		{
+			TryAcquireMicros(-1LL);
+		}
+
+		bool Semaphore::TryAcquire()
+		{
+			unsigned int count = m_count.load(std::memory_order_relaxed);
+			while(0U != count)
+			{
+				if(m_count.compare_exchange_weak(count, count - 1U, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		bool Semaphore::TryAcquireMicros(const long long timeoutMicros)
+		{
+			if(SpinUntil([this]() -> bool { return TryAcquire(); }))
+			{
+				return true;
+			}
+
+			const long long deadline = DeadlineFromTimeout(timeoutMicros);
+			bool acquired = false;
+			m_waiters.fetch_add(1U);
+			while(!(acquired = TryAcquire()) && ParkUntil(m_count, 0U, deadline))
+			{
+			}
+			m_waiters.fetch_sub(1U);
+			return acquired || TryAcquire();
+		}
+
+		unsigned int Semaphore::Available() const
+		{
+			return m_count.load(std::memory_order_relaxed);
+		}
+
+		Timer::Timer() :
+			m_stopRequested(false),
+			m_started(false),
+			m_running(false),
+			m_intervalNanos(0LL),
+			m_schedule(Schedule::FixedDelay),
+			m_missedTicks(MissedTicks::Skip),
+			m_userArg(NULL),
+			m_userFunc(),
+			m_threadConfig(),
+			m_startedEvent(Event::Mode::ManualReset),
+			m_timerThread(),
+			m_timerMutex(),
+			m_timerStopCond(),
+			m_tickCount(0ULL),
+			m_overrunCount(0ULL),
+			m_missedCount(0ULL),
+			m_maxJitterNanos(0LL),
+			m_jitterSumNanos(0LL),
+			m_maxCallbackNanos(0LL)
+		{
+		}
+
+		Timer::~Timer()
+		{
+			End();
+		}
+
+		void Timer::Begin(const unsigned int intervalMillisecs, TimerUserFunc userFunc, void* userArg)
+		{
+			BeginMicros(static_cast<long long>(intervalMillisecs) * 1000LL, userFunc, userArg, Schedule::FixedDelay);
+		}
+
+		void Timer::BeginMicros(const long long intervalMicros, TimerUserFunc userFunc, void* userArg,
+			const Schedule schedule, const MissedTicks missedTicks)
+		{
+			if(!Running() && intervalMicros > 0LL && userFunc)
+			{
+				// A timer whose callback ended it still owns a joinable thread.
+				if(m_timerThread && m_timerThread->joinable())
+				{
+					m_timerThread->join();
+				}
+
+				m_intervalNanos = intervalMicros * 1000LL;
+				m_schedule = schedule;
+				m_missedTicks = missedTicks;
+				m_userArg = userArg;
+				m_userFunc = userFunc;
+				m_tickCount.store(0ULL);
+				m_overrunCount.store(0ULL);
+				m_missedCount.store(0ULL);
+				m_maxJitterNanos.store(0LL);
+				m_jitterSumNanos.store(0LL);
+				m_maxCallbackNanos.store(0LL);
+				m_stopRequested.store(false);
+				m_startedEvent.Reset();
+				m_started.store(true);
+				m_timerThread.reset(new std::thread(Timer::InternalTimerFunc, this));
+			}
+		}
+
+		void Timer::End()
+		{
+			m_stopRequested.store(true);
+			if (m_timerThread)
+			{
+				m_timerStopCond.notify_one();
+				if(m_timerThread->joinable())
+				{
+					m_timerThread->join();
+				}
+			}
+			else
+			{
+				m_running.store(false);
+			}
+			m_started.store(false);
+		}
+
+		bool Timer::Running()
+		{
+			// A just-started timer counts as running once its thread is up.
+			if(m_timerThread && m_started.load() && !m_running.load())
+			{
+				m_startedEvent.Wait();
+			}
+			return m_running.load();
+		}
+
+		Timer::Stats Timer::GetStats() const
+		{
+			Stats stats;
+			stats.ticks = m_tickCount.load(std::memory_order_relaxed);
+			stats.overruns = m_overrunCount.load(std::memory_order_relaxed);
+			stats.missed = m_missedCount.load(std::memory_order_relaxed);
+			stats.maxJitterNanos = m_maxJitterNanos.load(std::memory_order_relaxed);
+			stats.meanJitterNanos = (0ULL == stats.ticks) ? 0.0 :
+				static_cast<double>(m_jitterSumNanos.load(std::memory_order_relaxed)) / static_cast<double>(stats.ticks);
+			stats.maxCallbackNanos = m_maxCallbackNanos.load(std::memory_order_relaxed);
+			return stats;
+		}
+
+		void Timer::SetThreadConfig(const ThreadConfig& config)
+		{
+			m_threadConfig = config;
+		}
+
+		bool Timer::WasStopRequested() const
+		{
+			return m_stopRequested.load();
+		}
+
+		bool Timer::WaitForDeadline(std::unique_lock<std::mutex>& lock, const long long deadlineNanos, const bool spinTail)
+		{
+			// Block on the condition variable against an absolute steady_clock deadline until the spin window,
+			// then spin the rest on Time::Nanos() so that the tick lands within a few microseconds. Without
+			// spinTail the whole wait is spent asleep.
+			const long long sleepNanos = deadlineNanos - (spinTail ? Time::GetWaitSpinNanos() : 0LL) - Time::Nanos();
+
+			if(sleepNanos > 0LL)
+			{
+				const std::chrono::steady_clock::time_point wakeAt = std::chrono::steady_clock::now() + std::chrono::nanoseconds(sleepNanos);
+				if(m_timerStopCond.wait_until(lock, wakeAt, [this]() -> bool { return WasStopRequested(); }))
+				{
+					return false;
+				}
+			}
+
+			while(Time::Nanos() < deadlineNanos)
+			{
+				if(WasStopRequested())
+				{
+					return false;
+				}
+				CpuRelax();
+			}
+
+			return !WasStopRequested();
+		}
+
+		void Timer::InternalTimerFunc(Timer* timer)
+		{
+			ApplyThreadConfig(timer->m_threadConfig);
+			std::unique_lock<std::mutex> lck(timer->m_timerMutex);
+
+			timer->m_running.store(true);
+			timer->m_startedEvent.Set();
+
+			// Calibrate the spin window before the first deadline is taken so that it does not delay the first tick.
+			const bool spinTail = (Schedule::FixedRate == timer->m_schedule);
+			if(spinTail)
+			{
+				Time::GetWaitSpinNanos();
+			}
+			long long deadline = Time::Nanos();
+
+			while (!timer->WasStopRequested())
+			{
+				const long long startedAt = Time::Nanos();
+				const long long jitter = std::max(0LL, startedAt - deadline);
+
+				if (!timer->m_userFunc(timer, timer->m_userArg))
+				{
+					break;
+				}
+
+				const long long finishedAt = Time::Nanos();
+				const long long callbackNanos = finishedAt - startedAt;
+
+				timer->m_tickCount.fetch_add(1ULL, std::memory_order_relaxed);
+				timer->m_jitterSumNanos.fetch_add(jitter, std::memory_order_relaxed);
+				if(jitter > timer->m_maxJitterNanos.load(std::memory_order_relaxed))
+				{
+					timer->m_maxJitterNanos.store(jitter, std::memory_order_relaxed);
+				}
+				if(callbackNanos > timer->m_maxCallbackNanos.load(std::memory_order_relaxed))
+				{
+					timer->m_maxCallbackNanos.store(callbackNanos, std::memory_order_relaxed);
+				}
+				if(callbackNanos > timer->m_intervalNanos)
+				{
+					timer->m_overrunCount.fetch_add(1ULL, std::memory_order_relaxed);
+				}
+
+				if(Schedule::FixedDelay == timer->m_schedule)
+				{
+					deadline = finishedAt + timer->m_intervalNanos;
+				}
+				else
+				{
+					deadline += timer->m_intervalNanos;
+					if(finishedAt > deadline && MissedTicks::Skip == timer->m_missedTicks)
+					{
+						const long long missed = ((finishedAt - deadline) / timer->m_intervalNanos) + 1LL;
+						timer->m_missedCount.fetch_add(static_cast<unsigned long long>(missed), std::memory_order_relaxed);
+						deadline += missed * timer->m_intervalNanos;
+					}
+				}
+
+				if (!timer->WaitForDeadline(lck, deadline, spinTail))
+				{
+					break;
+				}
+			}
+
+			timer->m_running.store(false);
+		}
+
+		static const unsigned int WheelLevels = 4U;
+		static const unsigned int WheelSlotBits = 8U;
+		static const unsigned int WheelSlots = 1U << WheelSlotBits;
+		static const unsigned int TimerNodeChunkBits = 10U;
+		static const unsigned int TimerNodeIndexBits = 24U;
+		static const unsigned int TimerShardBits = 8U;
+		static const unsigned int TimerNoNode = 0xFFFFFFFFU;
+
+		struct TimerNode
+		{
+			enum class State
+			{
+				Free,
+				Pending,
+				Firing,
+				FiringCancelled
+			};
+
+			Timer::TimerUserFunc userFunc;
+			void* userArg;
+			unsigned long long expiryTick;
+			unsigned long long intervalTicks;
+			unsigned int prev;
+			unsigned int next;
+			unsigned int slot;
+			unsigned int generation;
+			State state;
+			bool rescheduled;
+
+			TimerNode() :
+				userFunc(),
+				userArg(NULL),
+				expiryTick(0ULL),
+				intervalTicks(0ULL),
+				prev(TimerNoNode),
+				next(TimerNoNode),
+				slot(TimerNoNode),
+				generation(1U),
+				state(State::Free),
+				rescheduled(false)
+			{
+			}
+		};
+
+		// One wheel and its thread. Nodes live in fixed-size chunks so that the shard thread can keep pointers
+		// to firing nodes while other threads grow the slab.
+		struct TimerService::Shard
+		{
+			unsigned int id;
+			std::mutex mutex;
+			std::condition_variable wakeCond;
+			bool stopRequested;
+			unsigned long long currentTick;
+			size_t pending;
+			std::vector<std::unique_ptr<TimerNode[]>> chunks;
+			std::vector<unsigned int> freeNodes;
+			unsigned int heads[WheelLevels * WheelSlots];
+			std::thread thread;
+
+			explicit Shard(const unsigned int shardId) :
+				id(shardId),
+				mutex(),
+				wakeCond(),
+				stopRequested(false),
+				currentTick(0ULL),
+				pending(0U),
+				chunks(),
+				freeNodes(),
+				thread()
+			{
+				std::fill(heads, heads + (WheelLevels * WheelSlots), TimerNoNode);
+			}
+
+			TimerNode& Node(const unsigned int index)
+			{
+				return chunks[index >> TimerNodeChunkBits][index & ((1U << TimerNodeChunkBits) - 1U)];
+			}
+
+			unsigned int Allocate()
+			{
+				if(freeNodes.empty())
+				{
+					const size_t chunkSize = static_cast<size_t>(1U) << TimerNodeChunkBits;
+					const size_t first = chunks.size() * chunkSize;
+					if(first + chunkSize > (static_cast<size_t>(1U) << TimerNodeIndexBits))
+					{
+						throw std::length_error("TimerService shard is out of timer slots");
+					}
+					chunks.push_back(std::unique_ptr<TimerNode[]>(new TimerNode[chunkSize]));
+					for(size_t index = first + chunkSize; index > first; index--)
+					{
+						freeNodes.push_back(static_cast<unsigned int>(index - 1U));
+					}
+				}
+
+				const unsigned int index = freeNodes.back();
+				freeNodes.pop_back();
+				pending++;
+				return index;
+			}
+
+			void Release(const unsigned int index)
+			{
+				TimerNode& node = Node(index);
+				node.userFunc = nullptr;
+				node.state = TimerNode::State::Free;
+				node.generation = (0U == node.generation + 1U) ? 1U : node.generation + 1U;
+				freeNodes.push_back(index);
+				pending--;
+			}
+
+			// A cascaded timer may be due on the current tick; it goes into the current slot, which Advance detaches
+			// right after cascading. Any other timer that is already due fires on the next tick.
+			void Link(const unsigned int index, const bool cascading = false)
+			{
+				TimerNode& node = Node(index);
+				const unsigned long long maxDelta = (1ULL << (WheelSlotBits * WheelLevels)) - 1ULL;
+
+				if(node.expiryTick <= currentTick)
+				{
+					node.expiryTick = cascading ? currentTick : currentTick + 1ULL;
+				}
+				else if(node.expiryTick - currentTick > maxDelta)
+				{
+					node.expiryTick = currentTick + maxDelta;
+				}
+
+				// The level is the coarsest whose slot width still fits the remaining delay.
+				const unsigned long long delta = node.expiryTick - currentTick;
+				unsigned int level = 0U;
+				while(level + 1U < WheelLevels && delta >= (1ULL << (WheelSlotBits * (level + 1U))))
+				{
+					level++;
+				}
+
+				const unsigned int slot = (level * WheelSlots) + static_cast<unsigned int>((node.expiryTick >> (WheelSlotBits * level)) & (WheelSlots - 1U));
+				node.slot = slot;
+				node.prev = TimerNoNode;
+				node.next = heads[slot];
+				if(TimerNoNode != node.next)
+				{
+					Node(node.next).prev = index;
+				}
+				heads[slot] = index;
+			}
+
+			void Unlink(const unsigned int index)
+			{
+				TimerNode& node = Node(index);
+
+				if(TimerNoNode != node.prev)
+				{
+					Node(node.prev).next = node.next;
+				}
+				else
+				{
+					heads[node.slot] = node.next;
+				}
+				if(TimerNoNode != node.next)
+				{
+					Node(node.next).prev = node.prev;
+				}
+				node.slot = TimerNoNode;
+			}
+
+			unsigned int Detach(const unsigned int slot)
+			{
+				const unsigned int head = heads[slot];
+				heads[slot] = TimerNoNode;
+				return head;
+			}
+
+			// Steps the wheel one tick: when a level's index wraps, the next level's current slot is re-inserted,
+			// landing its timers in finer slots. Returns the list of timers expiring on the new tick.
+			unsigned int Advance()
+			{
+				currentTick++;
+
+				for(unsigned int level = 1U; level < WheelLevels; level++)
+				{
+					if(0ULL != ((currentTick >> (WheelSlotBits * (level - 1U))) & (WheelSlots - 1U)))
+					{
+						break;
+					}
+
+					unsigned int index = Detach((level * WheelSlots) + static_cast<unsigned int>((currentTick >> (WheelSlotBits * level)) & (WheelSlots - 1U)));
+					while(TimerNoNode != index)
+					{
+						const unsigned int next = Node(index).next;
+						Link(index, true);
+						index = next;
+					}
+				}
+
+				return Detach(static_cast<unsigned int>(currentTick & (WheelSlots - 1U)));
+			}
+		};
+
+		const TimerService::Handle TimerService::InvalidHandle;
+
+		TimerService::TimerService(const unsigned int threadCount, const long long resolutionMicros) :
+			m_resolutionNanos(std::max(1LL, resolutionMicros) * 1000LL),
+			m_baseNanos(Time::Nanos()),
+			m_nextShard(0U),
+			m_shards()
+		{
+			const unsigned int shardCount = std::min(1U << TimerShardBits, std::max(1U, threadCount));
+
+			for(unsigned int id = 0U; id < shardCount; id++)
+			{
+				m_shards.push_back(std::unique_ptr<Shard>(new Shard(id)));
+			}
+			for(std::unique_ptr<Shard>& shard : m_shards)
+			{
+				shard->thread = std::thread(TimerService::InternalServiceFunc, this, shard.get());
+			}
+		}
+
+		TimerService::~TimerService()
+		{
+			for(std::unique_ptr<Shard>& shard : m_shards)
+			{
+				{
+					std::lock_guard<std::mutex> lock(shard->mutex);
+					shard->stopRequested = true;
+				}
+				shard->wakeCond.notify_one();
+			}
+			for(std::unique_ptr<Shard>& shard : m_shards)
+			{
+				if(shard->thread.joinable())
+				{
+					shard->thread.join();
+				}
+			}
+		}
+
+		TimerService::Handle TimerService::Schedule(const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			return (intervalMicros > 0LL) ? Add(intervalMicros, intervalMicros, userFunc, userArg) : InvalidHandle;
+		}
+
+		TimerService::Handle TimerService::ScheduleOnce(const long long delayMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			return Add(delayMicros, 0LL, userFunc, userArg);
+		}
+
+		TimerService::Handle TimerService::Add(const long long delayMicros, const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			if(!userFunc)
+			{
+				return InvalidHandle;
+			}
+
+			Shard& shard = *m_shards[m_nextShard.fetch_add(1U, std::memory_order_relaxed) % m_shards.size()];
+			// Expiry is taken from the clock rather than the shard's tick so that a lagging shard does not stretch it.
+			const unsigned long long expiryTick = static_cast<unsigned long long>(
+				(Time::Nanos() - m_baseNanos + (std::max(0LL, delayMicros) * 1000LL) + m_resolutionNanos - 1LL) / m_resolutionNanos);
+			Handle handle;
+			bool wasIdle;
+			{
+				std::lock_guard<std::mutex> lock(shard.mutex);
+				wasIdle = (0U == shard.pending);
+				const unsigned int index = shard.Allocate();
+				TimerNode& node = shard.Node(index);
+				node.userFunc = userFunc;
+				node.userArg = userArg;
+				node.expiryTick = expiryTick;
+				node.intervalTicks = static_cast<unsigned long long>(((intervalMicros * 1000LL) + m_resolutionNanos - 1LL) / m_resolutionNanos);
+				node.state = TimerNode::State::Pending;
+				node.rescheduled = false;
+				shard.Link(index);
+				handle = (static_cast<Handle>(node.generation) << 32) | (static_cast<Handle>(shard.id) << TimerNodeIndexBits) | index;
+			}
+
+			if(wasIdle)
+			{
+				shard.wakeCond.notify_one();
+			}
+
+			return handle;
+		}
+
+		bool TimerService::Cancel(const Handle handle)
+		{
+			const unsigned int shardId = static_cast<unsigned int>(handle >> TimerNodeIndexBits) & ((1U << TimerShardBits) - 1U);
+			const unsigned int index = static_cast<unsigned int>(handle) & ((1U << TimerNodeIndexBits) - 1U);
+
+			if(InvalidHandle == handle || shardId >= m_shards.size())
+			{
+				return false;
+			}
+
+			Shard& shard = *m_shards[shardId];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			if((index >> TimerNodeChunkBits) >= shard.chunks.size() || shard.Node(index).generation != static_cast<unsigned int>(handle >> 32))
+			{
+				return false;
+			}
+
+			TimerNode& node = shard.Node(index);
+			switch(node.state)
+			{
+				case TimerNode::State::Pending:
+					shard.Unlink(index);
+					shard.Release(index);
+					return true;
+				case TimerNode::State::Firing:
+					// The shard thread releases it once the running callback returns.
+					node.state = TimerNode::State::FiringCancelled;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		bool TimerService::Reschedule(const Handle handle, const long long delayMicros)
+		{
+			const unsigned int shardId = static_cast<unsigned int>(handle >> TimerNodeIndexBits) & ((1U << TimerShardBits) - 1U);
+			const unsigned int index = static_cast<unsigned int>(handle) & ((1U << TimerNodeIndexBits) - 1U);
+
+			if(InvalidHandle == handle || shardId >= m_shards.size())
+			{
+				return false;
+			}
+
+			Shard& shard = *m_shards[shardId];
+			const unsigned long long expiryTick = static_cast<unsigned long long>(
+				(Time::Nanos() - m_baseNanos + (std::max(0LL, delayMicros) * 1000LL) + m_resolutionNanos - 1LL) / m_resolutionNanos);
+			std::lock_guard<std::mutex> lock(shard.mutex);
+
+			if((index >> TimerNodeChunkBits) >= shard.chunks.size() || shard.Node(index).generation != static_cast<unsigned int>(handle >> 32))
+			{
+				return false;
+			}
+
+			TimerNode& node = shard.Node(index);
+			switch(node.state)
+			{
+				case TimerNode::State::Pending:
+					shard.Unlink(index);
+					node.expiryTick = expiryTick;
+					shard.Link(index);
+					return true;
+				case TimerNode::State::Firing:
+					node.expiryTick = expiryTick;
+					node.rescheduled = true;
+					return true;
+				default:
+					return false;
+			}
+		}
+
+		size_t TimerService::Pending() const
+		{
+			size_t pending = 0U;
+
+			for(const std::unique_ptr<Shard>& shard : m_shards)
+			{
+				std::lock_guard<std::mutex> lock(shard->mutex);
+				pending += shard->pending;
+			}
+
+			return pending;
+		}
+
+		long long TimerService::ResolutionMicros() const
+		{
+			return m_resolutionNanos / 1000LL;
+		}
+
+		void TimerService::InternalServiceFunc(TimerService* service, Shard* shard)
+		{
+			std::vector<TimerNode*> firing;
+			std::vector<unsigned int> firingIndices;
+			std::vector<char> repeat;
+			std::unique_lock<std::mutex> lock(shard->mutex);
+
+			while(!shard->stopRequested)
+			{
+				const unsigned long long nowTick = static_cast<unsigned long long>((Time::Nanos() - service->m_baseNanos) / service->m_resolutionNanos);
+
+				// An empty wheel has nothing to cascade, so jump straight to the present instead of stepping.
+				if(0U == shard->pending && shard->currentTick < nowTick)
+				{
+					shard->currentTick = nowTick;
+				}
+
+				while(shard->currentTick < nowTick && !shard->stopRequested)
+				{
+					firing.clear();
+					firingIndices.clear();
+					for(unsigned int index = shard->Advance(); TimerNoNode != index; index = shard->Node(index).next)
+					{
+						TimerNode& node = shard->Node(index);
+						node.state = TimerNode::State::Firing;
+						node.rescheduled = false;
+						node.slot = TimerNoNode;
+						firing.push_back(&node);
+						firingIndices.push_back(index);
+					}
+
+					if(firing.empty())
+					{
+						continue;
+					}
+
+					// A callback may cancel a batch-mate that has not run yet. That Cancel has returned true, so the
+					// state is checked under the lock before each call and a cancelled node is skipped.
+					repeat.assign(firing.size(), 0);
+					for(size_t i = 0; i < firing.size(); i++)
+					{
+						if(TimerNode::State::FiringCancelled == firing[i]->state)
+						{
+							continue;
+						}
+						lock.unlock();
+						repeat[i] = firing[i]->userFunc(nullptr, firing[i]->userArg) ? 1 : 0;
+						lock.lock();
+					}
+
+					for(size_t i = 0; i < firing.size(); i++)
+					{
+						TimerNode& node = *firing[i];
+						if(TimerNode::State::FiringCancelled != node.state && (node.rescheduled || (0ULL != node.intervalTicks && repeat[i])))
+						{
+							if(!node.rescheduled)
+							{
+								node.expiryTick = shard->currentTick + node.intervalTicks;
+							}
+							node.state = TimerNode::State::Pending;
+							shard->Link(firingIndices[i]);
+						}
+						else
+						{
+							shard->Release(firingIndices[i]);
+						}
+					}
+				}
+
+				if(shard->stopRequested)
+				{
+					break;
+				}
+
+				if(0U == shard->pending)
+				{
+					shard->wakeCond.wait(lock);
+				}
+				else
+				{
+					const long long untilNextTick = service->m_baseNanos + (static_cast<long long>(shard->currentTick + 1ULL) * service->m_resolutionNanos) - Time::Nanos();
+					shard->wakeCond.wait_until(lock, std::chrono::steady_clock::now() + std::chrono::nanoseconds(std::max(0LL, untilNextTick)));
+				}
+			}
+		}
+
+		struct EventLoop::State
+		{
+			struct FdEntry
+			{
+				IoCallback callback;
+				unsigned int events;
+				unsigned int generation;
+			};
+
+			struct TimerEntry
+			{
+				Timer::TimerUserFunc userFunc;
+				void* userArg;
+				long long deadlineNanos;
+				long long intervalNanos;
+			};
+
+			int epollFd;
+			int timerFd;
+			int wakeFd;
+			// Indexed by descriptor; the generation in each epoll event drops events of a since-replaced entry.
+			std::vector<std::shared_ptr<FdEntry>> fds;
+			unsigned int nextGeneration;
+			std::map<Handle, TimerEntry> timers;
+			std::set<std::pair<long long, Handle>> deadlines;
+			long long armedNanos;
+			Handle firingHandle;
+			bool firingCancelled;
+			std::atomic<unsigned long long> nextHandle;
+			std::mutex postMutex;
+			std::vector<std::function<void()>> posted;
+			std::atomic<bool> wakePending;
+			std::atomic<bool> stopRequested;
+			std::atomic<std::thread::id> loopThread;
+
+			State() :
+				epollFd(-1),
+				timerFd(-1),
+				wakeFd(-1),
+				fds(),
+				nextGeneration(1U),
+				timers(),
+				deadlines(),
+				armedNanos(-1LL),
+				firingHandle(InvalidHandle),
+				firingCancelled(false),
+				nextHandle(1ULL),
+				postMutex(),
+				posted(),
+				wakePending(false),
+				stopRequested(false),
+				loopThread(std::thread::id())
+			{
+			}
+		};
+
+#if defined(__linux__)
+		// The timerfd runs on CLOCK_MONOTONIC, so deadlines are kept on the same clock.
+		static long long MonotonicNanos()
+		{
+			struct timespec now;
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			return static_cast<long long>(now.tv_sec) * 1000000000LL + now.tv_nsec;
+		}
+
+		static unsigned int ToEpollEvents(const unsigned int events)
+		{
+			return ((events & EventLoop::Readable) ? static_cast<unsigned int>(EPOLLIN | EPOLLRDHUP) : 0U) |
+				((events & EventLoop::Writable) ? static_cast<unsigned int>(EPOLLOUT) : 0U);
+		}
+
+		EventLoop::EventLoop() :
+			m_state(new State())
+		{
+			m_state->epollFd = epoll_create1(EPOLL_CLOEXEC);
+			m_state->timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+			m_state->wakeFd = eventfd(0U, EFD_NONBLOCK | EFD_CLOEXEC);
+
+			bool ready = m_state->epollFd >= 0 && m_state->timerFd >= 0 && m_state->wakeFd >= 0;
+			for(const int fd : { m_state->timerFd, m_state->wakeFd })
+			{
+				// Internal descriptors carry generation 0, which no registered descriptor uses.
+				struct epoll_event event;
+				event.events = EPOLLIN;
+				event.data.u64 = static_cast<unsigned long long>(static_cast<unsigned int>(fd));
+				ready = ready && 0 == epoll_ctl(m_state->epollFd, EPOLL_CTL_ADD, fd, &event);
+			}
+			if(!ready)
+			{
+				const std::string reason = strerror(errno);
+				for(const int fd : { m_state->epollFd, m_state->timerFd, m_state->wakeFd })
+				{
+					if(fd >= 0)
+					{
+						close(fd);
+					}
+				}
+				throw std::runtime_error("EventLoop could not create its epoll descriptors: " + reason);
+			}
+		}
+
+		EventLoop::~EventLoop()
+		{
+			close(m_state->wakeFd);
+			close(m_state->timerFd);
+			close(m_state->epollFd);
+		}
+
+		bool EventLoop::Add(const int fd, const unsigned int events, IoCallback callback)
+		{
+			State& state = *m_state;
+			if(fd < 0 || !callback || (static_cast<size_t>(fd) < state.fds.size() && state.fds[static_cast<size_t>(fd)]))
+			{
+				return false;
+			}
+
+			std::shared_ptr<State::FdEntry> entry(new State::FdEntry());
+			entry->callback = std::move(callback);
+			entry->events = events;
+			entry->generation = state.nextGeneration++;
+			if(0U == state.nextGeneration)
+			{
+				state.nextGeneration = 1U;
+			}
+
+			struct epoll_event event;
+			event.events = ToEpollEvents(events);
+			event.data.u64 = (static_cast<unsigned long long>(entry->generation) << 32) | static_cast<unsigned int>(fd);
+			if(0 != epoll_ctl(state.epollFd, EPOLL_CTL_ADD, fd, &event))
+			{
+				return false;
+			}
+
+			if(static_cast<size_t>(fd) >= state.fds.size())
+			{
+				state.fds.resize(static_cast<size_t>(fd) + 1U);
+			}
+			state.fds[static_cast<size_t>(fd)] = entry;
+			return true;
+		}
+
+		bool EventLoop::Modify(const int fd, const unsigned int events)
+		{
+			State& state = *m_state;
+			if(fd < 0 || static_cast<size_t>(fd) >= state.fds.size() || !state.fds[static_cast<size_t>(fd)])
+			{
+				return false;
+			}
+
+			State::FdEntry& entry = *state.fds[static_cast<size_t>(fd)];
+			struct epoll_event event;
+			event.events = ToEpollEvents(events);
+			event.data.u64 = (static_cast<unsigned long long>(entry.generation) << 32) | static_cast<unsigned int>(fd);
+			if(0 != epoll_ctl(state.epollFd, EPOLL_CTL_MOD, fd, &event))
+			{
+				return false;
+			}
+			entry.events = events;
+			return true;
+		}
+
+		bool EventLoop::Remove(const int fd)
+		{
+			State& state = *m_state;
+			if(fd < 0 || static_cast<size_t>(fd) >= state.fds.size() || !state.fds[static_cast<size_t>(fd)])
+			{
+				return false;
+			}
+
+			// A descriptor closed before Remove has already left the epoll set.
+			epoll_ctl(state.epollFd, EPOLL_CTL_DEL, fd, NULL);
+			state.fds[static_cast<size_t>(fd)].reset();
+			return true;
+		}
+
+		size_t EventLoop::RunOnce(const long long timeoutMicros)
+		{
+			State& state = *m_state;
+			// Restores the previous owner on return, so IsLoopThread is false again once the loop stops running.
+			struct LoopThreadScope
+			{
+				std::atomic<std::thread::id>& owner;
+				const std::thread::id previous;
+
+				explicit LoopThreadScope(std::atomic<std::thread::id>& loopThread) :
+					owner(loopThread),
+					previous(loopThread.exchange(std::this_thread::get_id()))
+				{
+				}
+
+				~LoopThreadScope()
+				{
+					owner.store(previous);
+				}
+			} loopThreadScope(state.loopThread);
+
+			const int timeoutMillis = (timeoutMicros < 0LL) ? -1 :
+				static_cast<int>(std::min<long long>((timeoutMicros + 999LL) / 1000LL, std::numeric_limits<int>::max()));
+			struct epoll_event events[256];
+			const int count = epoll_wait(state.epollFd, events, 256, timeoutMillis);
+			size_t dispatched = 0U;
+
+			for(int index = 0; index < count; index++)
+			{
+				const int fd = static_cast<int>(events[index].data.u64 & 0xFFFFFFFFULL);
+				const unsigned int generation = static_cast<unsigned int>(events[index].data.u64 >> 32);
+				unsigned long long counter = 0ULL;
+
+				if(0U == generation)
+				{
+					// Drains the timerfd expiry count or the eventfd counter; the work itself is done below.
+					if(read(fd, &counter, sizeof(counter)) < 0 && EAGAIN != errno)
+					{
+						continue;
+					}
+					if(fd == state.wakeFd)
+					{
+						state.wakePending.store(false);
+					}
+					else
+					{
+						state.armedNanos = -1LL;
+					}
+					continue;
+				}
+
+				if(static_cast<size_t>(fd) >= state.fds.size() || !state.fds[static_cast<size_t>(fd)] ||
+					state.fds[static_cast<size_t>(fd)]->generation != generation)
+				{
+					continue;
+				}
+
+				// The local reference keeps the callback alive if it removes its own descriptor.
+				const std::shared_ptr<State::FdEntry> entry = state.fds[static_cast<size_t>(fd)];
+				const unsigned int flags = events[index].events;
+				const unsigned int ready = ((flags & (EPOLLIN | EPOLLRDHUP)) ? Readable : 0U) |
+					((flags & EPOLLOUT) ? Writable : 0U) | ((flags & (EPOLLERR | EPOLLHUP)) ? Error : 0U);
+				entry->callback(fd, ready);
+				dispatched++;
+			}
+
+			dispatched += RunTimers();
+			dispatched += RunPosted();
+			ArmTimerFd();
+			return dispatched;
+		}
+
+		void EventLoop::ArmTimerFd()
+		{
+			State& state = *m_state;
+			const long long earliest = state.deadlines.empty() ? -1LL : state.deadlines.begin()->first;
+			if(earliest == state.armedNanos)
+			{
+				return;
+			}
+
+			// A zero it_value disarms the timerfd.
+			struct itimerspec spec;
+			memset(&spec, 0, sizeof(spec));
+			if(earliest >= 0LL)
+			{
+				spec.it_value.tv_sec = static_cast<time_t>(earliest / 1000000000LL);
+				spec.it_value.tv_nsec = static_cast<long>(earliest % 1000000000LL);
+			}
+			timerfd_settime(state.timerFd, TFD_TIMER_ABSTIME, &spec, NULL);
+			state.armedNanos = earliest;
+		}
+
+		void EventLoop::Wake()
+		{
+			if(!m_state->wakePending.exchange(true))
+			{
+				const unsigned long long one = 1ULL;
+				if(write(m_state->wakeFd, &one, sizeof(one)) < 0)
+				{
+					// The counter can only be full if it was never drained; the loop is awake anyway.
+				}
+			}
+		}
+#else
+		EventLoop::EventLoop() :
+			m_state(new State())
+		{
+			throw std::runtime_error("EventLoop requires epoll, which is only available on Linux");
+		}
+
+		EventLoop::~EventLoop()
+		{
+		}
+
+		bool EventLoop::Add(const int, const unsigned int, IoCallback)
+		{
+			return false;
+		}
+
+		bool EventLoop::Modify(const int, const unsigned int)
+		{
+			return false;
+		}
+
+		bool EventLoop::Remove(const int)
+		{
+			return false;
+		}
+
+		size_t EventLoop::RunOnce(const long long)
+		{
+			return 0U;
+		}
+
+		void EventLoop::ArmTimerFd()
+		{
+		}
+
+		void EventLoop::Wake()
+		{
+		}
+
+		static long long MonotonicNanos()
+		{
+			return Time::Nanos();
+		}
+#endif
+
+		EventLoop::Handle EventLoop::Schedule(const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			return (intervalMicros > 0LL) ? AddTimer(intervalMicros, intervalMicros, userFunc, userArg) : InvalidHandle;
+		}
+
+		EventLoop::Handle EventLoop::ScheduleOnce(const long long delayMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			return AddTimer(std::max(0LL, delayMicros), 0LL, userFunc, userArg);
+		}
+
+		EventLoop::Handle EventLoop::AddTimer(const long long delayMicros, const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg)
+		{
+			if(!userFunc)
+			{
+				return InvalidHandle;
+			}
+
+			const Handle handle = m_state->nextHandle.fetch_add(1ULL, std::memory_order_relaxed);
+			State::TimerEntry entry;
+			entry.userFunc = userFunc;
+			entry.userArg = userArg;
+			entry.deadlineNanos = MonotonicNanos() + delayMicros * 1000LL;
+			entry.intervalNanos = intervalMicros * 1000LL;
+
+			if(IsLoopThread())
+			{
+				m_state->timers[handle] = entry;
+				m_state->deadlines.insert(std::make_pair(entry.deadlineNanos, handle));
+				ArmTimerFd();
+			}
+			else
+			{
+				State* state = m_state.get();
+				Post([this, state, handle, entry]() {
+					state->timers[handle] = entry;
+					state->deadlines.insert(std::make_pair(entry.deadlineNanos, handle));
+					ArmTimerFd();
+				});
+			}
+			return handle;
+		}
+
+		void EventLoop::Cancel(const Handle handle)
+		{
+			if(!IsLoopThread())
+			{
+				Post([this, handle]() { Cancel(handle); });
+				return;
+			}
+
+			State& state = *m_state;
+			if(handle == state.firingHandle)
+			{
+				state.firingCancelled = true;
+				return;
+			}
+			std::map<Handle, State::TimerEntry>::iterator timer = state.timers.find(handle);
+			if(timer != state.timers.end())
+			{
+				state.deadlines.erase(std::make_pair(timer->second.deadlineNanos, handle));
+				state.timers.erase(timer);
+			}
+			else if(handle != InvalidHandle && handle < state.nextHandle.load(std::memory_order_relaxed))
+			{
+				// A timer added from another thread may still be queued behind Post; cancelling behind it in the
+				// same queue removes it once it lands. The posted retry does not post again.
+				State* queued = &state;
+				Post([queued, handle]() {
+					std::map<Handle, State::TimerEntry>::iterator pending = queued->timers.find(handle);
+					if(handle == queued->firingHandle)
+					{
+						queued->firingCancelled = true;
+					}
+					else if(pending != queued->timers.end())
+					{
+						queued->deadlines.erase(std::make_pair(pending->second.deadlineNanos, handle));
+						queued->timers.erase(pending);
+					}
+				});
+			}
+		}
+
+		void EventLoop::Post(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_state->postMutex);
+				m_state->posted.push_back(std::move(task));
+			}
+			Wake();
+		}
+
+		void EventLoop::Run()
+		{
+			while(!m_state->stopRequested.load())
+			{
+				RunOnce(-1LL);
+			}
+			m_state->stopRequested.store(false);
+		}
+
+		void EventLoop::Stop()
+		{
+			m_state->stopRequested.store(true);
+			Wake();
+		}
+
+		bool EventLoop::IsLoopThread() const
+		{
+			return m_state->loopThread.load() == std::this_thread::get_id();
+		}
+
+		size_t EventLoop::RunTimers()
+		{
+			State& state = *m_state;
+			const long long now = MonotonicNanos();
+			size_t fired = 0U;
+
+			while(!state.deadlines.empty() && state.deadlines.begin()->first <= now)
+			{
+				const Handle handle = state.deadlines.begin()->second;
+				state.deadlines.erase(state.deadlines.begin());
+				std::map<Handle, State::TimerEntry>::iterator timer = state.timers.find(handle);
+				if(timer == state.timers.end())
+				{
+					continue;
+				}
+
+				// Cancel of the firing timer is deferred to here, since the callback is still on the stack.
+				state.firingHandle = handle;
+				state.firingCancelled = false;
+				const bool again = timer->second.userFunc(nullptr, timer->second.userArg);
+				state.firingHandle = InvalidHandle;
+				fired++;
+
+				State::TimerEntry& entry = timer->second;
+				if(again && !state.firingCancelled && entry.intervalNanos > 0LL)
+				{
+					entry.deadlineNanos += entry.intervalNanos;
+					if(entry.deadlineNanos <= now)
+					{
+						entry.deadlineNanos += ((now - entry.deadlineNanos) / entry.intervalNanos + 1LL) * entry.intervalNanos;
+					}
+					state.deadlines.insert(std::make_pair(entry.deadlineNanos, handle));
+				}
+				else
+				{
+					state.timers.erase(timer);
+				}
+			}
+			return fired;
+		}
+
+		size_t EventLoop::RunPosted()
+		{
+			std::vector<std::function<void()>> tasks;
+			{
+				std::lock_guard<std::mutex> lock(m_state->postMutex);
+				tasks.swap(m_state->posted);
+			}
+			for(std::function<void()>& task : tasks)
+			{
+				task();
+			}
+			return tasks.size();
+		}
+
+		void TaskBase::Run()
+		{
+			Execute();
+			m_done.store(true, std::memory_order_seq_cst);
+			if(m_pool)
+			{
+				m_pool->NotifyCompletion();
+			}
+		}
+
+		// Chase-Lev work-stealing deque (Le, Pop, Cohen and Zappa Nardelli's C11 formulation). Only the owner
+		// pushes and pops at the bottom; any thread may steal from the top. Grown arrays are kept until the
+		// deque is destroyed because a concurrent thief may still be reading the old one.
+		class WorkStealingDeque
+		{
+		public:
+			WorkStealingDeque() :
+				m_top(0LL),
+				m_bottom(0LL),
+				m_array(nullptr),
+				m_arrays()
+			{
+				m_arrays.push_back(std::unique_ptr<Array>(new Array(1024U)));
+				m_array.store(m_arrays.back().get(), std::memory_order_relaxed);
+			}
+
+			void Push(TaskBase* task)
+			{
+				const long long bottom = m_bottom.load(std::memory_order_relaxed);
+				const long long top = m_top.load(std::memory_order_acquire);
+				Array* array = m_array.load(std::memory_order_relaxed);
+
+				if(bottom - top > static_cast<long long>(array->mask))
+				{
+					array = Grow(array, top, bottom);
+				}
+				array->Put(bottom, task);
+				// A release store rather than the paper's release fence: same cost, and visible to race checkers.
+				m_bottom.store(bottom + 1LL, std::memory_order_release);
+			}
+
+			TaskBase* Pop()
+			{
+				const long long bottom = m_bottom.load(std::memory_order_relaxed) - 1LL;
+				Array* array = m_array.load(std::memory_order_relaxed);
+				m_bottom.store(bottom, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				long long top = m_top.load(std::memory_order_relaxed);
+				TaskBase* task = nullptr;
+
+				if(top <= bottom)
+				{
+					task = array->Get(bottom);
+					if(top == bottom)
+					{
+						// Last element: race the thieves for it.
+						if(!m_top.compare_exchange_strong(top, top + 1LL, std::memory_order_seq_cst, std::memory_order_relaxed))
+						{
+							task = nullptr;
+						}
+						m_bottom.store(bottom + 1LL, std::memory_order_relaxed);
+					}
+				}
+				else
+				{
+					m_bottom.store(bottom + 1LL, std::memory_order_relaxed);
+				}
+
+				return task;
+			}
+
+			TaskBase* Steal()
+			{
+				long long top = m_top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				const long long bottom = m_bottom.load(std::memory_order_acquire);
+
+				if(top < bottom)
+				{
+					TaskBase* task = m_array.load(std::memory_order_acquire)->Get(top);
+					if(m_top.compare_exchange_strong(top, top + 1LL, std::memory_order_seq_cst, std::memory_order_relaxed))
+					{
+						return task;
+					}
+				}
+
+				return nullptr;
+			}
+
+		private:
+			struct Array
+			{
+				size_t mask;
+				std::unique_ptr<std::atomic<TaskBase*>[]> slots;
+
+				explicit Array(const size_t capacity) :
+					mask(capacity - 1U),
+					slots(new std::atomic<TaskBase*>[capacity])
+				{
+				}
+
+				TaskBase* Get(const long long index) const
+				{
+					return slots[static_cast<size_t>(index) & mask].load(std::memory_order_relaxed);
+				}
+
+				void Put(const long long index, TaskBase* task)
+				{
+					slots[static_cast<size_t>(index) & mask].store(task, std::memory_order_relaxed);
+				}
+			};
+
+			Array* Grow(Array* array, const long long top, const long long bottom)
 			{
-				uint32_t tableValue = 0;
-				uint32_t crc = 0;
+				m_arrays.push_back(std::unique_ptr<Array>(new Array((array->mask + 1U) * 2U)));
+				Array* grown = m_arrays.back().get();
+				for(long long index = top; index < bottom; index++)
+				{
+					grown->Put(index, array->Get(index));
+				}
+				m_array.store(grown, std::memory_order_release);
+				return grown;
+			}
 
-				if (CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL == polynomial)
+		private:
+			std::atomic<long long> m_top;
+			std::atomic<long long> m_bottom;
+			std::atomic<Array*> m_array;
+			std::vector<std::unique_ptr<Array>> m_arrays;
+		};
+
+		struct ThreadPool::Worker
+		{
+			ThreadPool* pool;
+			unsigned int index;
+			unsigned long long stealSeed;
+			WorkStealingDeque deque;
+			ThreadConfig config;
+			std::thread thread;
+
+			Worker(ThreadPool* owner, const unsigned int workerIndex) :
+				pool(owner),
+				index(workerIndex),
+				stealSeed(0x9E3779B97F4A7C15ULL * (workerIndex + 1U)),
+				deque(),
+				config(),
+				thread()
+			{
+			}
+		};
+
+		ThreadPool::ThreadPool(const unsigned int workerCount) :
+			m_workers(),
+			m_injectMutex(),
+			m_injectQueue(),
+			m_injectCount(0U),
+			m_stopRequested(false),
+			m_sleepingCount(0U),
+			m_wakeEpoch(0ULL),
+			m_sleepMutex(),
+			m_sleepCond(),
+			m_completionWaiters(0U),
+			m_completionMutex(),
+			m_completionCond()
+		{
+			StartWorkers((workerCount > 0U) ? workerCount : std::max(1U, std::thread::hardware_concurrency()), std::vector<ThreadConfig>());
+		}
+
+		ThreadPool::ThreadPool(const std::vector<ThreadConfig>& workerConfigs) :
+			m_workers(),
+			m_injectMutex(),
+			m_injectQueue(),
+			m_injectCount(0U),
+			m_stopRequested(false),
+			m_sleepingCount(0U),
+			m_wakeEpoch(0ULL),
+			m_sleepMutex(),
+			m_sleepCond(),
+			m_completionWaiters(0U),
+			m_completionMutex(),
+			m_completionCond()
+		{
+			StartWorkers(std::max<unsigned int>(1U, static_cast<unsigned int>(workerConfigs.size())), workerConfigs);
+		}
+
+		ThreadPool::~ThreadPool()
+		{
+			Shutdown();
+		}
+
+		void ThreadPool::StartWorkers(const unsigned int count, const std::vector<ThreadConfig>& workerConfigs)
+		{
+			for(unsigned int index = 0U; index < count; index++)
+			{
+				m_workers.push_back(std::unique_ptr<Worker>(new Worker(this, index)));
+				if(index < workerConfigs.size())
 				{
-					return DefaultCRC32Table[static_cast<uint8_t>(tableOffset)];
+					m_workers.back()->config = workerConfigs[index];
 				}
+			}
+			for(std::unique_ptr<Worker>& worker : m_workers)
+			{
+				worker->thread = std::thread(ThreadPool::InternalWorkerFunc, this, worker.get());
+			}
+		}
 
-				for(uint32_t c = 0; c <= tableOffset; c++)
+		void ThreadPool::Shutdown()
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_sleepMutex);
+				m_stopRequested.store(true);
+				m_wakeEpoch.fetch_add(1ULL);
+			}
+			m_sleepCond.notify_all();
+
+			for(std::unique_ptr<Worker>& worker : m_workers)
+			{
+				if(worker->thread.joinable() && worker->thread.get_id() != std::this_thread::get_id())
 				{
-					crc = ((crc ^ c) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 1)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 2)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 3)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 4)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 5)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 6)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 7)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
+					worker->thread.join();
+				}
+			}
 
-					tableValue = crc;
+			// Anything that raced into the injection queue while the workers were exiting.
+			while(TryRunPendingTask())
+			{
+			}
+		}
+
+		unsigned int ThreadPool::WorkerCount() const
+		{
+			return static_cast<unsigned int>(m_workers.size());
+		}
+
+		ThreadPool::Worker*& ThreadPool::CurrentThreadWorker()
+		{
+			static thread_local Worker* worker = nullptr;
+			return worker;
+		}
+
+		// The calling thread's worker if it belongs to this pool.
+		ThreadPool::Worker* ThreadPool::CurrentWorker() const
+		{
+			Worker* worker = CurrentThreadWorker();
+			return (worker != nullptr && this == worker->pool) ? worker : nullptr;
+		}
+
+		int ThreadPool::CurrentWorkerIndex() const
+		{
+			const Worker* worker = CurrentWorker();
+			return (worker != nullptr) ? static_cast<int>(worker->index) : -1;
+		}
+
+		ThreadPool& ThreadPool::Global()
+		{
+			static ThreadPool globalPool;
+			return globalPool;
+		}
+
+		void ThreadPool::Enqueue(TaskBase* task)
+		{
+			task->m_pool = this;
+
+			if(m_stopRequested.load())
+			{
+				task->Run();
+				task->Release();
+				return;
+			}
+
+			Worker* worker = CurrentWorker();
+			if(worker != nullptr)
+			{
+				worker->deque.Push(task);
+			}
+			else
+			{
+				std::lock_guard<AdaptiveMutex> lock(m_injectMutex);
+				m_injectQueue.push_back(task);
+				m_injectCount.fetch_add(1U, std::memory_order_relaxed);
+			}
+
+			// Pairs with the fence in InternalWorkerFunc: either the sleeper sees the task or we see the sleeper.
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if(m_sleepingCount.load(std::memory_order_relaxed) > 0U)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_sleepMutex);
+					m_wakeEpoch.fetch_add(1ULL, std::memory_order_relaxed);
 				}
+				m_sleepCond.notify_one();
+			}
+		}
 
-				return tableValue;
+		TaskBase* ThreadPool::FindTask(Worker* self)
+		{
+			TaskBase* task = (self != nullptr) ? self->deque.Pop() : nullptr;
+
+			if(nullptr == task && m_injectCount.load(std::memory_order_relaxed) > 0U)
+			{
+				std::lock_guard<AdaptiveMutex> lock(m_injectMutex);
+				if(!m_injectQueue.empty())
+				{
+					task = m_injectQueue.front();
+					m_injectQueue.pop_front();
+					m_injectCount.fetch_sub(1U, std::memory_order_relaxed);
+				}
 			}
 
-			uint32_t Calculate(const void* data, const size_t dataSizeBytes, const uint32_t polynomial)
+			if(nullptr == task)
 			{
-				return Recalculate(CRC32_DEFAULT, data, dataSizeBytes, polynomial);
+				// Start at a pseudo-random victim so that thieves spread out.
+				const size_t count = m_workers.size();
+				size_t victim = 0U;
+				if(self != nullptr)
+				{
+					self->stealSeed ^= self->stealSeed << 13;
+					self->stealSeed ^= self->stealSeed >> 7;
+					self->stealSeed ^= self->stealSeed << 17;
+					victim = static_cast<size_t>(self->stealSeed % count);
+				}
+
+				for(size_t i = 0U; i < count && nullptr == task; i++, victim = (victim + 1U) % count)
+				{
+					if(m_workers[victim].get() != self)
+					{
+						task = m_workers[victim]->deque.Steal();
+					}
+				}
 			}
 
-			uint32_t Recalculate(uint32_t crc, const void* data, const size_t dataSizeBytes, const uint32_t polynomial)
+			return task;
+		}
+
+		bool ThreadPool::TryRunPendingTask()
+		{
+			TaskBase* task = FindTask(CurrentWorker());
+
+			if(nullptr == task)
 			{
-				const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data);
-				uint32_t tableIndex;
-				size_t dataIndex;
+				return false;
+			}
 
-				if(CRC32_DEFAULT != crc)
+			task->Run();
+			task->Release();
+			return true;
+		}
+
+		void ThreadPool::WaitFor(const TaskBase& task)
+		{
+			while(!task.IsDone())
+			{
+				if(TryRunPendingTask())
 				{
-					crc ^= CRC32_XOR;
+					continue;
 				}
 
-				for(dataIndex = 0; dataIndex < dataSizeBytes; dataIndex++)
+				// Nothing to help with: block until some task completes, re-checking for new work now and then.
+				std::unique_lock<std::mutex> lock(m_completionMutex);
+				m_completionWaiters.fetch_add(1U);
+				if(!task.IsDone())
 				{
-					tableIndex = crc ^ static_cast<uint32_t>(dataPtr[dataIndex]);
-					crc = (crc >> 8) ^ GetTableValue(tableIndex, polynomial);
+					m_completionCond.wait_for(lock, std::chrono::milliseconds(1));
 				}
+				m_completionWaiters.fetch_sub(1U);
+			}
+		}
 
-				crc ^= CRC32_XOR;
+		void ThreadPool::NotifyCompletion()
+		{
+			if(m_completionWaiters.load() > 0U)
+			{
+				{
+					std::lock_guard<std::mutex> lock(m_completionMutex);
+				}
+				m_completionCond.notify_all();
+			}
+		}
 
-				return crc;
+		void ThreadPool::InternalWorkerFunc(ThreadPool* pool, Worker* self)
+		{
+			ApplyThreadConfig(self->config);
+			CurrentThreadWorker() = self;
+
+			while(true)
+			{
+				TaskBase* task = pool->FindTask(self);
+
+				for(int spin = 0; nullptr == task && spin < 64; spin++)
+				{
+					CpuRelax();
+					task = pool->FindTask(self);
+				}
+
+				if(nullptr == task)
+				{
+					const unsigned long long epoch = pool->m_wakeEpoch.load();
+					pool->m_sleepingCount.fetch_add(1U);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+
+					task = pool->FindTask(self);
+					if(nullptr == task)
+					{
+						if(pool->m_stopRequested.load())
+						{
+							pool->m_sleepingCount.fetch_sub(1U);
+							break;
+						}
+
+						std::unique_lock<std::mutex> lock(pool->m_sleepMutex);
+						pool->m_sleepCond.wait(lock, [pool, epoch]() -> bool { return pool->m_wakeEpoch.load() != epoch; });
+					}
+					pool->m_sleepingCount.fetch_sub(1U);
+				}
+
+				if(task != nullptr)
+				{
+					task->Run();
+					task->Release();
+				}
 			}
-		} // namespace CRC32
 
-		namespace CRC16
+			CurrentThreadWorker() = nullptr;
+		}
+
+		struct TaskGraph::Node
 		{
-			// Pre-calculated CRC16 lookup table with 0x8005
-			static const uint16_t DefaultCRC16Table[256] = {
-				0x0000, 0xC0C1, 0xC181, 0x0140, 0xC301, 0x03C0, 0x0280, 0xC241, 0xC601, 0x06C0, 0x0780, 0xC741,
-				0x0500, 0xC5C1, 0xC481, 0x0440, 0xCC01, 0x0CC0, 0x0D80, 0xCD41, 0x0F00, 0xCFC1, 0xCE81, 0x0E40,
-				0x0A00, 0xCAC1, 0xCB81, 0x0B40, 0xC901, 0x09C0, 0x0880, 0xC841, 0xD801, 0x18C0, 0x1980, 0xD941,
-				0x1B00, 0xDBC1, 0xDA81, 0x1A40, 0x1E00, 0xDEC1, 0xDF81, 0x1F40, 0xDD01, 0x1DC0, 0x1C80, 0xDC41,
-				0x1400, 0xD4C1, 0xD581, 0x1540, 0xD701, 0x17C0, 0x1680, 0xD641, 0xD201, 0x12C0, 0x1380, 0xD341,
-				0x1100, 0xD1C1, 0xD081, 0x1040, 0xF001, 0x30C0, 0x3180, 0xF141, 0x3300, 0xF3C1, 0xF281, 0x3240,
-				0x3600, 0xF6C1, 0xF781, 0x3740, 0xF501, 0x35C0, 0x3480, 0xF441, 0x3C00, 0xFCC1, 0xFD81, 0x3D40,
-				0xFF01, 0x3FC0, 0x3E80, 0xFE41, 0xFA01, 0x3AC0, 0x3B80, 0xFB41, 0x3900, 0xF9C1, 0xF881, 0x3840,
-				0x2800, 0xE8C1, 0xE981, 0x2940, 0xEB01, 0x2BC0, 0x2A80, 0xEA41, 0xEE01, 0x2EC0, 0x2F80, 0xEF41,
-				0x2D00, 0xEDC1, 0xEC81, 0x2C40, 0xE401, 0x24C0, 0x2580, 0xE541, 0x2700, 0xE7C1, 0xE681, 0x2640,
-				0x2200, 0xE2C1, 0xE381, 0x2340, 0xE101, 0x21C0, 0x2080, 0xE041, 0xA001, 0x60C0, 0x6180, 0xA141,
-				0x6300, 0xA3C1, 0xA281, 0x6240, 0x6600, 0xA6C1, 0xA781, 0x6740, 0xA501, 0x65C0, 0x6480, 0xA441,
-				0x6C00, 0xACC1, 0xAD81, 0x6D40, 0xAF01, 0x6FC0, 0x6E80, 0xAE41, 0xAA01, 0x6AC0, 0x6B80, 0xAB41,
-				0x6900, 0xA9C1, 0xA881, 0x6840, 0x7800, 0xB8C1, 0xB981, 0x7940, 0xBB01, 0x7BC0, 0x7A80, 0xBA41,
-				0xBE01, 0x7EC0, 0x7F80, 0xBF41, 0x7D00, 0xBDC1, 0xBC81, 0x7C40, 0xB401, 0x74C0, 0x7580, 0xB541,
-				0x7700, 0xB7C1, 0xB681, 0x7640, 0x7200, 0xB2C1, 0xB381, 0x7340, 0xB101, 0x71C0, 0x7080, 0xB041,
-				0x5000, 0x90C1, 0x9181, 0x5140, 0x9301, 0x53C0, 0x5280, 0x9241, 0x9601, 0x56C0, 0x5780, 0x9741,
-				0x5500, 0x95C1, 0x9481, 0x5440, 0x9C01, 0x5CC0, 0x5D80, 0x9D41, 0x5F00, 0x9FC1, 0x9E81, 0x5E40,
-				0x5A00, 0x9AC1, 0x9B81, 0x5B40, 0x9901, 0x59C0, 0x5880, 0x9841, 0x8801, 0x48C0, 0x4980, 0x8941,
-				0x4B00, 0x8BC1, 0x8A81, 0x4A40, 0x4E00, 0x8EC1, 0x8F81, 0x4F40, 0x8D01, 0x4DC0, 0x4C80, 0x8C41,
-				0x4400, 0x84C1, 0x8581, 0x4540, 0x8701, 0x47C0, 0x4680, 0x8641, 0x8201, 0x42C0, 0x4380, 0x8341,
-				0x4100, 0x81C1, 0x8081, 0x4040
-			};
+			std::function<void()> func;
+			std::vector<NodeId> dependents;
+			size_t dependencyCount;
+			std::atomic<size_t> pending;
+			NodeStats stats;
 
-			static inline uint16_t GetTableValue(const uint16_t tableOffset, const uint16_t polynomial)
+			Node(const std::string& name, std::function<void()> nodeFunc) :
+				func(nodeFunc),
+				dependents(),
+				dependencyCount(0U),
+				pending(0U),
+				stats()
 			{
-				uint16_t tableValue = 0;
-				uint16_t crc = 0;
+				stats.name = name;
+			}
+		};
 
-				if(CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL == polynomial)
+		TaskGraph::TaskGraph(ThreadPool& pool) :
+			m_pool(pool),
+			m_nodes(),
+			m_running(false),
+			m_cancelled(false),
+			m_cancelPending(false),
+			m_unfinished(0U),
+			m_beganNanos(0LL),
+			m_errorMutex(),
+			m_firstError()
+		{
+		}
+
+		TaskGraph::~TaskGraph()
+		{
+		}
+
+		TaskGraph::Node& TaskGraph::GetNode(const NodeId node) const
+		{
+			if(node >= m_nodes.size())
+			{
+				throw std::out_of_range("TaskGraph node id is out of range");
+			}
+			return *m_nodes[node];
+		}
+
+		TaskGraph::NodeId TaskGraph::AddNode(const std::string& name, std::function<void()> func)
+		{
+			if(m_running.load())
+			{
+				throw std::logic_error("TaskGraph cannot be modified while it runs");
+			}
+			m_nodes.push_back(std::unique_ptr<Node>(new Node(name, func)));
+			return m_nodes.size() - 1U;
+		}
+
+		void TaskGraph::AddDependency(const NodeId node, const NodeId dependsOn)
+		{
+			if(m_running.load())
+			{
+				throw std::logic_error("TaskGraph cannot be modified while it runs");
+			}
+			Node& dependent = GetNode(node);
+			GetNode(dependsOn).dependents.push_back(node);
+			dependent.dependencyCount++;
+		}
+
+		TaskGraph::NodeId TaskGraph::Then(const NodeId predecessor, const std::string& name, std::function<void()> func)
+		{
+			GetNode(predecessor);
+			const NodeId node = AddNode(name, func);
+			AddDependency(node, predecessor);
+			return node;
+		}
+
+		std::vector<TaskGraph::NodeId> TaskGraph::TopologicalOrder() const
+		{
+			std::vector<size_t> pending(m_nodes.size());
+			std::vector<NodeId> order;
+
+			for(NodeId node = 0U; node < m_nodes.size(); node++)
+			{
+				pending[node] = m_nodes[node]->dependencyCount;
+				if(0U == pending[node])
+				{
+					order.push_back(node);
+				}
+			}
+			for(size_t next = 0U; next < order.size(); next++)
+			{
+				for(const NodeId dependent : m_nodes[order[next]]->dependents)
+				{
+					if(0U == --pending[dependent])
+					{
+						order.push_back(dependent);
+					}
+				}
+			}
+
+			if(order.size() != m_nodes.size())
+			{
+				throw std::logic_error("TaskGraph contains a dependency cycle");
+			}
+			return order;
+		}
+
+		void TaskGraph::Run()
+		{
+			if(m_running.exchange(true))
+			{
+				throw std::logic_error("TaskGraph is already running");
+			}
+
+			std::vector<NodeId> roots;
+			try
+			{
+				TopologicalOrder();
+			}
+			catch(...)
+			{
+				m_running.store(false);
+				throw;
+			}
+
+			for(NodeId node = 0U; node < m_nodes.size(); node++)
+			{
+				Node& entry = *m_nodes[node];
+				entry.pending.store(entry.dependencyCount, std::memory_order_relaxed);
+				entry.stats.startNanos = 0LL;
+				entry.stats.endNanos = 0LL;
+				entry.stats.durationNanos = 0LL;
+				entry.stats.ran = false;
+				entry.stats.skipped = false;
+				entry.stats.failed = false;
+				if(0U == entry.dependencyCount)
+				{
+					roots.push_back(node);
+				}
+			}
+			// A Cancel() since the last run is consumed here rather than discarded.
+			m_cancelled.store(m_cancelPending.exchange(false));
+			m_firstError = std::exception_ptr();
+			m_unfinished.store(static_cast<unsigned int>(m_nodes.size()));
+			m_beganNanos = Time::Nanos();
+
+			for(const NodeId root : roots)
+			{
+				Dispatch(root);
+			}
+
+			// The unfinished count doubles as the futex word the last node wakes us on.
+			for(unsigned int unfinished = m_unfinished.load(); unfinished > 0U; unfinished = m_unfinished.load())
+			{
+				if(!m_pool.TryRunPendingTask())
+				{
+					FutexWait(m_unfinished, unfinished, 1000LL);
+				}
+			}
+
+			m_cancelPending.store(false);
+			m_running.store(false);
+			if(m_firstError)
+			{
+				std::rethrow_exception(m_firstError);
+			}
+		}
+
+		void TaskGraph::Dispatch(const NodeId node)
+		{
+			m_pool.Submit([this, node]() { Execute(node); });
+		}
+
+		void TaskGraph::Execute(const NodeId node)
+		{
+			Node& entry = *m_nodes[node];
+
+			if(m_cancelled.load(std::memory_order_relaxed))
+			{
+				entry.stats.skipped = true;
+			}
+			else
+			{
+				entry.stats.startNanos = Time::Nanos() - m_beganNanos;
+				try
+				{
+					if(entry.func)
+					{
+						entry.func();
+					}
+					entry.stats.ran = true;
+				}
+				catch(...)
 				{
-					return DefaultCRC16Table[static_cast<uint8_t>(tableOffset)];
+					entry.stats.failed = true;
+					std::lock_guard<std::mutex> lock(m_errorMutex);
+					if(!m_firstError)
+					{
+						m_firstError = std::current_exception();
+					}
+					m_cancelled.store(true);
 				}
+				entry.stats.endNanos = Time::Nanos() - m_beganNanos;
+				entry.stats.durationNanos = entry.stats.endNanos - entry.stats.startNanos;
+			}
 
-				for(uint16_t c = 0; c <= tableOffset; c++)
+			// Dependents are released even when this node was skipped so that they settle (as skipped) too.
+			for(const NodeId dependent : entry.dependents)
+			{
+				if(1U == m_nodes[dependent]->pending.fetch_sub(1U, std::memory_order_acq_rel))
 				{
-					crc = ((crc ^ c) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 1)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 2)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 3)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 4)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 5)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 6)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-					crc = ((crc ^ (c >> 7)) & 1) ? ((crc >> 1) ^ polynomial) : (crc >> 1);
-
-					tableValue = crc;
+					Dispatch(dependent);
 				}
-
-				return tableValue;
 			}
 
-			uint16_t Calculate(const void* data, const size_t dataSizeBytes, const uint16_t polynomial)
+			// Run() may return as soon as the count reaches zero; the wake only uses the word's address.
+			if(1U == m_unfinished.fetch_sub(1U, std::memory_order_acq_rel))
 			{
-				return Recalculate(CRC16_DEFAULT, data, dataSizeBytes, polynomial);
+				FutexWakeAll(m_unfinished);
 			}
+		}
 
-			uint16_t Recalculate(uint16_t crc, const void* data, const size_t dataSizeBytes, const uint16_t polynomial)
-			{
-				const uint8_t* dataPtr = reinterpret_cast<const uint8_t*>(data);
-				uint16_t tableIndex;
-				size_t dataIndex;
+		void TaskGraph::Cancel()
+		{
+			m_cancelPending.store(true);
+			m_cancelled.store(true);
+		}
 
-				if(CRC16_DEFAULT != crc)
+		bool TaskGraph::IsCancelled() const
+		{
+			return m_cancelled.load();
+		}
+
+		size_t TaskGraph::NodeCount() const
+		{
+			return m_nodes.size();
+		}
+
+		const TaskGraph::NodeStats& TaskGraph::Stats(const NodeId node) const
+		{
+			return GetNode(node).stats;
+		}
+
+		std::vector<TaskGraph::NodeId> TaskGraph::CriticalPath() const
+		{
+			const std::vector<NodeId> order = TopologicalOrder();
+			std::vector<long long> finish(m_nodes.size(), 0LL);
+			std::vector<NodeId> via(m_nodes.size(), m_nodes.size());
+			NodeId last = m_nodes.size();
+
+			// Longest path by measured durations, relaxing edges in topological order.
+			for(const NodeId node : order)
+			{
+				const Node& entry = *m_nodes[node];
+				finish[node] += entry.stats.durationNanos;
+				if(last == m_nodes.size() || finish[node] > finish[last])
 				{
-					crc ^= CRC16_XOR;
+					last = node;
 				}
-
-				for(dataIndex = 0; dataIndex < dataSizeBytes; dataIndex++)
+				for(const NodeId dependent : entry.dependents)
 				{
-					tableIndex = crc ^ static_cast<uint16_t>(dataPtr[dataIndex]);
-					crc = (crc >> 8) ^ GetTableValue(tableIndex, polynomial);
+					if(via[dependent] == m_nodes.size() || finish[node] > finish[dependent])
+					{
+						finish[dependent] = finish[node];
+						via[dependent] = node;
+					}
 				}
+			}
 
-				crc ^= CRC16_XOR;
+			std::vector<NodeId> path;
+			for(NodeId node = last; node < m_nodes.size(); node = via[node])
+			{
+				path.push_back(node);
+			}
+			std::reverse(path.begin(), path.end());
+			return path;
+		}
 
-				return crc;
+		long long TaskGraph::CriticalPathNanos() const
+		{
+			long long total = 0LL;
+			for(const NodeId node : CriticalPath())
+			{
+				total += m_nodes[node]->stats.durationNanos;
 			}
-		} // namespace CRC16
-	} // namespace Checksum
+			return total;
+		}
+	} // namespace Threading
 
-	namespace Time
+	namespace Io
 	{
-		static const std::chrono::high_resolution_clock::time_point monotonicBegan
-			= std::chrono::high_resolution_clock::now();
-
-		long long Micros()
+#if defined(__linux__)
+		MappedFile::MappedFile() :
+			m_fd(-1),
+			m_data(NULL),
+			m_size(0U)
 		{
-			return std::chrono::duration_cast<std::chrono::microseconds>(
-				std::chrono::high_resolution_clock::now() - monotonicBegan).count();
 		}
 
-		long long Millis()
+		MappedFile::MappedFile(const std::string& path, const unsigned int hints) :
+			m_fd(-1),
+			m_data(NULL),
+			m_size(0U)
 		{
-			return  Micros() / 1000LL;
+			Open(path, hints);
 		}
 
-		double Seconds()
+		MappedFile::~MappedFile()
 		{
-			return MicrosToSeconds(Micros());
+			Close();
 		}
 
-		double MicrosToSeconds(long long micros)
+		bool MappedFile::Open(const std::string& path, const unsigned int hints)
 		{
-			return static_cast<double>(micros) / 1000000.0;
+			Close();
+
+			const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			struct stat info;
+			if(fd < 0 || 0 != fstat(fd, &info) || !S_ISREG(info.st_mode) ||
+				static_cast<unsigned long long>(info.st_size) > static_cast<unsigned long long>(std::numeric_limits<size_t>::max()))
+			{
+				if(fd >= 0)
+				{
+					close(fd);
+				}
+				return false;
+			}
+
+			const size_t size = static_cast<size_t>(info.st_size);
+			if(size > 0U)
+			{
+				void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE | ((hints & Populate) ? MAP_POPULATE : 0), fd, 0);
+				if(MAP_FAILED == data)
+				{
+					close(fd);
+					return false;
+				}
+				m_data = static_cast<unsigned char*>(data);
+
+				if(hints & Sequential)
+				{
+					madvise(data, size, MADV_SEQUENTIAL);
+				}
+				else if(hints & Random)
+				{
+					madvise(data, size, MADV_RANDOM);
+				}
+				if(hints & WillNeed)
+				{
+					madvise(data, size, MADV_WILLNEED);
+				}
+				if(hints & HugePages)
+				{
+					madvise(data, size, MADV_HUGEPAGE);
+				}
+			}
+
+			m_fd = fd;
+			m_size = size;
+			return true;
 		}
 
-		double MillisToSeconds(long long millis)
+		void MappedFile::Close()
 		{
-			return static_cast<double>(millis) / 1000.0;
+			if(NULL != m_data)
+			{
+				munmap(m_data, m_size);
+				m_data = NULL;
+			}
+			if(m_fd >= 0)
+			{
+				close(m_fd);
+				m_fd = -1;
+			}
+			m_size = 0U;
 		}
 
-		long long SecondsToMicros(double seconds)
+		// madvise needs a page-aligned start, so ranges are widened to whole pages.
+		static void AdviseRange(unsigned char* data, const size_t mappedSize, const size_t offset, const size_t length, const int advice)
 		{
-			double partSeconds;
-			partSeconds = std::modf(seconds, &seconds);
-			return (static_cast<long long>(seconds) * 1000000LL)
-					+ static_cast<long long>(partSeconds * 1000000.0);
+			if(NULL == data || offset >= mappedSize)
+			{
+				return;
+			}
+			static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			const size_t begin = offset & ~(pageSize - 1U);
+			const size_t end = std::min(mappedSize, offset + std::min(length, mappedSize - offset));
+			madvise(data + begin, end - begin, advice);
 		}
 
-		long long SecondsToMillis(double seconds)
+		void MappedFile::PrefetchRange(const size_t offset, const size_t length) const
 		{
-			return SecondsToMicros(seconds) / 1000LL;
+			AdviseRange(m_data, m_size, offset, length, MADV_WILLNEED);
 		}
 
-		void WaitSeconds(double seconds)
+		void MappedFile::ReleaseRange(const size_t offset, const size_t length) const
 		{
-			seconds += Seconds();
-			do {} while(Seconds() < seconds);
+			AdviseRange(m_data, m_size, offset, length, MADV_DONTNEED);
 		}
 
-		void WaitMillis(long long millis)
+		ChunkedReader::ChunkedReader(const size_t chunkSize) :
+			m_chunkSize((std::max<size_t>(chunkSize, 4096U) + 4095U) & ~static_cast<size_t>(4095U)),
+			m_buffers(),
+			m_sizes(),
+			m_fd(-1),
+			m_offset(0ULL),
+			m_remaining(0ULL),
+			m_nextBuffer(0U),
+			m_holdingBuffer(false),
+			m_finished(true),
+			m_failed(false),
+			m_stopRequested(false),
+			m_freeBuffers(0U),
+			m_filledBuffers(0U),
+			m_readThread()
 		{
-			millis += Millis();
-			do {} while(Millis() < millis);
+			for(unsigned char*& buffer : m_buffers)
+			{
+				void* aligned = NULL;
+				if(0 != posix_memalign(&aligned, 4096U, m_chunkSize))
+				{
+					for(unsigned char* allocated : m_buffers)
+					{
+						free(allocated);
+					}
+					throw std::bad_alloc();
+				}
+				buffer = static_cast<unsigned char*>(aligned);
+			}
 		}
 
-		void WaitMicros(long long micros)
+		ChunkedReader::~ChunkedReader()
 		{
-			micros += Micros();
-			do {} while(Micros() < micros);
+			Close();
+			free(m_buffers[0]);
+			free(m_buffers[1]);
 		}
 
-		Stopwatch::Stopwatch()
+		bool ChunkedReader::Open(const std::string& path, const unsigned long long offset, const unsigned long long length)
 		{
-			Set(Micros());
+			Close();
+
+			m_fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if(m_fd < 0)
+			{
+				return false;
+			}
+			posix_fadvise(m_fd, static_cast<off_t>(offset), 0, POSIX_FADV_SEQUENTIAL);
+
+			m_offset = offset;
+			m_remaining = length;
+			m_nextBuffer = 0U;
+			m_holdingBuffer = false;
+			m_finished = false;
+			m_failed.store(false);
+			m_stopRequested.store(false);
+			m_freeBuffers.Release(2U);
+			m_readThread.reset(new std::thread(ChunkedReader::InternalReadFunc, this));
+			return true;
 		}
 
-		Stopwatch::Stopwatch(const int micros)
+		bool ChunkedReader::Next(const unsigned char*& data, size_t& size)
 		{
-			Set(micros);
+			if(m_finished)
+			{
+				return false;
+			}
+			if(m_holdingBuffer)
+			{
+				m_freeBuffers.Release();
+				m_holdingBuffer = false;
+			}
+
+			m_filledBuffers.Acquire();
+			const unsigned int index = m_nextBuffer;
+			m_nextBuffer ^= 1U;
+			if(0U == m_sizes[index])
+			{
+				// The reader posts an empty chunk at the end of the range or after an error.
+				m_finished = true;
+				return false;
+			}
+
+			m_holdingBuffer = true;
+			data = m_buffers[index];
+			size = m_sizes[index];
+			return true;
 		}
 
-		Stopwatch::Stopwatch(const unsigned int micros)
+		bool ChunkedReader::Failed() const
 		{
-			Set(micros);
+			return m_failed.load();
 		}
 
-		Stopwatch::Stopwatch(const long long micros)
+		void ChunkedReader::Close()
 		{
-			Set(micros);
+			if(m_readThread)
+			{
+				m_stopRequested.store(true);
+				m_freeBuffers.Release(2U);
+				m_readThread->join();
+				m_readThread.reset();
+			}
+			if(m_fd >= 0)
+			{
+				close(m_fd);
+				m_fd = -1;
+			}
+			// Leave both semaphores at zero for the next Open.
+			while(m_freeBuffers.TryAcquire())
+			{
+			}
+			while(m_filledBuffers.TryAcquire())
+			{
+			}
+			m_finished = true;
 		}
 
-		Stopwatch::Stopwatch(const unsigned long long micros)
+		void ChunkedReader::InternalReadFunc(ChunkedReader* reader)
 		{
-			Set(micros);
-		}
+			unsigned long long offset = reader->m_offset;
+			unsigned long long remaining = reader->m_remaining;
+			bool seekable = true;
 
-		Stopwatch::Stopwatch(const double seconds)
+			for(unsigned int index = 0U; ; index ^= 1U)
+			{
+				reader->m_freeBuffers.Acquire();
+				if(reader->m_stopRequested.load())
+				{
+					return;
+				}
+
+				// The first read ends on a chunk boundary so that later reads are aligned.
+				const size_t alignedWant = reader->m_chunkSize - static_cast<size_t>(offset % reader->m_chunkSize);
+				const size_t want = static_cast<size_t>(std::min<unsigned long long>(alignedWant, remaining));
+				size_t filled = 0U;
+				while(filled < want)
+				{
+					ssize_t count = seekable ? pread(reader->m_fd, reader->m_buffers[index] + filled, want - filled, static_cast<off_t>(offset + filled)) : -1;
+					if(count < 0 && seekable && ESPIPE == errno && 0ULL == reader->m_offset)
+					{
+						seekable = false;
+					}
+					if(!seekable)
+					{
+						count = read(reader->m_fd, reader->m_buffers[index] + filled, want - filled);
+					}
+					if(count < 0 && EINTR == errno)
+					{
+						continue;
+					}
+					if(count < 0)
+					{
+						reader->m_failed.store(true);
+						break;
+					}
+					if(0 == count)
+					{
+						break;
+					}
+					filled += static_cast<size_t>(count);
+				}
+
+				reader->m_sizes[index] = filled;
+				offset += filled;
+				remaining -= filled;
+				reader->m_filledBuffers.Release();
+				if(0U == filled)
+				{
+					return;
+				}
+				if(filled < want || 0ULL == remaining)
+				{
+					// Post the end marker in the other buffer once the caller hands it back.
+					reader->m_freeBuffers.Acquire();
+					if(!reader->m_stopRequested.load())
+					{
+						reader->m_sizes[index ^ 1U] = 0U;
+						reader->m_filledBuffers.Release();
+					}
+					return;
+				}
+			}
+		}
+#else
+		MappedFile::MappedFile() :
+			m_fd(-1),
+			m_data(NULL),
+			m_size(0U)
 		{
-			Set(seconds);
 		}
 
-		void Stopwatch::Reset()
+		MappedFile::MappedFile(const std::string&, const unsigned int) :
+			m_fd(-1),
+			m_data(NULL),
+			m_size(0U)
 		{
-			Set(0LL);
 		}
 
-		void Stopwatch::Set(const long long micros)
+		MappedFile::~MappedFile()
 		{
-			m_beganAt = Micros() + micros;
 		}
 
-		void Stopwatch::Set(const unsigned long long micros)
+		bool MappedFile::Open(const std::string&, const unsigned int)
 		{
-			Set(static_cast<long long>(micros));
+			return false;
 		}
 
-		void Stopwatch::Set(const int micros)
+		void MappedFile::Close()
 		{
-			Set(static_cast<long long>(micros));
 		}
 
-		void Stopwatch::Set(const unsigned int micros)
+		void MappedFile::PrefetchRange(const size_t, const size_t) const
 		{
-			Set(static_cast<long long>(micros));
 		}
 
-		void Stopwatch::Set(const double seconds)
+		void MappedFile::ReleaseRange(const size_t, const size_t) const
 		{
-			Set(SecondsToMicros(seconds));
 		}
 
-		long long Stopwatch::Get() const
+		ChunkedReader::ChunkedReader(const size_t chunkSize) :
+			m_chunkSize(chunkSize),
+			m_buffers(),
+			m_sizes(),
+			m_fd(-1),
+			m_offset(0ULL),
+			m_remaining(0ULL),
+			m_nextBuffer(0U),
+			m_holdingBuffer(false),
+			m_finished(true),
+			m_failed(false),
+			m_stopRequested(false),
+			m_freeBuffers(0U),
+			m_filledBuffers(0U),
+			m_readThread()
 		{
-			return Micros() - m_beganAt;
 		}
 
-		long long Stopwatch::GetMillis() const
+		ChunkedReader::~ChunkedReader()
 		{
-			return Get() / 1000LL;
 		}
 
-		double Stopwatch::GetSeconds() const
+		bool ChunkedReader::Open(const std::string&, const unsigned long long, const unsigned long long)
 		{
-			return MicrosToSeconds(Get());
+			return false;
 		}
 
-		bool Stopwatch::HasExceded(const long long micros) const
+		bool ChunkedReader::Next(const unsigned char*&, size_t&)
 		{
-			return static_cast<bool>(Get() >= micros);
+			return false;
 		}
 
-		bool Stopwatch::HasExceded(const unsigned long long micros) const
+		bool ChunkedReader::Failed() const
 		{
-			return static_cast<bool>(Get() >= static_cast<long long>(micros));
+			return m_failed.load();
 		}
 
-		bool Stopwatch::HasExceded(const int micros) const
+		void ChunkedReader::Close()
 		{
-			return static_cast<bool>(Get() >= static_cast<long long>(micros));
 		}
+#endif
 
-		bool Stopwatch::HasExceded(const unsigned int micros) const
+		bool MappedFile::IsOpen() const
 		{
-			return static_cast<bool>(Get() >= static_cast<long long>(micros));
+			return m_fd >= 0;
 		}
 
-		bool Stopwatch::HasExceded(const double seconds) const
+		const unsigned char* MappedFile::Data() const
 		{
-			return static_cast<bool>(GetSeconds() > seconds || Numeric::IsDoubleEqual(GetSeconds(), seconds));
+			return m_data;
 		}
 
-		void Stopwatch::operator=(const long long& value)
+		size_t MappedFile::Size() const
 		{
-			Set(value);
+			return m_size;
 		}
 
-		void Stopwatch::operator=(const unsigned long long& value)
+		bool ForEachChunk(const std::string& path, const std::function<void(const unsigned char*, size_t, unsigned long long)>& func)
 		{
-			Set(value);
+			// Windows of the mapping are prefetched one ahead and dropped behind, keeping the resident set small.
+			const size_t windowBytes = 4U * 1024U * 1024U;
+			// procfs and sysfs files report a size of zero but have content, so only non-empty files are mapped.
+			MappedFile mapped;
+			if(mapped.Open(path, MappedFile::Sequential) && mapped.Size() > 0U)
+			{
+				for(size_t offset = 0U; offset < mapped.Size(); offset += windowBytes)
+				{
+					const size_t length = std::min(windowBytes, mapped.Size() - offset);
+					mapped.PrefetchRange(offset + length, windowBytes);
+					func(mapped.Data() + offset, length, offset);
+					mapped.ReleaseRange(offset, length);
+				}
+				return true;
+			}
+
+			ChunkedReader reader;
+			if(reader.Open(path))
+			{
+				const unsigned char* data = NULL;
+				size_t size = 0U;
+				unsigned long long offset = 0ULL;
+				while(reader.Next(data, size))
+				{
+					func(data, size, offset);
+					offset += size;
+				}
+				return !reader.Failed();
+			}
+
+			std::ifstream file(path.c_str(), std::ios::binary);
+			if(!file)
+			{
+				return false;
+			}
+			std::vector<char> buffer(windowBytes);
+			unsigned long long offset = 0ULL;
+			while(file)
+			{
+				file.read(&buffer[0], static_cast<std::streamsize>(buffer.size()));
+				const size_t count = static_cast<size_t>(file.gcount());
+				if(count > 0U)
+				{
+					func(reinterpret_cast<const unsigned char*>(&buffer[0]), count, offset);
+					offset += count;
+				}
+			}
+			return file.eof();
 		}
+	} // namespace Io
 
-		void Stopwatch::operator=(const int& value)
+	namespace Log
+	{
+		struct LogRecordHeader
 		{
-			Set(value);
-		}
+			uint32_t size;
+			uint32_t argBytes;
+			unsigned long long ticks;
+			// Null marks padding at the end of the ring.
+			const char* fmt;
+			int level;
+		};
 
-		void Stopwatch::operator=(const unsigned int& value)
+		// Byte ring owned by one thread; records are 8-byte aligned and never wrap, the writer is the only consumer.
+		struct LogBuffer
 		{
-			Set(value);
-		}
+			std::unique_ptr<unsigned long long[]> words;
+			unsigned char* data;
+			size_t capacity;
+			size_t mask;
+			unsigned int threadId;
+			size_t pendingHead;
+			std::atomic<size_t> head;
+			std::atomic<size_t> tail;
+			std::atomic<unsigned long long> dropped;
+			std::atomic<bool> retired;
 
-		void Stopwatch::operator=(const double& value)
+			LogBuffer(const size_t bytes, const unsigned int id) :
+				words(new unsigned long long[bytes / 8U]),
+				data(reinterpret_cast<unsigned char*>(words.get())),
+				capacity(bytes),
+				mask(bytes - 1U),
+				threadId(id),
+				pendingHead(0U),
+				head(0U),
+				tail(0U),
+				dropped(0ULL),
+				retired(false)
+			{
+			}
+		};
+
+		struct LogThreadHandle
 		{
-			Set(value);
-		}
+			std::shared_ptr<LogBuffer> buffer;
+
+			~LogThreadHandle()
+			{
+				if(buffer)
+				{
+					buffer->retired.store(true, std::memory_order_release);
+				}
+			}
+		};
+
+		struct LogState;
+		static void LogWriterFunc(LogState* state);
+
+		struct LogState
+		{
+			std::mutex registryMutex;
+			std::vector<std::shared_ptr<LogBuffer>> registry;
+			unsigned int nextThreadId;
+			Threading::Event wake;
+			std::atomic<bool> started;
+			std::atomic<bool> stopRequested;
+			std::atomic<unsigned long long> flushRequested;
+			std::atomic<unsigned long long> flushCompleted;
+			std::atomic<unsigned long long> retiredDropped;
+			std::mutex flushMutex;
+			std::condition_variable flushCond;
+			std::unique_ptr<std::thread> writerThread;
+
+			LogState() :
+				nextThreadId(1U),
+				wake(Threading::Event::Mode::AutoReset),
+				started(false),
+				stopRequested(false),
+				flushRequested(0ULL),
+				flushCompleted(0ULL),
+				retiredDropped(0ULL)
+			{
+				// The writer formats timestamps until it stops, so the tick clock has to be destroyed after this.
+				Time::Ticks();
+			}
+
+			~LogState()
+			{
+				if(writerThread)
+				{
+					stopRequested.store(true);
+					wake.Set();
+					writerThread->join();
+				}
+			}
+		};
 
-		bool Stopwatch::operator>(const long long& value)
-		{
-			return Get() > value;
-		}
+		static const long long logPollMicros = 1000LL;
+		static const size_t logBlockBytes = 64U * 1024U;
+		static const char* const logLevelNames[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR", "OFF" };
+		static std::atomic<int> logLevel(static_cast<int>(Level::Info));
+		static std::atomic<int> logFullPolicy(static_cast<int>(FullPolicy::Drop));
+		static std::atomic<size_t> logBufferCapacity(256U * 1024U);
+		static std::atomic<int> logOutput(1);
 
-		bool Stopwatch::operator>(const unsigned long long& value)
+		static LogState& GetLogState()
 		{
-			return Get() > static_cast<long long>(value);
+			static LogState state;
+			return state;
 		}
 
-		bool Stopwatch::operator>(const int& value)
+		static LogBuffer* GetThreadLogBuffer()
 		{
-			return Get() > static_cast<long long>(value);
-		}
+			static thread_local LogThreadHandle handle;
 
-		bool Stopwatch::operator>(const unsigned int& value)
-		{
-			return Get() > static_cast<long long>(value);
-		}
+			if(!handle.buffer)
+			{
+				LogState& state = GetLogState();
+				std::lock_guard<std::mutex> lock(state.registryMutex);
+				handle.buffer = std::make_shared<LogBuffer>(logBufferCapacity.load(std::memory_order_relaxed), state.nextThreadId++);
+				state.registry.push_back(handle.buffer);
+				if(!state.writerThread)
+				{
+					state.writerThread.reset(new std::thread(LogWriterFunc, &state));
+					state.started.store(true);
+				}
+			}
 
-		bool Stopwatch::operator>(const double& value)
-		{
-			return MicrosToSeconds(Get()) > value;
+			return handle.buffer.get();
 		}
 
-		bool Stopwatch::operator<(const long long& value)
+		void SetLevel(const Level level)
 		{
-			return Get() < value;
+			logLevel.store(static_cast<int>(level), std::memory_order_relaxed);
 		}
 
-		bool Stopwatch::operator<(const unsigned long long& value)
+		Level GetLevel()
 		{
-			return Get() < static_cast<long long>(value);
+			return static_cast<Level>(logLevel.load(std::memory_order_relaxed));
 		}
 
-		bool Stopwatch::operator<(const int& value)
+		bool IsEnabled(const Level level)
 		{
-			return Get() < static_cast<long long>(value);
+			return Level::Off != level && static_cast<int>(level) >= logLevel.load(std::memory_order_relaxed);
 		}
 
-		bool Stopwatch::operator<(const unsigned int& value)
+		void SetFullPolicy(const FullPolicy policy)
 		{
-			return Get() < static_cast<long long>(value);
+			logFullPolicy.store(static_cast<int>(policy), std::memory_order_relaxed);
 		}
 
-		bool Stopwatch::operator<(const double& value)
+		FullPolicy GetFullPolicy()
 		{
-			return MicrosToSeconds(Get()) < value;
+			return static_cast<FullPolicy>(logFullPolicy.load(std::memory_order_relaxed));
 		}
 
-		bool Stopwatch::operator>=(const long long& value)
+		void SetBufferCapacity(const size_t bytes)
 		{
-			return Get() >= value;
+			logBufferCapacity.store(static_cast<size_t>(Numeric::NextPow2(std::max(static_cast<size_t>(4096U), bytes))), std::memory_order_relaxed);
 		}
 
-		bool Stopwatch::operator>=(const unsigned long long& value)
+		void SetOutput(const int fd)
 		{
-			return Get() >= static_cast<long long>(value);
+			Flush();
+			logOutput.store(fd);
 		}
 
-		bool Stopwatch::operator>=(const int& value)
+		void Flush()
 		{
-			return Get() >= static_cast<long long>(value);
-		}
+			LogState& state = GetLogState();
+			if(!state.started.load())
+			{
+				return;
+			}
 
-		bool Stopwatch::operator>=(const unsigned int& value)
-		{
-			return Get() >= static_cast<long long>(value);
+			const unsigned long long ticket = state.flushRequested.fetch_add(1ULL) + 1ULL;
+			state.wake.Set();
+			std::unique_lock<std::mutex> lock(state.flushMutex);
+			state.flushCond.wait(lock, [&state, ticket]() { return state.flushCompleted.load() >= ticket; });
 		}
 
-		bool Stopwatch::operator>=(const double& value)
+		unsigned long long DroppedCount()
 		{
-			const double seconds = GetSeconds();
-			return static_cast<bool>((seconds > value) || Numeric::IsDoubleEqual(seconds, value));
-		}
+			LogState& state = GetLogState();
+			std::lock_guard<std::mutex> lock(state.registryMutex);
+			unsigned long long dropped = state.retiredDropped.load(std::memory_order_relaxed);
 
-		bool Stopwatch::operator<=(const long long& value)
-		{
-			return Get() <= static_cast<long long>(value);
-		}
+			for(const std::shared_ptr<LogBuffer>& buffer : state.registry)
+			{
+				dropped += buffer->dropped.load(std::memory_order_relaxed);
+			}
 
-		bool Stopwatch::operator<=(const unsigned long long& value)
-		{
-			return Get() <= static_cast<long long>(value);
+			return dropped;
 		}
 
-		bool Stopwatch::operator<=(const int& value)
+		namespace Internal
 		{
-			return Get() <= static_cast<long long>(value);
-		}
+			unsigned char* BeginRecord(const Level level, const char* fmt, const size_t argBytes)
+			{
+				LogBuffer* buffer = GetThreadLogBuffer();
+				const size_t recordBytes = (sizeof(LogRecordHeader) + argBytes + 7U) & ~static_cast<size_t>(7U);
+				if(recordBytes > buffer->capacity / 2U)
+				{
+					buffer->dropped.fetch_add(1ULL, std::memory_order_relaxed);
+					return NULL;
+				}
 
-		bool Stopwatch::operator<=(const unsigned int& value)
-		{
-			return Get() <= static_cast<long long>(value);
-		}
+				size_t head = buffer->head.load(std::memory_order_relaxed);
+				const size_t offset = head & buffer->mask;
+				const size_t padding = (offset + recordBytes > buffer->capacity) ? buffer->capacity - offset : 0U;
+				size_t used = head + padding + recordBytes - buffer->tail.load(std::memory_order_acquire);
+				while(used > buffer->capacity)
+				{
+					if(FullPolicy::Drop == static_cast<FullPolicy>(logFullPolicy.load(std::memory_order_relaxed)))
+					{
+						buffer->dropped.fetch_add(1ULL, std::memory_order_relaxed);
+						GetLogState().wake.Set();
+						return NULL;
+					}
+					GetLogState().wake.Set();
+					std::this_thread::yield();
+					used = head + padding + recordBytes - buffer->tail.load(std::memory_order_acquire);
+				}
+				// Past half full, wake the writer instead of waiting for its next poll.
+				if(used > buffer->capacity / 2U)
+				{
+					GetLogState().wake.Set();
+				}
 
-		bool Stopwatch::operator<=(const double& value)
-		{
-			const double seconds = GetSeconds();
-			return static_cast<bool>((seconds < value) || Numeric::IsDoubleEqual(seconds, value));
-		}
+				// A gap too small for a header is skipped implicitly, since no record fits in it either.
+				if(padding >= sizeof(LogRecordHeader))
+				{
+					LogRecordHeader* filler = reinterpret_cast<LogRecordHeader*>(buffer->data + offset);
+					filler->size = static_cast<uint32_t>(padding);
+					filler->fmt = NULL;
+				}
+				head += padding;
 
-		bool Stopwatch::operator==(const long long& value)
-		{
-			return Get() == value;
-		}
+				LogRecordHeader* header = reinterpret_cast<LogRecordHeader*>(buffer->data + (head & buffer->mask));
+				header->size = static_cast<uint32_t>(recordBytes);
+				header->argBytes = static_cast<uint32_t>(argBytes);
+				header->ticks = Time::Ticks();
+				header->fmt = fmt;
+				header->level = static_cast<int>(level);
+				buffer->pendingHead = head + recordBytes;
 
-		bool Stopwatch::operator==(const unsigned long long& value)
-		{
-			return Get() == static_cast<long long>(value);
+				return reinterpret_cast<unsigned char*>(header + 1);
+			}
+
+			void CommitRecord()
+			{
+				LogBuffer* buffer = GetThreadLogBuffer();
+				buffer->head.store(buffer->pendingHead, std::memory_order_release);
+			}
 		}
 
-		bool Stopwatch::operator==(const int& value)
+		struct LogArg
 		{
-			return Get() == static_cast<long long>(value);
-		}
+			Internal::ArgType type;
+			unsigned long long bits;
+			const char* str;
+			uint32_t length;
 
-		bool Stopwatch::operator==(const unsigned int& value)
+			long long AsInt() const
+			{
+				return (Internal::ArgType::Double == type) ? static_cast<long long>(AsDouble()) : static_cast<long long>(bits);
+			}
+
+			unsigned long long AsUInt() const
+			{
+				return (Internal::ArgType::Double == type) ? static_cast<unsigned long long>(AsDouble()) : bits;
+			}
+
+			double AsDouble() const
+			{
+				double value;
+				if(Internal::ArgType::Double == type)
+				{
+					memcpy(&value, &bits, sizeof(value));
+				}
+				else if(Internal::ArgType::Int == type)
+				{
+					value = static_cast<double>(static_cast<long long>(bits));
+				}
+				else
+				{
+					value = static_cast<double>(bits);
+				}
+				return value;
+			}
+		};
+
+		static bool NextLogArg(const unsigned char*& args, const unsigned char* end, LogArg& arg)
 		{
-			return Get() == static_cast<long long>(value);
+			if(end - args < 9)
+			{
+				return false;
+			}
+			arg.type = static_cast<Internal::ArgType>(args[0]);
+			memcpy(&arg.bits, args + 1, 8U);
+			args += 9;
+			arg.str = NULL;
+			arg.length = 0U;
+			if(Internal::ArgType::String == arg.type)
+			{
+				memcpy(&arg.length, args, 4U);
+				arg.str = reinterpret_cast<const char*>(args + 4);
+				args += 4U + arg.length;
+			}
+			return true;
 		}
 
-		bool Stopwatch::operator==(const double& value)
+		template<typename... T>
+		static void AppendLogFormatted(std::string& out, const char* spec, const T... values)
 		{
-			return Numeric::IsDoubleEqual(MicrosToSeconds(Get()), value);
+			char local[128];
+			const int needed = snprintf(local, sizeof(local), spec, values...);
+			if(needed < 0)
+			{
+				return;
+			}
+			if(static_cast<size_t>(needed) < sizeof(local))
+			{
+				out.append(local, static_cast<size_t>(needed));
+				return;
+			}
+			const size_t at = out.size();
+			out.resize(at + static_cast<size_t>(needed) + 1U);
+			snprintf(&out[at], static_cast<size_t>(needed) + 1U, spec, values...);
+			out.resize(at + static_cast<size_t>(needed));
 		}
-	} // namespace Time
 
-	namespace Threading
-	{
-		Timer::Timer() :
-			m_stopRequested(false),
-			m_started(false),
-			m_running(false),
-			m_intervalMillisecs(0U),
-			m_userArg(NULL),
-			m_userFunc(),
-			m_timerThread(),
-			m_timerMutex(),
-			m_timerStopCond()
+		/*
+			Formats one conversion at a time with snprintf. Length modifiers in the format are replaced by the
+			width the argument was stored with, so "%d", "%ld" and "%zu" all print the widened value correctly.
+		*/
+		static void FormatLogMessage(std::string& out, const char* fmt, const unsigned char* args, const size_t argBytes)
 		{
+			const unsigned char* const end = args + argBytes;
+			char spec[64];
+
+			for(const char* c = fmt; '\0' != *c;)
+			{
+				if('%' != *c)
+				{
+					const char* next = strchr(c, '%');
+					const size_t length = (NULL != next) ? static_cast<size_t>(next - c) : strlen(c);
+					out.append(c, length);
+					c += length;
+					continue;
+				}
+				if('%' == c[1])
+				{
+					out += '%';
+					c += 2;
+					continue;
+				}
+
+				const char* p = c + 1;
+				size_t length = 0U;
+				long long precision = -1LL;
+				bool missing = false;
+				LogArg arg;
+				spec[length++] = '%';
+				for(; '\0' != *p && NULL != strchr("-+ #0", *p); p++)
+				{
+					if(length < 16U)
+					{
+						spec[length++] = *p;
+					}
+				}
+				if('*' == *p)
+				{
+					missing = missing || !NextLogArg(args, end, arg);
+					length += static_cast<size_t>(snprintf(spec + length, 24U, "%d", missing ? 0 : static_cast<int>(arg.AsInt())));
+					p++;
+				}
+				for(; *p >= '0' && *p <= '9'; p++)
+				{
+					if(length < 40U)
+					{
+						spec[length++] = *p;
+					}
+				}
+				if('.' == *p)
+				{
+					p++;
+					precision = 0LL;
+					if('*' == *p)
+					{
+						missing = missing || !NextLogArg(args, end, arg);
+						precision = missing ? -1LL : arg.AsInt();
+						p++;
+					}
+					for(; *p >= '0' && *p <= '9'; p++)
+					{
+						precision = std::min(precision * 10LL + (*p - '0'), 1000000LL);
+					}
+				}
+				for(; '\0' != *p && NULL != strchr("hlLqjzt", *p); p++)
+				{
+				}
+				const char conversion = *p;
+				if('\0' == conversion)
+				{
+					out.append(c);
+					break;
+				}
+				p++;
+
+				if(missing || !NextLogArg(args, end, arg))
+				{
+					out.append(c, static_cast<size_t>(p - c));
+					c = p;
+					continue;
+				}
+				if(precision >= 0LL && 's' != conversion)
+				{
+					length += static_cast<size_t>(snprintf(spec + length, 16U, ".%lld", precision));
+				}
+
+				switch(conversion)
+				{
+				case 'd':
+				case 'i':
+					spec[length++] = 'l';
+					spec[length++] = 'l';
+					spec[length++] = conversion;
+					spec[length] = '\0';
+					AppendLogFormatted(out, spec, arg.AsInt());
+					break;
+				case 'u':
+				case 'o':
+				case 'x':
+				case 'X':
+					spec[length++] = 'l';
+					spec[length++] = 'l';
+					spec[length++] = conversion;
+					spec[length] = '\0';
+					AppendLogFormatted(out, spec, arg.AsUInt());
+					break;
+				case 'c':
+					spec[length++] = 'c';
+					spec[length] = '\0';
+					AppendLogFormatted(out, spec, static_cast<int>(arg.AsInt()));
+					break;
+				case 'e':
+				case 'E':
+				case 'f':
+				case 'F':
+				case 'g':
+				case 'G':
+				case 'a':
+				case 'A':
+					spec[length++] = conversion;
+					spec[length] = '\0';
+					AppendLogFormatted(out, spec, arg.AsDouble());
+					break;
+				case 's':
+				{
+					// Copied strings are not terminated, so the stored length always bounds the precision.
+					const char* str = (Internal::ArgType::String == arg.type && 0ULL != arg.bits) ? arg.str : "(null)";
+					const long long available = (Internal::ArgType::String == arg.type && 0ULL != arg.bits) ? arg.length : 6LL;
+					memcpy(spec + length, ".*s", 4U);
+					AppendLogFormatted(out, spec, static_cast<int>((precision >= 0LL) ? std::min(precision, available) : available), str);
+					break;
+				}
+				case 'p':
+					spec[length++] = 'p';
+					spec[length] = '\0';
+					AppendLogFormatted(out, spec, reinterpret_cast<const void*>(static_cast<uintptr_t>(arg.bits)));
+					break;
+				case 'n':
+					break;
+				default:
+					out.append(c, static_cast<size_t>(p - c));
+					break;
+				}
+				c = p;
+			}
 		}
 
-		Timer::~Timer()
+		struct LogPending
 		{
-			End();
-		}
+			unsigned long long ticks;
+			const LogRecordHeader* header;
+			unsigned int threadId;
+		};
 
-		void Timer::Begin(const unsigned int intervalMillisecs, TimerUserFunc userFunc, void* userArg)
+		// Lines go into fixed-size blocks, so a large batch is never copied as it grows; writev sends them together.
+		static void WriteLogBlocks(const int fd, const std::vector<std::string>& blocks, const size_t count)
 		{
-			if(!Running() && intervalMillisecs > 0U && userFunc)
+#if defined(__linux__)
+			std::vector<struct iovec> vectors;
+			for(size_t i = 0U; i < count; i++)
 			{
-				m_intervalMillisecs = intervalMillisecs;
-				m_userArg = userArg;
-				m_userFunc = userFunc;
-				m_stopRequested.store(false);
-				m_started.store(true);
-				m_timerThread.reset(new std::thread(Timer::InternalTimerFunc, this));
+				if(!blocks[i].empty())
+				{
+					struct iovec vector;
+					vector.iov_base = const_cast<char*>(blocks[i].data());
+					vector.iov_len = blocks[i].size();
+					vectors.push_back(vector);
+				}
 			}
-		}
 
-		void Timer::End()
-		{
-			m_stopRequested.store(true);
-			if (m_timerThread)
+			size_t first = 0U;
+			while(first < vectors.size())
 			{
-				m_timerStopCond.notify_one();
-				if(m_timerThread->joinable())
+				const ssize_t written = writev(fd, &vectors[first], static_cast<int>(std::min<size_t>(vectors.size() - first, IOV_MAX)));
+				if(written < 0)
 				{
-					m_timerThread->join();
+					if(EINTR == errno)
+					{
+						continue;
+					}
+					return;
+				}
+				for(size_t remaining = static_cast<size_t>(written); remaining > 0U && first < vectors.size();)
+				{
+					if(remaining >= vectors[first].iov_len)
+					{
+						remaining -= vectors[first].iov_len;
+						first++;
+					}
+					else
+					{
+						vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining;
+						vectors[first].iov_len -= remaining;
+						remaining = 0U;
+					}
 				}
 			}
-			else
+#else
+			for(size_t i = 0U; i < count; i++)
 			{
-				m_running.store(false);
+				std::fwrite(blocks[i].data(), 1U, blocks[i].size(), (2 == fd) ? stderr : stdout);
 			}
-			m_started.store(false);
+			std::fflush((2 == fd) ? stderr : stdout);
+#endif
 		}
 
-		bool Timer::Running()
+		static void DrainLogRings(LogState& state, std::vector<LogPending>& pending, std::vector<std::string>& blocks)
 		{
-			if(m_timerThread && m_started.load() && !m_running.load())
+			std::vector<std::shared_ptr<LogBuffer>> buffers;
 			{
-				std::this_thread::sleep_for(std::chrono::milliseconds(10));
+				std::lock_guard<std::mutex> lock(state.registryMutex);
+				buffers = state.registry;
 			}
-			return m_running.load();
-		}
-
-		bool Timer::WasStopRequested() const
-		{
-			return m_stopRequested.load();
-		}
 
-		void Timer::InternalTimerFunc(Timer* timer)
-		{
-			std::unique_lock<std::mutex> lck(timer->m_timerMutex);
+			// Read retired before head so that a ring seen as retired is drained completely.
+			std::vector<size_t> heads(buffers.size());
+			std::vector<bool> retired(buffers.size());
+			pending.clear();
+			for(size_t i = 0U; i < buffers.size(); i++)
+			{
+				LogBuffer& buffer = *buffers[i];
+				retired[i] = buffer.retired.load(std::memory_order_acquire);
+				heads[i] = buffer.head.load(std::memory_order_acquire);
+				for(size_t tail = buffer.tail.load(std::memory_order_relaxed); tail != heads[i];)
+				{
+					const size_t untilEnd = buffer.capacity - (tail & buffer.mask);
+					if(untilEnd < sizeof(LogRecordHeader))
+					{
+						tail += untilEnd;
+						continue;
+					}
+					const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(buffer.data + (tail & buffer.mask));
+					if(NULL != header->fmt)
+					{
+						LogPending record = { header->ticks, header, buffer.threadId };
+						pending.push_back(record);
+					}
+					tail += header->size;
+				}
+			}
 
-			timer->m_running.store(true);
+			std::stable_sort(pending.begin(), pending.end(), [](const LogPending& a, const LogPending& b) { return a.ticks < b.ticks; });
 
-			while (!timer->WasStopRequested())
+			size_t used = 0U;
+			std::string line;
+			for(const LogPending& record : pending)
 			{
-				if (!timer->m_userFunc(timer, timer->m_userArg))
+				const long long nanos = std::max(0LL, Time::TicksToEpochNanos(record.ticks));
+				const int level = std::min(std::max(record.header->level, 0), static_cast<int>(Level::Off));
+				line.clear();
+				AppendLogFormatted(line, "%lld.%06lld %-5s [%u] ", nanos / 1000000000LL, (nanos % 1000000000LL) / 1000LL, logLevelNames[level], record.threadId);
+				FormatLogMessage(line, record.header->fmt, reinterpret_cast<const unsigned char*>(record.header + 1), record.header->argBytes);
+				line += '\n';
+
+				if(0U == used || blocks[used - 1U].size() + line.size() > logBlockBytes)
 				{
-					break;
+					if(used == blocks.size())
+					{
+						blocks.push_back(std::string());
+						blocks.back().reserve(logBlockBytes);
+					}
+					blocks[used++].clear();
 				}
+				blocks[used - 1U] += line;
+			}
+			if(used > 0U)
+			{
+				WriteLogBlocks(logOutput.load(), blocks, used);
+			}
+
+			for(size_t i = 0U; i < buffers.size(); i++)
+			{
+				buffers[i]->tail.store(heads[i], std::memory_order_release);
+			}
 
-				if (timer->m_timerStopCond.wait_for(lck, std::chrono::milliseconds{ timer->m_intervalMillisecs },
-					[&]() -> bool { return timer->WasStopRequested(); }))
+			std::lock_guard<std::mutex> lock(state.registryMutex);
+			for(size_t i = 0U; i < buffers.size(); i++)
+			{
+				if(retired[i])
 				{
-					break;
+					state.retiredDropped.fetch_add(buffers[i]->dropped.load(std::memory_order_relaxed), std::memory_order_relaxed);
+					state.registry.erase(std::find(state.registry.begin(), state.registry.end(), buffers[i]));
 				}
 			}
+		}
 
-			timer->m_running.store(false);
+		static void LogWriterFunc(LogState* state)
+		{
+			std::vector<LogPending> pending;
+			std::vector<std::string> blocks;
+
+			for(;;)
+			{
+				// Sampled before draining: everything logged before these requests is in this drain.
+				const bool stopping = state->stopRequested.load();
+				const unsigned long long flushTicket = state->flushRequested.load();
+				DrainLogRings(*state, pending, blocks);
+
+				if(flushTicket != state->flushCompleted.load())
+				{
+					std::lock_guard<std::mutex> lock(state->flushMutex);
+					state->flushCompleted.store(flushTicket);
+					state->flushCond.notify_all();
+				}
+				if(stopping)
+				{
+					return;
+				}
+				state->wake.WaitMicros(logPollMicros);
+			}
 		}
-	} // namespace Threading
+	} // namespace Log
 } // namespace Helpers
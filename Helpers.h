@@ -6,21 +6,35 @@
 	Author: Jacob A Psimos
 */
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <condition_variable>
 #include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <iosfwd>
+#include <iterator>
 #include <memory>
 #include <mutex>
+#include <new>
 #include <stack>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <type_traits>
 #include <vector>
 #include <limits>
 #include <random>
 
+#if defined(__SSE2__) || defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
 // Definitions
 #define CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL   0xEDB88320
 #define CRC32_DEFAULT                            0xFFFFFFFF
@@ -28,14 +42,233 @@
 #define CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL   0xA001
 #define CRC16_DEFAULT                            0xFFFF
 #define CRC16_XOR                                0x0000
+#define HELPERS_CACHE_LINE_SIZE                  64
+
+#if defined(__has_builtin)
+#define HELPERS_HAS_BUILTIN(x)                   __has_builtin(x)
+#else
+#define HELPERS_HAS_BUILTIN(x)                   0
+#endif
 
-/* Macros */
+/* Macros - prefer the Numeric bit functions, which evaluate their argument once and are constexpr */
 #define ISPOWEROF2(x)   !(((x) != 0) && ((x) & ((x) - 1)))
 #define ISODD(x)        !!((x) & 1)
 #define ISEVEN(x)       !!((~(x)) & 1)
 
+/*
+	Log macros - HELPERS_LOG_INFO("%d items", n) and friends. Calls below HELPERS_LOG_COMPILED_LEVEL (0 Trace,
+	1 Debug, 2 Info, 3 Warning, 4 Error, 5 none) compile away; the rest are filtered by Log::SetLevel at run time.
+	Arguments are checked against the format at compile time but never evaluated by that check.
+*/
+#if !defined(HELPERS_LOG_COMPILED_LEVEL)
+#define HELPERS_LOG_COMPILED_LEVEL 0
+#endif
+#define HELPERS_LOG(level, ...) \
+	do \
+	{ \
+		if(static_cast<int>(level) >= HELPERS_LOG_COMPILED_LEVEL && Helpers::Log::IsEnabled(level)) \
+		{ \
+			Helpers::Log::Write(level, __VA_ARGS__); \
+		} \
+		else if(false) \
+		{ \
+			Helpers::Log::Internal::CheckFormat(__VA_ARGS__); \
+		} \
+	} while(false)
+#define HELPERS_LOG_TRACE(...)   HELPERS_LOG(Helpers::Log::Level::Trace, __VA_ARGS__)
+#define HELPERS_LOG_DEBUG(...)   HELPERS_LOG(Helpers::Log::Level::Debug, __VA_ARGS__)
+#define HELPERS_LOG_INFO(...)    HELPERS_LOG(Helpers::Log::Level::Info, __VA_ARGS__)
+#define HELPERS_LOG_WARNING(...) HELPERS_LOG(Helpers::Log::Level::Warning, __VA_ARGS__)
+#define HELPERS_LOG_ERROR(...)   HELPERS_LOG(Helpers::Log::Level::Error, __VA_ARGS__)
+
 namespace Helpers
 {
+	namespace Memory
+	{
+		/*
+			Arena - bump-pointer allocator over a chain of blocks. Allocate is an align and a pointer increment;
+			nothing is freed individually and destructors of objects placed in the arena are not run. Reset
+			rewinds to the first block but keeps every block, so a steady per-request workload stops calling
+			malloc after the first requests. Huge pages use MAP_HUGETLB when the system has them reserved and
+			fall back to transparent huge pages. Not thread safe: use one arena per request or per thread.
+		*/
+		class Arena
+		{
+		public:
+			explicit Arena(const size_t blockSize = 64U * 1024U, const bool hugePages = false);
+			~Arena();
+
+			void* Allocate(const size_t size, const size_t alignment = alignof(std::max_align_t))
+			{
+				const uintptr_t cursor = reinterpret_cast<uintptr_t>(m_cursor);
+				const uintptr_t aligned = (cursor + (alignment - 1U)) & ~static_cast<uintptr_t>(alignment - 1U);
+				if(aligned >= cursor && aligned <= reinterpret_cast<uintptr_t>(m_end) && reinterpret_cast<uintptr_t>(m_end) - aligned >= size)
+				{
+					m_cursor = reinterpret_cast<char*>(aligned + size);
+					return reinterpret_cast<void*>(aligned);
+				}
+				return AllocateSlow(size, alignment);
+			}
+
+			template<typename T, typename... Args>
+			T* New(Args&&... args)
+			{
+				return new(Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+			}
+
+			// NUL-terminated copy of length characters.
+			char* CopyString(const char* str, const size_t length);
+			// Rewinds to the first block; retained blocks are reused before new ones are allocated.
+			void Reset();
+			// Frees every block.
+			void Release();
+			size_t BytesUsed() const;
+			size_t BytesReserved() const;
+			size_t BlockCount() const;
+
+		private:
+			struct Block
+			{
+				Block* next;
+				size_t capacity;
+				// Non-zero when the block was mapped with mmap rather than malloc'd.
+				size_t mappedBytes;
+			};
+			// Block data starts max_align_t aligned after the header.
+			static const size_t HeaderSize = (sizeof(Block) + alignof(std::max_align_t) - 1U) & ~(alignof(std::max_align_t) - 1U);
+
+			Arena(const Arena&);
+			Arena& operator=(const Arena&);
+			void* AllocateSlow(const size_t size, const size_t alignment);
+			Block* NewBlock(const size_t minCapacity);
+			static char* BlockData(Block* block);
+
+		private:
+			size_t m_blockSize;
+			bool m_hugePages;
+			Block* m_first;
+			Block* m_current;
+			char* m_cursor;
+			char* m_end;
+			size_t m_usedBytes;
+		};
+
+		// Standard allocator over an Arena; deallocate is a no-op. Containers copied between arenas compare
+		// unequal, so their storage is copied rather than shared.
+		template<typename T>
+		class ArenaAllocator
+		{
+		public:
+			typedef T value_type;
+
+			explicit ArenaAllocator(Arena& arena) :
+				m_arena(&arena)
+			{
+			}
+
+			template<typename U>
+			ArenaAllocator(const ArenaAllocator<U>& other) :
+				m_arena(other.GetArena())
+			{
+			}
+
+			T* allocate(const size_t count)
+			{
+				if(count > std::numeric_limits<size_t>::max() / sizeof(T))
+				{
+					throw std::bad_alloc();
+				}
+				return static_cast<T*>(m_arena->Allocate(count * sizeof(T), alignof(T)));
+			}
+
+			void deallocate(T*, const size_t)
+			{
+			}
+
+			Arena* GetArena() const
+			{
+				return m_arena;
+			}
+
+		private:
+			Arena* m_arena;
+		};
+
+		template<typename T, typename U>
+		bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+		{
+			return a.GetArena() == b.GetArena();
+		}
+
+		template<typename T, typename U>
+		bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b)
+		{
+			return a.GetArena() != b.GetArena();
+		}
+
+		typedef std::basic_string<char, std::char_traits<char>, ArenaAllocator<char>> ArenaString;
+		template<typename T>
+		using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+		/*
+			Slab allocator - size classes from 16 to 4096 bytes carved out of 64 KiB slabs. Each thread keeps a
+			free list per class, so allocation and free are a few instructions without locks or malloc; lists are
+			moved in batches through a shared depot when a thread runs dry or holds too many, and a thread's lists
+			go back to the depot when it exits. Memory may be freed on another thread than the one that
+			allocated it. Slabs are kept for the life of the process. Larger sizes go to operator new.
+		*/
+		const size_t SlabMaxSize = 4096U;
+
+		void* SlabAllocate(const size_t size);
+		// size must be the size passed to SlabAllocate.
+		void SlabFree(void* ptr, const size_t size);
+
+		// Stateless standard allocator over the slab allocator, e.g. for node-based containers.
+		template<typename T>
+		class SlabAllocator
+		{
+			static_assert(alignof(T) <= 16U, "slab allocations are 16 byte aligned");
+
+		public:
+			typedef T value_type;
+
+			SlabAllocator()
+			{
+			}
+
+			template<typename U>
+			SlabAllocator(const SlabAllocator<U>&)
+			{
+			}
+
+			T* allocate(const size_t count)
+			{
+				if(count > std::numeric_limits<size_t>::max() / sizeof(T))
+				{
+					throw std::bad_alloc();
+				}
+				return static_cast<T*>(SlabAllocate(count * sizeof(T)));
+			}
+
+			void deallocate(T* ptr, const size_t count)
+			{
+				SlabFree(ptr, count * sizeof(T));
+			}
+		};
+
+		template<typename T, typename U>
+		bool operator==(const SlabAllocator<T>&, const SlabAllocator<U>&)
+		{
+			return true;
+		}
+
+		template<typename T, typename U>
+		bool operator!=(const SlabAllocator<T>&, const SlabAllocator<U>&)
+		{
+			return false;
+		}
+	} // namespace Memory
+
 	namespace Text
 	{
 		bool CStrEq(const char* __restrict__ a, const char* __restrict__ b);
@@ -50,6 +283,15 @@ namespace Helpers
 		std::string::size_type StringStreamLength(std::ostringstream& sstream);
 		std::string HexTable(const void* ptr, const unsigned int num, const unsigned int voffset = 0U);
 		void PrintHexTable(const void* ptr, const unsigned int num, const unsigned int voffset = 0U);
+		// Arena overloads: results and their intermediate buffers live in the arena, so they make no malloc
+		// calls. Inputs are NUL-terminated, so both std::string and Memory::ArenaString can pass c_str().
+		Memory::ArenaString Stringf(Memory::Arena& arena, const char* __restrict__ const fmt, ...);
+		Memory::ArenaString StringReplace(Memory::Arena& arena, const char* str, const char* what, const char* with);
+		Memory::ArenaVector<Memory::ArenaString> StringSplit(Memory::Arena& arena, const char* str, const char* delim);
+		Memory::ArenaString HexTable(Memory::Arena& arena, const void* ptr, const unsigned int num, const unsigned int voffset = 0U);
+		// Streams the HexTable of a whole file to out, with the file offset (modulo 4 GiB, as voffset) on each
+		// row. Returns false when the file cannot be read.
+		bool HexTableFile(const std::string& path, std::ostream& out);
 	}
 
 	namespace Random
@@ -69,11 +311,573 @@ namespace Helpers
 
 	namespace Numeric
 	{
+		uint8_t BitReflect8(uint8_t val);
 		uint16_t BitReflect16(uint16_t val);
 		uint32_t BitReflect32(uint32_t val);
+		uint64_t BitReflect64(uint64_t val);
+		uint16_t ByteSwap16(uint16_t val);
+		uint32_t ByteSwap32(uint32_t val);
+		uint64_t ByteSwap64(uint64_t val);
+		// In-place bulk kernels; SSSE3/AVX2 paths are used when the compiler targets them.
+		void BitReflectBytes(void* data, const size_t dataSizeBytes);
+		void BitReflect16Array(uint16_t* data, const size_t count);
+		void BitReflect32Array(uint32_t* data, const size_t count);
+		void BitReflect64Array(uint64_t* data, const size_t count);
+		void ByteSwap16Array(uint16_t* data, const size_t count);
+		void ByteSwap32Array(uint32_t* data, const size_t count);
+		void ByteSwap64Array(uint64_t* data, const size_t count);
+		// Two digit conversions; use the 32/64 bit variants for wider packed BCD.
 		int BCDToDec(const int bcd);
 		int DecToBCD(const int dec);
+		// Packed BCD holds eight (32 bit) or sixteen (64 bit) digits; wider inputs keep only their low digits.
+		uint32_t BCDToDec32(uint32_t bcd);
+		uint32_t DecToBCD32(uint32_t dec);
+		uint64_t BCDToDec64(uint64_t bcd);
+		uint64_t DecToBCD64(uint64_t dec);
+		bool IsValidBCD32(const uint32_t bcd);
+		bool IsValidBCD64(const uint64_t bcd);
+		bool IsValidBCD(const void* data, const size_t dataSizeBytes);
+		// Bulk conversions return false when any input is out of range (the output is still written).
+		bool BCDToDec32Array(const uint32_t* bcd, uint32_t* dec, const size_t count);
+		bool BCDToDec64Array(const uint64_t* bcd, uint64_t* dec, const size_t count);
+		void DecToBCD32Array(const uint32_t* dec, uint32_t* bcd, const size_t count);
+		void DecToBCD64Array(const uint64_t* dec, uint64_t* bcd, const size_t count);
+		bool BCDToDecBytes(const uint8_t* bcd, uint8_t* dec, const size_t count);
+		bool DecToBCDBytes(const uint8_t* dec, uint8_t* bcd, const size_t count);
 		bool IsDoubleEqual(const double a, const double b, const double epsilon = 0.000001);
+		bool IsNearlyEqualAbs(const double a, const double b, const double absTolerance);
+		bool IsNearlyEqualAbs(const float a, const float b, const float absTolerance);
+		// Equal when a == b or |a - b| <= max(absTolerance, relTolerance * max(|a|, |b|)) for finite values;
+		// infinities are only equal to themselves and NaN never compares equal.
+		bool IsNearlyEqualRel(const double a, const double b, const double relTolerance, const double absTolerance = 0.0);
+		bool IsNearlyEqualRel(const float a, const float b, const float relTolerance, const float absTolerance = 0.0f);
+		// Number of representable values between a and b (+0 and -0 are equal); the maximum value when either is NaN.
+		uint64_t UlpDistance(const double a, const double b);
+		uint32_t UlpDistance(const float a, const float b);
+		bool IsNearlyEqualUlps(const double a, const double b, const uint64_t maxUlps);
+		bool IsNearlyEqualUlps(const float a, const float b, const uint64_t maxUlps);
+		// Array comparisons use the IsNearlyEqualRel rule element-wise and stop scanning at the first mismatch where possible.
+		bool AllClose(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance = 0.0);
+		bool AllClose(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance = 0.0f);
+		size_t CountMismatches(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance = 0.0);
+		size_t CountMismatches(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance = 0.0f);
+		// Returns count when every element matches.
+		size_t FirstMismatch(const double* a, const double* b, const size_t count, const double relTolerance, const double absTolerance = 0.0);
+		size_t FirstMismatch(const float* a, const float* b, const size_t count, const float relTolerance, const float absTolerance = 0.0f);
+
+		// Portable fallbacks for the bit functions below, also usable on their own in constant expressions.
+		constexpr int PopCountPortable(const unsigned long long x)
+		{
+			return (0ULL == x) ? 0 : 1 + PopCountPortable(x & (x - 1ULL));
+		}
+
+		constexpr int CountLeadingZerosPortable(const unsigned long long x, const int bits)
+		{
+			return (0 == bits) ? 0 : (((x >> (bits - 1)) & 1ULL) ? 0 : 1 + CountLeadingZerosPortable(x, bits - 1));
+		}
+
+		constexpr int CountTrailingZerosPortable(const unsigned long long x, const int bits)
+		{
+			return (0 == bits) ? 0 : ((x & 1ULL) ? 0 : 1 + CountTrailingZerosPortable(x >> 1, bits - 1));
+		}
+
+		template<typename T>
+		constexpr typename std::make_unsigned<T>::type ToUnsigned(const T x)
+		{
+			static_assert(std::is_integral<T>::value && !std::is_same<T, bool>::value, "integer type required");
+			return static_cast<typename std::make_unsigned<T>::type>(x);
+		}
+
+		template<typename T>
+		constexpr int BitWidth()
+		{
+			return std::numeric_limits<typename std::make_unsigned<T>::type>::digits;
+		}
+
+		template<typename T>
+		constexpr bool IsPowerOf2(const T x)
+		{
+			return (x > 0) && (0 == (x & (x - 1)));
+		}
+
+		template<typename T>
+		constexpr bool IsOdd(const T x)
+		{
+			return 0 != (ToUnsigned(x) & 1U);
+		}
+
+		template<typename T>
+		constexpr bool IsEven(const T x)
+		{
+			return 0 == (ToUnsigned(x) & 1U);
+		}
+
+		template<typename T>
+		constexpr int PopCount(const T x)
+		{
+#if defined(__GNUC__)
+			return __builtin_popcountll(static_cast<unsigned long long>(ToUnsigned(x)));
+#else
+			return PopCountPortable(static_cast<unsigned long long>(ToUnsigned(x)));
+#endif
+		}
+
+		// Returns the bit width of T for zero.
+		template<typename T>
+		constexpr int CountLeadingZeros(const T x)
+		{
+#if defined(__GNUC__)
+			return (0 == x) ? BitWidth<T>()
+				: __builtin_clzll(static_cast<unsigned long long>(ToUnsigned(x))) - (std::numeric_limits<unsigned long long>::digits - BitWidth<T>());
+#else
+			return CountLeadingZerosPortable(static_cast<unsigned long long>(ToUnsigned(x)), BitWidth<T>());
+#endif
+		}
+
+		// Returns the bit width of T for zero.
+		template<typename T>
+		constexpr int CountTrailingZeros(const T x)
+		{
+#if defined(__GNUC__)
+			return (0 == x) ? BitWidth<T>() : __builtin_ctzll(static_cast<unsigned long long>(ToUnsigned(x)));
+#else
+			return CountTrailingZerosPortable(static_cast<unsigned long long>(ToUnsigned(x)), BitWidth<T>());
+#endif
+		}
+
+		// Returns -1 for zero.
+		template<typename T>
+		constexpr int Log2Floor(const T x)
+		{
+			return BitWidth<T>() - 1 - CountLeadingZeros(x);
+		}
+
+		template<typename T>
+		constexpr int Log2Ceil(const T x)
+		{
+			return (ToUnsigned(x) <= 1U) ? 0 : Log2Floor(ToUnsigned(x) - 1U) + 1;
+		}
+
+		// Smallest power of two not less than x; zero when that does not fit in T.
+		template<typename T>
+		constexpr T NextPow2(const T x)
+		{
+			return (Log2Ceil(x) >= BitWidth<T>() - (std::is_signed<T>::value ? 1 : 0)) ? static_cast<T>(0)
+				: static_cast<T>(static_cast<typename std::make_unsigned<T>::type>(1U) << Log2Ceil(x));
+		}
+
+		// The alignment must be a power of two.
+		template<typename T>
+		constexpr T AlignUp(const T x, const T alignment)
+		{
+			return static_cast<T>((x + (alignment - 1)) & ~static_cast<T>(alignment - 1));
+		}
+
+		template<typename T>
+		constexpr T AlignDown(const T x, const T alignment)
+		{
+			return static_cast<T>(x & ~static_cast<T>(alignment - 1));
+		}
+
+		template<typename T>
+		constexpr bool IsAligned(const T x, const T alignment)
+		{
+			return 0 == (x & (alignment - 1));
+		}
+
+		template<typename T>
+		constexpr T RotateLeft(const T x, const unsigned int count)
+		{
+			static_assert(std::is_unsigned<T>::value, "unsigned type required");
+			return (0U == (count % BitWidth<T>())) ? x
+				: static_cast<T>((x << (count % BitWidth<T>())) | (x >> (BitWidth<T>() - (count % BitWidth<T>()))));
+		}
+
+		template<typename T>
+		constexpr T RotateRight(const T x, const unsigned int count)
+		{
+			static_assert(std::is_unsigned<T>::value, "unsigned type required");
+			return (0U == (count % BitWidth<T>())) ? x
+				: static_cast<T>((x >> (count % BitWidth<T>())) | (x << (BitWidth<T>() - (count % BitWidth<T>()))));
+		}
+
+		// Mask of the low `length` bits; length may equal the width of T.
+		template<typename T>
+		constexpr T LowBitMask(const unsigned int length)
+		{
+			static_assert(std::is_unsigned<T>::value, "unsigned type required");
+			return (length >= static_cast<unsigned int>(BitWidth<T>())) ? static_cast<T>(~static_cast<T>(0))
+				: static_cast<T>((static_cast<T>(1U) << length) - 1U);
+		}
+
+		// A position at or past the width of T selects no bits: extracting gives 0 and depositing leaves x as is.
+		template<typename T>
+		constexpr T ExtractBits(const T x, const unsigned int position, const unsigned int length)
+		{
+			return (position >= static_cast<unsigned int>(BitWidth<T>())) ? static_cast<T>(0)
+				: static_cast<T>((x >> position) & LowBitMask<T>(length));
+		}
+
+		template<typename T>
+		constexpr T DepositBits(const T x, const T field, const unsigned int position, const unsigned int length)
+		{
+			return (position >= static_cast<unsigned int>(BitWidth<T>())) ? x
+				: static_cast<T>((x & ~static_cast<T>(LowBitMask<T>(length) << position)) | ((field & LowBitMask<T>(length)) << position));
+		}
+
+		// Gathers the bits of x selected by mask into the low bits of the result (BMI2 pext).
+		template<typename T>
+		inline T ParallelExtract(T x, T mask)
+		{
+			static_assert(std::is_unsigned<T>::value && sizeof(T) <= sizeof(uint64_t), "unsigned type of at most 64 bits required");
+#if defined(__BMI2__) && defined(__x86_64__)
+			return (sizeof(T) <= sizeof(uint32_t)) ? static_cast<T>(_pext_u32(static_cast<uint32_t>(x), static_cast<uint32_t>(mask)))
+				: static_cast<T>(_pext_u64(static_cast<uint64_t>(x), static_cast<uint64_t>(mask)));
+#else
+			T result = 0U;
+			for(T bit = 1U; 0U != mask; bit = static_cast<T>(bit << 1))
+			{
+				if(x & mask & static_cast<T>(~mask + 1U))
+				{
+					result |= bit;
+				}
+				mask &= static_cast<T>(mask - 1U);
+			}
+			return result;
+#endif
+		}
+
+		// Scatters the low bits of x to the positions selected by mask (BMI2 pdep).
+		template<typename T>
+		inline T ParallelDeposit(T x, T mask)
+		{
+			static_assert(std::is_unsigned<T>::value && sizeof(T) <= sizeof(uint64_t), "unsigned type of at most 64 bits required");
+#if defined(__BMI2__) && defined(__x86_64__)
+			return (sizeof(T) <= sizeof(uint32_t)) ? static_cast<T>(_pdep_u32(static_cast<uint32_t>(x), static_cast<uint32_t>(mask)))
+				: static_cast<T>(_pdep_u64(static_cast<uint64_t>(x), static_cast<uint64_t>(mask)));
+#else
+			T result = 0U;
+			for(T bit = 1U; 0U != mask; bit = static_cast<T>(bit << 1))
+			{
+				if(x & bit)
+				{
+					result |= static_cast<T>(mask & (~mask + 1U));
+				}
+				mask &= static_cast<T>(mask - 1U);
+			}
+			return result;
+#endif
+		}
+
+		// Intermediate types used by Fixed for products, quotients and sums.
+		template<typename Storage> struct FixedWiden;
+		template<> struct FixedWiden<int8_t> { typedef int16_t Type; typedef int16_t SignedType; typedef int64_t AccumulatorType; };
+		template<> struct FixedWiden<uint8_t> { typedef uint16_t Type; typedef int16_t SignedType; typedef int64_t AccumulatorType; };
+		template<> struct FixedWiden<int16_t> { typedef int32_t Type; typedef int32_t SignedType; typedef int64_t AccumulatorType; };
+		template<> struct FixedWiden<uint16_t> { typedef uint32_t Type; typedef int32_t SignedType; typedef int64_t AccumulatorType; };
+#if defined(__SIZEOF_INT128__)
+		__extension__ typedef __int128 Int128;
+		__extension__ typedef unsigned __int128 UInt128;
+		template<> struct FixedWiden<int32_t> { typedef int64_t Type; typedef int64_t SignedType; typedef Int128 AccumulatorType; };
+		template<> struct FixedWiden<uint32_t> { typedef uint64_t Type; typedef int64_t SignedType; typedef Int128 AccumulatorType; };
+		template<> struct FixedWiden<int64_t> { typedef Int128 Type; typedef Int128 SignedType; typedef Int128 AccumulatorType; };
+		template<> struct FixedWiden<uint64_t> { typedef UInt128 Type; typedef Int128 SignedType; typedef Int128 AccumulatorType; };
+#else
+		template<> struct FixedWiden<int32_t> { typedef int64_t Type; typedef int64_t SignedType; typedef int64_t AccumulatorType; };
+		template<> struct FixedWiden<uint32_t> { typedef uint64_t Type; typedef int64_t SignedType; typedef int64_t AccumulatorType; };
+#endif
+
+		constexpr double Pow2(const int exponent)
+		{
+			return (exponent < 0) ? 1.0 / Pow2(-exponent) : ((0 == exponent) ? 1.0 : 2.0 * Pow2(exponent - 1));
+		}
+
+		/*
+			Fixed - binary fixed-point number with IntBits integer and FracBits fraction bits (plus a sign bit
+			when Storage is signed). The operators saturate at the format limits; the Wrapping* functions wrap
+			modulo the format width instead. Products round to nearest, quotients truncate toward zero and
+			division by zero saturates, so results are bit-identical on every platform.
+		*/
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage = int32_t>
+		class Fixed
+		{
+			static_assert(std::is_integral<Storage>::value, "integer storage required");
+			static_assert(IntBits + FracBits <= static_cast<unsigned int>(std::numeric_limits<Storage>::digits), "format does not fit the storage type");
+
+		public:
+			typedef Storage StorageType;
+			typedef typename FixedWiden<Storage>::Type WideType;
+			typedef typename FixedWiden<Storage>::SignedType SignedWideType;
+			typedef typename FixedWiden<Storage>::AccumulatorType AccumulatorType;
+
+			static constexpr unsigned int IntegerBits() { return IntBits; }
+			static constexpr unsigned int FractionBits() { return FracBits; }
+
+			static constexpr Storage RawMax()
+			{
+				return (IntBits + FracBits == static_cast<unsigned int>(std::numeric_limits<Storage>::digits)) ? std::numeric_limits<Storage>::max()
+					: static_cast<Storage>((static_cast<Storage>(1) << (IntBits + FracBits)) - 1);
+			}
+
+			static constexpr Storage RawMin()
+			{
+				return std::is_signed<Storage>::value ? static_cast<Storage>(-RawMax() - 1) : static_cast<Storage>(0);
+			}
+
+			constexpr Fixed() : m_raw(0) {}
+
+			static constexpr Fixed FromRaw(const Storage raw)
+			{
+				return Fixed(raw, RawTag());
+			}
+
+			static constexpr Fixed Max() { return FromRaw(RawMax()); }
+			static constexpr Fixed Min() { return FromRaw(RawMin()); }
+			static constexpr Fixed Epsilon() { return FromRaw(1); }
+
+			static Fixed FromInt(const long long value)
+			{
+				// Compared as unsigned: the limit of 64 bit unsigned storage does not fit in a long long.
+				const unsigned long long limit = (FracBits >= static_cast<unsigned int>(std::numeric_limits<Storage>::digits)) ? 0ULL
+					: static_cast<unsigned long long>(RawMax() >> (FracBits % std::numeric_limits<Storage>::digits));
+				if(value >= 0LL && static_cast<unsigned long long>(value) > limit)
+				{
+					return Max();
+				}
+				if(value < 0LL && (!std::is_signed<Storage>::value || static_cast<unsigned long long>(-(value + 1LL)) > limit))
+				{
+					return Min();
+				}
+				return FromRaw(static_cast<Storage>(static_cast<WideType>(value) * (static_cast<WideType>(1) << FracBits)));
+			}
+
+			// Rounds to nearest (ties away from zero) and saturates; NaN converts to zero.
+			static Fixed FromDouble(const double value)
+			{
+				const double scaled = value * Pow2(static_cast<int>(FracBits));
+				if(scaled != scaled)
+				{
+					return Fixed();
+				}
+				if(scaled >= static_cast<double>(RawMax()))
+				{
+					return Max();
+				}
+				if(scaled <= static_cast<double>(RawMin()))
+				{
+					return Min();
+				}
+				return FromRaw(static_cast<Storage>((scaled < 0.0) ? scaled - 0.5 : scaled + 0.5));
+			}
+
+			constexpr Storage Raw() const { return m_raw; }
+			constexpr double ToDouble() const { return static_cast<double>(m_raw) * Pow2(-static_cast<int>(FracBits)); }
+			constexpr float ToFloat() const { return static_cast<float>(ToDouble()); }
+
+			// Rounds toward negative infinity.
+			constexpr long long ToInt() const
+			{
+				return static_cast<long long>(static_cast<SignedWideType>(m_raw) >> FracBits);
+			}
+
+			static Fixed SaturatingAdd(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Saturate(static_cast<SignedWideType>(a.m_raw) + static_cast<SignedWideType>(b.m_raw)));
+			}
+
+			static Fixed SaturatingSub(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Saturate(static_cast<SignedWideType>(a.m_raw) - static_cast<SignedWideType>(b.m_raw)));
+			}
+
+			static Fixed SaturatingMul(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Saturate(Product(a, b)));
+			}
+
+			static Fixed SaturatingDiv(const Fixed a, const Fixed b)
+			{
+				if(0 == b.m_raw)
+				{
+					return DivideByZero(a);
+				}
+				return FromRaw(Saturate(Quotient(a, b)));
+			}
+
+			static Fixed WrappingAdd(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Wrap(static_cast<SignedWideType>(a.m_raw) + static_cast<SignedWideType>(b.m_raw)));
+			}
+
+			static Fixed WrappingSub(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Wrap(static_cast<SignedWideType>(a.m_raw) - static_cast<SignedWideType>(b.m_raw)));
+			}
+
+			static Fixed WrappingMul(const Fixed a, const Fixed b)
+			{
+				return FromRaw(Wrap(Product(a, b)));
+			}
+
+			static Fixed WrappingDiv(const Fixed a, const Fixed b)
+			{
+				if(0 == b.m_raw)
+				{
+					return DivideByZero(a);
+				}
+				return FromRaw(Wrap(Quotient(a, b)));
+			}
+
+			// Clamps a raw value of any integer width to the format limits.
+			template<typename W>
+			static Storage Saturate(const W wide)
+			{
+				return (wide > static_cast<W>(RawMax())) ? RawMax() : ((wide < static_cast<W>(RawMin())) ? RawMin() : static_cast<Storage>(wide));
+			}
+
+			// Reduces a raw value of any integer width modulo the format width.
+			template<typename W>
+			static Storage Wrap(const W wide)
+			{
+				const WideType mask = static_cast<WideType>(RawMax()) | (std::is_signed<Storage>::value ? static_cast<WideType>(RawMax()) + 1 : 0);
+				const WideType bits = static_cast<WideType>(wide) & mask;
+				return (std::is_signed<Storage>::value && bits > static_cast<WideType>(RawMax()))
+					? static_cast<Storage>(static_cast<SignedWideType>(bits) - static_cast<SignedWideType>(mask) - 1)
+					: static_cast<Storage>(bits);
+			}
+
+			Fixed operator+(const Fixed other) const { return SaturatingAdd(*this, other); }
+			Fixed operator-(const Fixed other) const { return SaturatingSub(*this, other); }
+			Fixed operator*(const Fixed other) const { return SaturatingMul(*this, other); }
+			Fixed operator/(const Fixed other) const { return SaturatingDiv(*this, other); }
+			Fixed operator-() const { return SaturatingSub(Fixed(), *this); }
+			Fixed& operator+=(const Fixed other) { return *this = *this + other; }
+			Fixed& operator-=(const Fixed other) { return *this = *this - other; }
+			Fixed& operator*=(const Fixed other) { return *this = *this * other; }
+			Fixed& operator/=(const Fixed other) { return *this = *this / other; }
+			constexpr bool operator==(const Fixed other) const { return m_raw == other.m_raw; }
+			constexpr bool operator!=(const Fixed other) const { return m_raw != other.m_raw; }
+			constexpr bool operator<(const Fixed other) const { return m_raw < other.m_raw; }
+			constexpr bool operator<=(const Fixed other) const { return m_raw <= other.m_raw; }
+			constexpr bool operator>(const Fixed other) const { return m_raw > other.m_raw; }
+			constexpr bool operator>=(const Fixed other) const { return m_raw >= other.m_raw; }
+
+		private:
+			struct RawTag {};
+
+			constexpr Fixed(const Storage raw, RawTag) : m_raw(raw) {}
+
+			static WideType Product(const Fixed a, const Fixed b)
+			{
+				const WideType product = static_cast<WideType>(a.m_raw) * static_cast<WideType>(b.m_raw);
+				return (0U == FracBits) ? product : ((product + (static_cast<WideType>(1) << (FracBits - (FracBits ? 1U : 0U)))) >> FracBits);
+			}
+
+			// Division by zero saturates toward the sign of the dividend; unsigned formats have no negative side.
+			static Fixed DivideByZero(const Fixed a)
+			{
+				return IsNegative(a.m_raw, std::is_signed<Storage>()) ? Min() : Max();
+			}
+
+			static bool IsNegative(const Storage raw, std::true_type)
+			{
+				return raw < 0;
+			}
+
+			static bool IsNegative(const Storage, std::false_type)
+			{
+				return false;
+			}
+
+			static WideType Quotient(const Fixed a, const Fixed b)
+			{
+				return (static_cast<WideType>(a.m_raw) * (static_cast<WideType>(1) << FracBits)) / static_cast<WideType>(b.m_raw);
+			}
+
+		private:
+			Storage m_raw;
+		};
+
+		typedef Fixed<7, 8, int16_t> Q7_8;
+		typedef Fixed<0, 15, int16_t> Q0_15;
+		typedef Fixed<15, 16, int32_t> Q15_16;
+		typedef Fixed<0, 31, int32_t> Q0_31;
+
+		// Element-wise saturating kernels; the loops are branch-free so compilers can vectorize them.
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedAddArray(const Fixed<IntBits, FracBits, Storage>* a, const Fixed<IntBits, FracBits, Storage>* b,
+			Fixed<IntBits, FracBits, Storage>* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = Fixed<IntBits, FracBits, Storage>::SaturatingAdd(a[index], b[index]);
+			}
+		}
+
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedSubArray(const Fixed<IntBits, FracBits, Storage>* a, const Fixed<IntBits, FracBits, Storage>* b,
+			Fixed<IntBits, FracBits, Storage>* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = Fixed<IntBits, FracBits, Storage>::SaturatingSub(a[index], b[index]);
+			}
+		}
+
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedMulArray(const Fixed<IntBits, FracBits, Storage>* a, const Fixed<IntBits, FracBits, Storage>* b,
+			Fixed<IntBits, FracBits, Storage>* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = Fixed<IntBits, FracBits, Storage>::SaturatingMul(a[index], b[index]);
+			}
+		}
+
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedScaleArray(const Fixed<IntBits, FracBits, Storage>* in, const Fixed<IntBits, FracBits, Storage> scale,
+			Fixed<IntBits, FracBits, Storage>* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = Fixed<IntBits, FracBits, Storage>::SaturatingMul(in[index], scale);
+			}
+		}
+
+		// Sums the exact products in AccumulatorType and rounds once at the end, as a DSP MAC unit would.
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		Fixed<IntBits, FracBits, Storage> FixedDot(const Fixed<IntBits, FracBits, Storage>* a, const Fixed<IntBits, FracBits, Storage>* b, const size_t count)
+		{
+			typedef typename Fixed<IntBits, FracBits, Storage>::AccumulatorType Accumulator;
+			Accumulator sum = 0;
+			for(size_t index = 0; index < count; index++)
+			{
+				sum += static_cast<Accumulator>(a[index].Raw()) * static_cast<Accumulator>(b[index].Raw());
+			}
+			if(FracBits > 0U)
+			{
+				sum = (sum + (static_cast<Accumulator>(1) << (FracBits - (FracBits ? 1U : 0U)))) >> FracBits;
+			}
+			return Fixed<IntBits, FracBits, Storage>::FromRaw(Fixed<IntBits, FracBits, Storage>::Saturate(sum));
+		}
+
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedFromDoubleArray(const double* in, Fixed<IntBits, FracBits, Storage>* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = Fixed<IntBits, FracBits, Storage>::FromDouble(in[index]);
+			}
+		}
+
+		template<unsigned int IntBits, unsigned int FracBits, typename Storage>
+		void FixedToDoubleArray(const Fixed<IntBits, FracBits, Storage>* in, double* out, const size_t count)
+		{
+			for(size_t index = 0; index < count; index++)
+			{
+				out[index] = in[index].ToDouble();
+			}
+		}
 	} // namespace Numeric
 
 	namespace Checksum
@@ -82,6 +886,8 @@ namespace Helpers
 		{
 			uint32_t Calculate(const void* data, const size_t dataSizeBytes, const uint32_t polynomial = CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
 			uint32_t Recalculate(uint32_t crc, const void* data, const size_t dataSizeBytes, const uint32_t polynomial = CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+			// CRC of a whole file without reading it into memory first; returns false when it cannot be read.
+			bool CalculateFile(const std::string& path, uint32_t& crc, const uint32_t polynomial = CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
 		}
 		namespace CRC16
 		{
@@ -92,6 +898,17 @@ namespace Helpers
 
 	namespace Time
 	{
+		// Nanos() is monotonic nanoseconds since the clock was first used, read from the invariant TSC when the
+		// kernel trusts it and from the vDSO CLOCK_MONOTONIC otherwise. Micros(), Millis() and Stopwatch use it.
+		// The first use estimates the TSC rate over about 100 us; reads over the following ten seconds refine it
+		// against CLOCK_MONOTONIC, so no caller has to wait out a long calibration.
+		long long Nanos();
+		// Raw timestamps for the hot path (TSC cycles, or nanoseconds without a reliable TSC); convert
+		// differences with TicksToNanos().
+		unsigned long long Ticks();
+		long long TicksToNanos(const unsigned long long ticks);
+		double TicksPerSecond();
+		bool IsTscClock();
 		long long Micros();
 		long long Millis();
 		double Seconds();
@@ -99,9 +916,17 @@ namespace Helpers
 		double MillisToSeconds(long long millis);
 		long long SecondsToMicros(double seconds);
 		long long SecondsToMillis(double seconds);
+		// Waits sleep on the monotonic clock until a short spin window before the deadline and then spin,
+		// keeping microsecond accuracy without holding a core for the whole interval.
 		void WaitSeconds(double seconds);
 		void WaitMillis(long long millis);
 		void WaitMicros(long long micros);
+		void WaitNanos(long long nanos);
+		// The spin window is calibrated from measured wakeup latency on the first wait; calling
+		// CalibrateWaitSpin() at startup moves that one-off cost (a few milliseconds) out of the hot path.
+		long long CalibrateWaitSpin();
+		long long GetWaitSpinNanos();
+		void SetWaitSpinNanos(const long long nanos);
 
 		class Stopwatch
 		{
@@ -181,38 +1006,2545 @@ namespace Helpers
 		private:
 			long long m_beganAt;
 		};
-	}
 
-	namespace Threading
-	{
-		class Timer
+		/*
+			LatencyHistogram - HDR style log-linear histogram of non-negative values in any unit. Each power of
+			two is split into 2^(subBucketBits - 1) linear buckets, so a reported value is within a relative
+			2^(1 - subBucketBits) of the recorded one. Recording is constant time and lock-free; keep one
+			instance per thread on hot paths and Merge() them for reporting.
+		*/
+		class LatencyHistogram
 		{
 		public:
-			typedef std::function<bool(Timer*, void*)> TimerUserFunc;
-
-		public:
-			explicit Timer();
-			~Timer();
-			void Begin(const unsigned int intervalMillisecs, TimerUserFunc userFunc, void* userArg = nullptr);
-			void End();
-			bool Running();
+			explicit LatencyHistogram(const unsigned int subBucketBits = 8U);
+			LatencyHistogram(const LatencyHistogram& other);
+			~LatencyHistogram() {}
+			void Record(const long long value);
+			void Record(const long long value, const unsigned long long count);
+			// Records the stopwatch's elapsed time in nanoseconds (at its microsecond resolution).
+			void RecordElapsed(const Stopwatch& stopwatch);
+			void Merge(const LatencyHistogram& other);
+			void Reset();
+			unsigned long long Count() const;
+			long long Min() const;
+			long long Max() const;
+			double Mean() const;
+			long long Percentile(const double percentile) const;
+			unsigned int SubBucketBits() const;
+			std::string ToString(const char* unit = "ns") const;
+			std::string ToJson() const;
 
 		private:
-			bool WasStopRequested() const;
-			static void InternalTimerFunc(Timer* timer);
+			LatencyHistogram& operator=(const LatencyHistogram&);
+			size_t BucketIndex(const unsigned long long value) const;
+			long long BucketUpperBound(const size_t index) const;
 
 		private:
-			std::atomic_bool m_stopRequested;
-			std::atomic_bool m_started;
+			unsigned int m_subBucketBits;
+			size_t m_bucketCount;
+			std::unique_ptr<std::atomic<unsigned long long>[]> m_counts;
+			std::atomic<unsigned long long> m_totalCount;
+			std::atomic<long long> m_sum;
+			std::atomic<long long> m_min;
+			std::atomic<long long> m_max;
+		};
+
+		// Records the lifetime of the scope into a histogram in nanoseconds.
+		class ScopedLatency
+		{
+		public:
+			explicit ScopedLatency(LatencyHistogram& histogram) : m_histogram(histogram), m_beganTicks(Ticks()) {}
+			~ScopedLatency();
+
+		private:
+			ScopedLatency(const ScopedLatency&);
+			ScopedLatency& operator=(const ScopedLatency&);
+
+		private:
+			LatencyHistogram& m_histogram;
+			unsigned long long m_beganTicks;
+		};
+
+		// Span tracing: each thread records into its own fixed-size ring (a full ring drops new spans and counts
+		// them) and DrainTraceJson() collects every ring as Chrome/Perfetto trace-event JSON. Recording is off
+		// until SetTraceEnabled(true); span names are stored by pointer and must outlive the drain.
+		void SetTraceEnabled(const bool enabled);
+		bool IsTraceEnabled();
+		// Applies to rings created afterwards, rounded up to a power of two.
+		void SetTraceBufferCapacity(const size_t events);
+		void RecordTraceSpan(const char* name, const unsigned long long beganTicks, const unsigned long long endedTicks);
+		std::string DrainTraceJson();
+		unsigned long long TraceDroppedCount();
+
+		class TraceScope
+		{
+		public:
+			explicit TraceScope(const char* name) :
+				m_name(name),
+				m_enabled(IsTraceEnabled()),
+				m_beganTicks(m_enabled ? Ticks() : 0ULL)
+			{
+			}
+
+			~TraceScope()
+			{
+				if(m_enabled)
+				{
+					RecordTraceSpan(m_name, m_beganTicks, Ticks());
+				}
+			}
+
+		private:
+			TraceScope(const TraceScope&);
+			TraceScope& operator=(const TraceScope&);
+
+		private:
+			const char* m_name;
+			bool m_enabled;
+			unsigned long long m_beganTicks;
+		};
+
+		/*
+			CoarseClock - cached monotonic time on the Nanos() epoch for TTL checks and log timestamps. In Thread
+			mode a background thread publishes Nanos() every tick and reads are a single relaxed load; in Kernel
+			mode reads come from CLOCK_MONOTONIC_COARSE (Linux only, other platforms fall back to Thread). Values
+			never go backwards and lag ReferenceNanos() by at most MaxStalenessNanos(). The reference is Nanos()
+			in Thread mode and CLOCK_MONOTONIC, shifted to the Nanos() epoch, in Kernel mode; the two differ by the
+			TSC calibration error, so a Kernel mode value can be slightly ahead of Nanos().
+		*/
+		class CoarseClock
+		{
+		public:
+			enum class Source
+			{
+				Thread,
+				Kernel
+			};
+
+		public:
+			explicit CoarseClock(const long long tickMicros = 1000LL, const Source source = Source::Thread);
+			~CoarseClock();
+
+			long long Nanos() const
+			{
+				return (Source::Thread == m_source) ? m_nanos.load(std::memory_order_relaxed) : KernelNanos();
+			}
+
+			long long Micros() const
+			{
+				return Nanos() / 1000LL;
+			}
+
+			long long Millis() const
+			{
+				return Nanos() / 1000000LL;
+			}
+
+			// The precise clock this one trails; reading it costs as much as Nanos().
+			long long ReferenceNanos() const;
+			// Publishes the current time immediately, e.g. after waking from a long block.
+			void Refresh();
+			Source GetSource() const;
+			long long TickNanos() const;
+			// The tick (or kernel clock resolution), or the longest gap between updates observed so far if larger.
+			long long MaxStalenessNanos() const;
+			// Shared 1 ms thread-driven clock, started on first use.
+			static CoarseClock& Global();
+
+		private:
+			CoarseClock(const CoarseClock&);
+			CoarseClock& operator=(const CoarseClock&);
+			long long KernelNanos() const;
+			void Publish(const long long nanos);
+			static void InternalUpdateFunc(CoarseClock* clock);
+
+		private:
+			Source m_source;
+			long long m_tickNanos;
+			std::atomic<long long> m_nanos;
+			std::atomic<long long> m_maxGapNanos;
+			bool m_stopRequested;
+			std::mutex m_updateMutex;
+			std::condition_variable m_updateStopCond;
+			std::unique_ptr<std::thread> m_updateThread;
+		};
+	}
+
+	namespace Threading
+	{
+		// Spin-wait hint for busy loops.
+		inline void CpuRelax()
+		{
+#if defined(__x86_64__) || defined(__i386__)
+			__builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+			__asm__ __volatile__("yield");
+#endif
+		}
+
+		// Address-keyed wait/wake: FutexWait blocks while word still holds expected, until a FutexWake on the same
+		// word, a spurious wakeup or the timeout (returns false). Linux uses the futex syscall; other platforms a
+		// hashed table of mutex/condition variable buckets, which always wakes every waiter of a bucket.
+		bool FutexWait(std::atomic<unsigned int>& word, const unsigned int expected, const long long timeoutMicros = -1LL);
+		void FutexWake(std::atomic<unsigned int>& word, const int count);
+		void FutexWakeAll(std::atomic<unsigned int>& word);
+
+		// Placement and scheduling for a library thread. Empty or negative fields leave the inherited setting alone;
+		// a NUMA node without CPUs also pins the thread to that node's CPUs.
+		struct ThreadConfig
+		{
+			enum class Policy
+			{
+				Default,
+				Fifo,
+				RoundRobin
+			};
+
+			std::vector<int> cpus;
+			int numaNode;
+			Policy policy;
+			// 1..99 for Fifo and RoundRobin.
+			int priority;
+			// Truncated to 15 characters on Linux.
+			std::string name;
+
+			ThreadConfig() :
+				cpus(),
+				numaNode(-1),
+				policy(Policy::Default),
+				priority(0),
+				name()
+			{
+			}
+		};
+
+		// Applies config to the calling thread. Every part is attempted; returns false when any of them failed,
+		// e.g. a real-time policy without CAP_SYS_NICE or a platform without affinity support.
+		bool ApplyThreadConfig(const ThreadConfig& config);
+		std::string CurrentThreadName();
+		// CPU the calling thread is running on, or -1 when unknown.
+		int CurrentCpu();
+
+		// Online CPUs with their core, package and NUMA node, read from /sys/devices/system on Linux. Elsewhere
+		// every hardware thread is reported as its own core on node 0.
+		struct CpuTopology
+		{
+			struct Cpu
+			{
+				int id;
+				int core;
+				int package;
+				int numaNode;
+				// SMT siblings sharing the core, including this CPU.
+				std::vector<int> siblings;
+			};
+
+			std::vector<Cpu> cpus;
+
+			int PhysicalCoreCount() const;
+			int NumaNodeCount() const;
+			std::vector<int> CpusOfNode(const int numaNode) const;
+			// First SMT sibling of every core, optionally restricted to one node (-1 = all nodes).
+			std::vector<int> OnePerCore(const int numaNode = -1) const;
+			static CpuTopology Query();
+		};
+
+		// Exponential backoff for spin loops: 1, 2, 4 ... 64 pauses, then yields the CPU so a preempted lock
+		// holder can run.
+		class Backoff
+		{
+		public:
+			Backoff() :
+				m_step(0U)
+			{
+			}
+
+			void Pause()
+			{
+				if(m_step <= 6U)
+				{
+					for(unsigned int i = 0U; i < (1U << m_step); i++)
+					{
+						CpuRelax();
+					}
+					m_step++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+
+			bool Spinning() const
+			{
+				return m_step <= 6U;
+			}
+
+		private:
+			unsigned int m_step;
+		};
+
+		/*
+			Lock primitives for short critical sections. All of them are BasicLockable (lock, unlock) and
+			Lockable (try_lock), so they work with std::lock_guard and std::unique_lock but not with
+			std::condition_variable, which requires std::mutex.
+		*/
+
+		// Spins with backoff while the lock looks about to be released, then parks on a futex. Uncontended lock and
+		// unlock are a single atomic each; unlock only makes a syscall when a waiter is parked.
+		class AdaptiveMutex
+		{
+		public:
+			AdaptiveMutex() :
+				m_state(0U)
+			{
+			}
+
+			void lock()
+			{
+				unsigned int expected = 0U;
+				if(!m_state.compare_exchange_strong(expected, 1U, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					LockSlow();
+				}
+			}
+
+			bool try_lock()
+			{
+				unsigned int expected = 0U;
+				return m_state.compare_exchange_strong(expected, 1U, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+			void unlock()
+			{
+				if(2U == m_state.exchange(0U, std::memory_order_release))
+				{
+					FutexWake(m_state, 1);
+				}
+			}
+
+		private:
+			AdaptiveMutex(const AdaptiveMutex&);
+			AdaptiveMutex& operator=(const AdaptiveMutex&);
+			void LockSlow();
+
+		private:
+			// 0 unlocked, 1 locked, 2 locked with (possibly) parked waiters.
+			std::atomic<unsigned int> m_state;
+		};
+
+		// FIFO-fair spinlock: threads acquire in the order they called lock().
+		class TicketLock
+		{
+		public:
+			TicketLock() :
+				m_next(0U),
+				m_serving(0U)
+			{
+			}
+
+			void lock()
+			{
+				const unsigned int ticket = m_next.fetch_add(1U, std::memory_order_relaxed);
+				if(m_serving.load(std::memory_order_acquire) != ticket)
+				{
+					WaitForTurn(ticket);
+				}
+			}
+
+			bool try_lock()
+			{
+				unsigned int serving = m_serving.load(std::memory_order_relaxed);
+				return m_next.compare_exchange_strong(serving, serving + 1U, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+			void unlock()
+			{
+				m_serving.store(m_serving.load(std::memory_order_relaxed) + 1U, std::memory_order_release);
+			}
+
+		private:
+			TicketLock(const TicketLock&);
+			TicketLock& operator=(const TicketLock&);
+			void WaitForTurn(const unsigned int ticket);
+
+		private:
+			std::atomic<unsigned int> m_next;
+			std::atomic<unsigned int> m_serving;
+		};
+
+		// Reader-writer spinlock with writer preference: a waiting writer stops new readers from entering.
+		// Also SharedLockable (lock_shared, try_lock_shared, unlock_shared).
+		class RWSpinLock
+		{
+		public:
+			RWSpinLock() :
+				m_state(0U)
+			{
+			}
+
+			void lock();
+			bool try_lock()
+			{
+				unsigned int expected = 0U;
+				return m_state.compare_exchange_strong(expected, Writer, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+			void unlock()
+			{
+				m_state.fetch_and(~Writer, std::memory_order_release);
+			}
+
+			void lock_shared();
+			bool try_lock_shared()
+			{
+				unsigned int state = m_state.load(std::memory_order_relaxed);
+				return 0U == (state & (Writer | WriterPending)) &&
+					m_state.compare_exchange_strong(state, state + Reader, std::memory_order_acquire, std::memory_order_relaxed);
+			}
+
+			void unlock_shared()
+			{
+				m_state.fetch_sub(Reader, std::memory_order_release);
+			}
+
+		private:
+			static const unsigned int Writer = 1U;
+			static const unsigned int WriterPending = 2U;
+			static const unsigned int Reader = 4U;
+
+			RWSpinLock(const RWSpinLock&);
+			RWSpinLock& operator=(const RWSpinLock&);
+
+		private:
+			std::atomic<unsigned int> m_state;
+		};
+
+		/*
+			SeqLock - read-mostly snapshot of a trivially copyable T. Readers never block writers and never write
+			shared memory: they copy the value and retry when a write overlapped. The value is kept in relaxed
+			atomic words so the racy copy is well defined. lock() and unlock() exclude concurrent writers.
+		*/
+		template<typename T>
+		class SeqLock
+		{
+			static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+		public:
+			SeqLock() :
+				m_sequence(0U)
+			{
+				Write(T());
+			}
+
+			explicit SeqLock(const T& value) :
+				m_sequence(0U)
+			{
+				Write(value);
+			}
+
+			T Load() const
+			{
+				Backoff backoff;
+				while(true)
+				{
+					const unsigned int before = m_sequence.load(std::memory_order_acquire);
+					if(0U == (before & 1U))
+					{
+						T value = Read();
+						std::atomic_thread_fence(std::memory_order_acquire);
+						if(m_sequence.load(std::memory_order_relaxed) == before)
+						{
+							return value;
+						}
+					}
+					backoff.Pause();
+				}
+			}
+
+			void Store(const T& value)
+			{
+				lock();
+				Write(value);
+				unlock();
+			}
+
+			// Read-modify-write under the writer lock; func receives a T&.
+			template<typename F>
+			void Update(F func)
+			{
+				lock();
+				T value = Read();
+				func(value);
+				Write(value);
+				unlock();
+			}
+
+			// Makes the sequence odd, so readers retry until unlock().
+			void lock()
+			{
+				Backoff backoff;
+				unsigned int sequence = m_sequence.load(std::memory_order_relaxed);
+				while((sequence & 1U) || !m_sequence.compare_exchange_weak(sequence, sequence + 1U, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					backoff.Pause();
+					sequence = m_sequence.load(std::memory_order_relaxed);
+				}
+				// Keeps the data stores after the odd sequence.
+				std::atomic_thread_fence(std::memory_order_release);
+			}
+
+			bool try_lock()
+			{
+				unsigned int sequence = m_sequence.load(std::memory_order_relaxed);
+				if((sequence & 1U) || !m_sequence.compare_exchange_strong(sequence, sequence + 1U, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					return false;
+				}
+				std::atomic_thread_fence(std::memory_order_release);
+				return true;
+			}
+
+			void unlock()
+			{
+				m_sequence.fetch_add(1U, std::memory_order_release);
+			}
+
+			// Number of completed writes.
+			unsigned int Version() const
+			{
+				return m_sequence.load(std::memory_order_acquire) / 2U;
+			}
+
+		private:
+			static const size_t WordCount = (sizeof(T) + sizeof(unsigned long long) - 1U) / sizeof(unsigned long long);
+
+			SeqLock(const SeqLock&);
+			SeqLock& operator=(const SeqLock&);
+
+			T Read() const
+			{
+				unsigned long long words[WordCount];
+				for(size_t i = 0U; i < WordCount; i++)
+				{
+					words[i] = m_words[i].load(std::memory_order_relaxed);
+				}
+				T value;
+				memcpy(&value, words, sizeof(T));
+				return value;
+			}
+
+			void Write(const T& value)
+			{
+				unsigned long long words[WordCount] = {};
+				memcpy(words, &value, sizeof(T));
+				for(size_t i = 0U; i < WordCount; i++)
+				{
+					m_words[i].store(words[i], std::memory_order_relaxed);
+				}
+			}
+
+		private:
+			std::atomic<unsigned int> m_sequence;
+			std::atomic<unsigned long long> m_words[WordCount];
+		};
+
+		/*
+			Blocking primitives built on FutexWait/FutexWake. Waits spin briefly before parking (not on single-CPU
+			hosts), and the signalling side only makes a wake syscall when someone is parked. Timeouts are in
+			microseconds; a negative timeout waits forever and the timed waits return false when they expire.
+		*/
+
+		// AutoReset releases one waiter per Set and clears itself; ManualReset stays set, releasing everyone,
+		// until Reset.
+		class Event
+		{
+		public:
+			enum class Mode
+			{
+				AutoReset,
+				ManualReset
+			};
+
+			explicit Event(const Mode mode = Mode::AutoReset, const bool signaled = false);
+			void Set();
+			void Reset();
+			bool IsSet() const;
+			void Wait();
+			bool WaitMicros(const long long timeoutMicros);
+
+		private:
+			Event(const Event&);
+			Event& operator=(const Event&);
+			bool TryConsume();
+
+		private:
+			const Mode m_mode;
+			std::atomic<unsigned int> m_signaled;
+			std::atomic<unsigned int> m_waiters;
+		};
+
+		// Single-use countdown: Wait returns once the count has reached zero.
+		class Latch
+		{
+		public:
+			explicit Latch(const unsigned int count);
+			void CountDown(const unsigned int count = 1U);
+			bool TryWait() const;
+			void Wait();
+			bool WaitMicros(const long long timeoutMicros);
+			void ArriveAndWait();
+
+		private:
+			Latch(const Latch&);
+			Latch& operator=(const Latch&);
+
+		private:
+			std::atomic<unsigned int> m_count;
+		};
+
+		// Reusable barrier for a fixed number of participants. ArriveAndWait returns true on exactly one thread
+		// per phase (the last to arrive).
+		class Barrier
+		{
+		public:
+			explicit Barrier(const unsigned int participants);
+			bool ArriveAndWait();
+			unsigned int Participants() const;
+
+		private:
+			Barrier(const Barrier&);
+			Barrier& operator=(const Barrier&);
+
+		private:
+			const unsigned int m_participants;
+			std::atomic<unsigned int> m_arrived;
+			std::atomic<unsigned int> m_generation;
+		};
+
+		class Semaphore
+		{
+		public:
+			explicit Semaphore(const unsigned int initialCount = 0U);
+			void Release(const unsigned int count = 1U);
+			void Acquire();
+			bool TryAcquire();
+			bool TryAcquireMicros(const long long timeoutMicros);
+			unsigned int Available() const;
+
+		private:
+			Semaphore(const Semaphore&);
+			Semaphore& operator=(const Semaphore&);
+
+		private:
+			std::atomic<unsigned int> m_count;
+			std::atomic<unsigned int> m_waiters;
+		};
+
+		class Timer
+		{
+		public:
+			typedef std::function<bool(Timer*, void*)> TimerUserFunc;
+
+			// FixedDelay waits the interval after each callback returns (the period is interval + callback time)
+			// and sleeps for all of it; FixedRate runs callbacks on absolute deadlines start + n * interval, so the
+			// period does not drift, and spins the last Time::GetWaitSpinNanos() of each wait for accuracy.
+			enum class Schedule
+			{
+				FixedDelay,
+				FixedRate
+			};
+
+			// What a FixedRate timer does with deadlines that passed while a callback overran: Skip drops them and
+			// resumes on the next future deadline, CatchUp runs them back to back until it is on time again.
+			enum class MissedTicks
+			{
+				Skip,
+				CatchUp
+			};
+
+			// Jitter is how late each callback started relative to its deadline.
+			struct Stats
+			{
+				unsigned long long ticks;
+				unsigned long long overruns;
+				unsigned long long missed;
+				long long maxJitterNanos;
+				double meanJitterNanos;
+				long long maxCallbackNanos;
+			};
+
+		public:
+			explicit Timer();
+			~Timer();
+			void Begin(const unsigned int intervalMillisecs, TimerUserFunc userFunc, void* userArg = nullptr);
+			void BeginMicros(const long long intervalMicros, TimerUserFunc userFunc, void* userArg = nullptr,
+				const Schedule schedule = Schedule::FixedRate, const MissedTicks missedTicks = MissedTicks::Skip);
+			void End();
+			bool Running();
+			Stats GetStats() const;
+			// Applied by the timer thread when it starts; call while the timer is not running.
+			void SetThreadConfig(const ThreadConfig& config);
+
+		private:
+			bool WasStopRequested() const;
+			bool WaitForDeadline(std::unique_lock<std::mutex>& lock, const long long deadlineNanos, const bool spinTail);
+			static void InternalTimerFunc(Timer* timer);
+
+		private:
+			std::atomic_bool m_stopRequested;
+			std::atomic_bool m_started;
 			std::atomic_bool m_running;
-			unsigned int m_intervalMillisecs;
+			long long m_intervalNanos;
+			Schedule m_schedule;
+			MissedTicks m_missedTicks;
 			void* m_userArg;
 			TimerUserFunc m_userFunc;
+			ThreadConfig m_threadConfig;
+			Event m_startedEvent;
 			std::unique_ptr<std::thread> m_timerThread;
 			std::mutex m_timerMutex;
 			std::condition_variable m_timerStopCond;
+			std::atomic<unsigned long long> m_tickCount;
+			std::atomic<unsigned long long> m_overrunCount;
+			std::atomic<unsigned long long> m_missedCount;
+			std::atomic<long long> m_maxJitterNanos;
+			std::atomic<long long> m_jitterSumNanos;
+			std::atomic<long long> m_maxCallbackNanos;
 		};
-	}
+
+		/*
+			TimerService - runs any number of timers on a few threads. Each thread owns a shard holding a
+			hierarchical timing wheel (4 levels of 256 slots, kernel-style cascading), so Schedule and Cancel are
+			O(1) and expiry processing is O(1) amortised per timer. Callbacks use Timer::TimerUserFunc with a null
+			Timer* and run on the shard thread without any lock held; a repeating timer continues while its
+			callback returns true. Expiry is rounded up to the service resolution.
+		*/
+		class TimerService
+		{
+		public:
+			// Encodes shard, slot and a generation, so a handle of a fired or cancelled timer is never reused.
+			typedef unsigned long long Handle;
+			static const Handle InvalidHandle = 0ULL;
+
+		public:
+			explicit TimerService(const unsigned int threadCount = 1U, const long long resolutionMicros = 1000LL);
+			~TimerService();
+			Handle Schedule(const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg = nullptr);
+			Handle ScheduleOnce(const long long delayMicros, Timer::TimerUserFunc userFunc, void* userArg = nullptr);
+			bool Cancel(const Handle handle);
+			// Moves the next expiry to delayMicros from now, keeping the interval of a repeating timer.
+			bool Reschedule(const Handle handle, const long long delayMicros);
+			size_t Pending() const;
+			long long ResolutionMicros() const;
+
+		private:
+			struct Shard;
+
+			TimerService(const TimerService&);
+			TimerService& operator=(const TimerService&);
+			Handle Add(const long long delayMicros, const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg);
+			static void InternalServiceFunc(TimerService* service, Shard* shard);
+
+		private:
+			long long m_resolutionNanos;
+			long long m_baseNanos;
+			std::atomic<unsigned int> m_nextShard;
+			std::vector<std::unique_ptr<Shard>> m_shards;
+		};
+
+		/*
+			EventLoop - one thread multiplexing file descriptors, timers and posted tasks on epoll (Linux only;
+			elsewhere the constructor throws std::runtime_error). All timers share a single timerfd armed for the
+			earliest deadline, and an eventfd wakes the loop for Post and Stop. Callbacks run on the thread calling
+			Run or RunOnce. Timers use Timer::TimerUserFunc with a null Timer*; a repeating timer keeps a fixed
+			rate, skipping missed deadlines, until its callback returns false or it is cancelled.
+
+			Post, Stop and the timer functions may be called from any thread (timer changes from other threads take
+			effect on the loop thread). Add, Modify and Remove belong to the loop thread, or to any thread while
+			the loop is not running; a callback may remove its own or any other descriptor.
+		*/
+		class EventLoop
+		{
+		public:
+			typedef unsigned long long Handle;
+			static const Handle InvalidHandle = 0ULL;
+
+			// Event bits for Add and Modify and passed to IoCallback; Error covers EPOLLERR and EPOLLHUP and is
+			// always reported.
+			static const unsigned int Readable = 1U;
+			static const unsigned int Writable = 2U;
+			static const unsigned int Error = 4U;
+
+			typedef std::function<void(int, unsigned int)> IoCallback;
+
+		public:
+			EventLoop();
+			~EventLoop();
+			bool Add(const int fd, const unsigned int events, IoCallback callback);
+			bool Modify(const int fd, const unsigned int events);
+			bool Remove(const int fd);
+			Handle Schedule(const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg = nullptr);
+			Handle ScheduleOnce(const long long delayMicros, Timer::TimerUserFunc userFunc, void* userArg = nullptr);
+			void Cancel(const Handle handle);
+			void Post(std::function<void()> task);
+			// Runs until Stop is called.
+			void Run();
+			// Waits up to timeoutMicros (negative waits indefinitely) for one batch of events and dispatches it;
+			// returns the number of callbacks and tasks run.
+			size_t RunOnce(const long long timeoutMicros = -1LL);
+			void Stop();
+			bool IsLoopThread() const;
+
+		private:
+			struct State;
+
+			EventLoop(const EventLoop&);
+			EventLoop& operator=(const EventLoop&);
+			Handle AddTimer(const long long delayMicros, const long long intervalMicros, Timer::TimerUserFunc userFunc, void* userArg);
+			size_t RunTimers();
+			size_t RunPosted();
+			void ArmTimerFd();
+			void Wake();
+
+		private:
+			std::unique_ptr<State> m_state;
+		};
+
+		class ThreadPool;
+
+		// Type-erased, intrusively reference-counted unit of work; the queue and each TaskFuture hold a reference.
+		class TaskBase
+		{
+		public:
+			TaskBase() : m_refs(1U), m_done(false), m_pool(nullptr) {}
+			virtual ~TaskBase() {}
+			void Run();
+
+			bool IsDone() const
+			{
+				return m_done.load(std::memory_order_acquire);
+			}
+
+			ThreadPool* Pool() const
+			{
+				return m_pool;
+			}
+
+			void Retain()
+			{
+				m_refs.fetch_add(1U, std::memory_order_relaxed);
+			}
+
+			void Release()
+			{
+				if(1U == m_refs.fetch_sub(1U, std::memory_order_acq_rel))
+				{
+					delete this;
+				}
+			}
+
+		protected:
+			virtual void Execute() = 0;
+
+		private:
+			TaskBase(const TaskBase&);
+			TaskBase& operator=(const TaskBase&);
+
+		private:
+			std::atomic<unsigned int> m_refs;
+			std::atomic<bool> m_done;
+			ThreadPool* m_pool;
+
+			friend class ThreadPool;
+		};
+
+		// Result slot of a task; an exception thrown by the task is rethrown from TakeValue().
+		template<typename R>
+		class TaskState : public TaskBase
+		{
+		public:
+			TaskState() : m_hasValue(false), m_exception() {}
+
+			~TaskState()
+			{
+				if(m_hasValue)
+				{
+					reinterpret_cast<R*>(&m_storage)->~R();
+				}
+			}
+
+			template<typename F>
+			void Invoke(F& func)
+			{
+				try
+				{
+					new (&m_storage) R(func());
+					m_hasValue = true;
+				}
+				catch(...)
+				{
+					m_exception = std::current_exception();
+				}
+			}
+
+			R TakeValue()
+			{
+				if(m_exception)
+				{
+					std::rethrow_exception(m_exception);
+				}
+				return std::move(*reinterpret_cast<R*>(&m_storage));
+			}
+
+		private:
+			typename std::aligned_storage<sizeof(R), std::alignment_of<R>::value>::type m_storage;
+			bool m_hasValue;
+			std::exception_ptr m_exception;
+		};
+
+		template<>
+		class TaskState<void> : public TaskBase
+		{
+		public:
+			TaskState() : m_exception() {}
+
+			template<typename F>
+			void Invoke(F& func)
+			{
+				try
+				{
+					func();
+				}
+				catch(...)
+				{
+					m_exception = std::current_exception();
+				}
+			}
+
+			void TakeValue()
+			{
+				if(m_exception)
+				{
+					std::rethrow_exception(m_exception);
+				}
+			}
+
+		private:
+			std::exception_ptr m_exception;
+		};
+
+		template<typename F, typename R>
+		class TaskImpl : public TaskState<R>
+		{
+		public:
+			template<typename G>
+			explicit TaskImpl(G&& func) : m_func(std::forward<G>(func)) {}
+
+		protected:
+			void Execute()
+			{
+				this->Invoke(m_func);
+			}
+
+		private:
+			F m_func;
+		};
+
+		// Handle to a submitted task. Wait() and Get() run other queued tasks while the result is not ready, so
+		// tasks may wait on tasks they submitted without starving the pool.
+		template<typename R>
+		class TaskFuture
+		{
+		public:
+			TaskFuture() : m_state(nullptr) {}
+
+			explicit TaskFuture(TaskState<R>* state) : m_state(state)
+			{
+				if(m_state)
+				{
+					m_state->Retain();
+				}
+			}
+
+			TaskFuture(const TaskFuture& other) : TaskFuture(other.m_state) {}
+
+			TaskFuture(TaskFuture&& other) : m_state(other.m_state)
+			{
+				other.m_state = nullptr;
+			}
+
+			~TaskFuture()
+			{
+				if(m_state)
+				{
+					m_state->Release();
+				}
+			}
+
+			TaskFuture& operator=(TaskFuture other)
+			{
+				std::swap(m_state, other.m_state);
+				return *this;
+			}
+
+			bool Valid() const
+			{
+				return m_state != nullptr;
+			}
+
+			bool IsReady() const
+			{
+				return m_state != nullptr && m_state->IsDone();
+			}
+
+			void Wait() const;
+			// Waits and returns the result, or rethrows the task's exception. Call at most once.
+			R Get();
+
+		private:
+			TaskState<R>* m_state;
+		};
+
+		/*
+			ThreadPool - work-stealing pool. Each worker owns a Chase-Lev deque; tasks submitted from a worker go
+			to its own deque (LIFO for locality), tasks from other threads go to a shared injection queue, and
+			idle workers steal from the other end of their peers' deques before sleeping on a condition variable.
+		*/
+		class ThreadPool
+		{
+		public:
+			// A worker count of zero uses std::thread::hardware_concurrency().
+			explicit ThreadPool(const unsigned int workerCount = 0U);
+			// One worker per config, each applied by its worker thread before it takes tasks.
+			explicit ThreadPool(const std::vector<ThreadConfig>& workerConfigs);
+			~ThreadPool();
+
+			template<typename F>
+			TaskFuture<typename std::decay<decltype(std::declval<F&>()())>::type> Submit(F&& func)
+			{
+				typedef typename std::decay<decltype(std::declval<F&>()())>::type R;
+				TaskImpl<typename std::decay<F>::type, R>* task = new TaskImpl<typename std::decay<F>::type, R>(std::forward<F>(func));
+				TaskFuture<R> future(task);
+				Enqueue(task);
+				return future;
+			}
+
+			// Runs the queued tasks, then joins the workers. Tasks submitted afterwards run on the caller.
+			void Shutdown();
+			unsigned int WorkerCount() const;
+			// Runs one queued task on the calling thread; returns false when none was found.
+			bool TryRunPendingTask();
+			void WaitFor(const TaskBase& task);
+			// Worker index of the calling thread in this pool, or -1.
+			int CurrentWorkerIndex() const;
+			// Process-wide pool shared by the library's parallel algorithms.
+			static ThreadPool& Global();
+
+		private:
+			struct Worker;
+
+			ThreadPool(const ThreadPool&);
+			ThreadPool& operator=(const ThreadPool&);
+			void StartWorkers(const unsigned int count, const std::vector<ThreadConfig>& workerConfigs);
+			void Enqueue(TaskBase* task);
+			TaskBase* FindTask(Worker* self);
+			void NotifyCompletion();
+			Worker* CurrentWorker() const;
+			static Worker*& CurrentThreadWorker();
+			static void InternalWorkerFunc(ThreadPool* pool, Worker* self);
+
+		private:
+			std::vector<std::unique_ptr<Worker>> m_workers;
+			AdaptiveMutex m_injectMutex;
+			std::deque<TaskBase*> m_injectQueue;
+			std::atomic<size_t> m_injectCount;
+			std::atomic<bool> m_stopRequested;
+			std::atomic<unsigned int> m_sleepingCount;
+			std::atomic<unsigned long long> m_wakeEpoch;
+			std::mutex m_sleepMutex;
+			std::condition_variable m_sleepCond;
+			std::atomic<unsigned int> m_completionWaiters;
+			std::mutex m_completionMutex;
+			std::condition_variable m_completionCond;
+
+			friend class TaskBase;
+		};
+
+		template<typename R>
+		void TaskFuture<R>::Wait() const
+		{
+			if(m_state && !m_state->IsDone())
+			{
+				m_state->Pool()->WaitFor(*m_state);
+			}
+		}
+
+		template<typename R>
+		R TaskFuture<R>::Get()
+		{
+			if(!m_state)
+			{
+				throw std::logic_error("TaskFuture::Get called on an empty future");
+			}
+			Wait();
+			return m_state->TakeValue();
+		}
+
+		// Leaf size used when a grain of zero is passed: a fixed fraction of the range rather than a function of the
+		// worker count, so the split tree - and with it the result of a floating point reduction - is the same on
+		// every machine.
+		inline size_t AutoGrain(const size_t count, const size_t minimum = 1U)
+		{
+			return std::max(minimum, count / 256U);
+		}
+
+		// Recursive range splitting behind the Parallel* algorithms: the upper half is submitted, the lower half runs
+		// inline, and the join helps with queued work.
+		namespace Internal
+		{
+			template<typename Index, typename F>
+			void ParallelForSplit(ThreadPool& pool, const Index begin, const Index end, const size_t grain, F& func)
+			{
+				if(static_cast<size_t>(end - begin) <= grain)
+				{
+					for(Index index = begin; index < end; ++index)
+					{
+						func(index);
+					}
+					return;
+				}
+
+				const Index middle = begin + ((end - begin) / 2);
+				TaskFuture<void> upper = pool.Submit([&pool, middle, end, grain, &func]() { ParallelForSplit(pool, middle, end, grain, func); });
+				try
+				{
+					ParallelForSplit(pool, begin, middle, grain, func);
+				}
+				catch(...)
+				{
+					upper.Wait();
+					throw;
+				}
+				upper.Get();
+			}
+
+			template<typename Index, typename T, typename Map, typename Reduce>
+			T ParallelReduceSplit(ThreadPool& pool, const Index begin, const Index end, const size_t grain, const T& identity, Map& map, Reduce& reduce)
+			{
+				if(static_cast<size_t>(end - begin) <= grain)
+				{
+					T result = identity;
+					for(Index index = begin; index < end; ++index)
+					{
+						result = reduce(result, map(index));
+					}
+					return result;
+				}
+
+				const Index middle = begin + ((end - begin) / 2);
+				TaskFuture<T> upper = pool.Submit([&pool, middle, end, grain, &identity, &map, &reduce]() {
+					return ParallelReduceSplit(pool, middle, end, grain, identity, map, reduce);
+				});
+				T lower = [&]() -> T {
+					try
+					{
+						return ParallelReduceSplit(pool, begin, middle, grain, identity, map, reduce);
+					}
+					catch(...)
+					{
+						upper.Wait();
+						throw;
+					}
+				}();
+				return reduce(lower, upper.Get());
+			}
+
+			// Stable merge of two sorted runs into out. The larger run is halved and the other is split with a
+			// binary search that keeps equal elements of the first run ahead of those of the second.
+			template<typename It, typename OutIt, typename Compare>
+			void ParallelMergeSplit(ThreadPool& pool, It first1, It last1, It first2, It last2, OutIt out, Compare& comp, const size_t grain)
+			{
+				const size_t count1 = static_cast<size_t>(last1 - first1);
+				const size_t count2 = static_cast<size_t>(last2 - first2);
+
+				if(count1 + count2 <= grain)
+				{
+					std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+						std::make_move_iterator(first2), std::make_move_iterator(last2), out, comp);
+					return;
+				}
+
+				It split1;
+				It split2;
+				if(count1 >= count2)
+				{
+					split1 = first1 + (count1 / 2U);
+					split2 = std::lower_bound(first2, last2, *split1, comp);
+				}
+				else
+				{
+					split2 = first2 + (count2 / 2U);
+					split1 = std::upper_bound(first1, last1, *split2, comp);
+				}
+
+				// With tiny grains a split can leave one side empty, and recursing would repeat the same merge forever.
+				const size_t lowerCount = static_cast<size_t>((split1 - first1) + (split2 - first2));
+				if(0U == lowerCount || count1 + count2 == lowerCount)
+				{
+					std::merge(std::make_move_iterator(first1), std::make_move_iterator(last1),
+						std::make_move_iterator(first2), std::make_move_iterator(last2), out, comp);
+					return;
+				}
+
+				const OutIt splitOut = out + lowerCount;
+				TaskFuture<void> upper = pool.Submit([&pool, split1, last1, split2, last2, splitOut, &comp, grain]() {
+					ParallelMergeSplit(pool, split1, last1, split2, last2, splitOut, comp, grain);
+				});
+				try
+				{
+					ParallelMergeSplit(pool, first1, split1, first2, split2, out, comp, grain);
+				}
+				catch(...)
+				{
+					upper.Wait();
+					throw;
+				}
+				upper.Get();
+			}
+
+			// Ping-pong merge sort: sorts [first, last) and leaves the result in scratch when toScratch is set,
+			// otherwise in place. Both halves are sorted into the other array so each level costs one merge pass.
+			template<typename It, typename ScratchIt, typename Compare>
+			void ParallelSortSplit(ThreadPool& pool, It first, It last, ScratchIt scratch, const bool toScratch, Compare& comp, const size_t grain)
+			{
+				const size_t count = static_cast<size_t>(last - first);
+
+				if(count <= grain)
+				{
+					std::stable_sort(first, last, comp);
+					if(toScratch)
+					{
+						std::move(first, last, scratch);
+					}
+					return;
+				}
+
+				const size_t half = count / 2U;
+				TaskFuture<void> upper = pool.Submit([&pool, first, last, scratch, toScratch, &comp, grain, half]() {
+					ParallelSortSplit(pool, first + half, last, scratch + half, !toScratch, comp, grain);
+				});
+				try
+				{
+					ParallelSortSplit(pool, first, first + half, scratch, !toScratch, comp, grain);
+				}
+				catch(...)
+				{
+					upper.Wait();
+					throw;
+				}
+				upper.Get();
+
+				if(toScratch)
+				{
+					ParallelMergeSplit(pool, first, first + half, first + half, last, scratch, comp, grain);
+				}
+				else
+				{
+					ParallelMergeSplit(pool, scratch, scratch + half, scratch + half, scratch + count, first, comp, grain);
+				}
+			}
+		}
+
+		// Calls func(index) for every index in [begin, end), splitting the range down to grain-sized leaves.
+		template<typename Index, typename F>
+		void ParallelFor(const Index begin, const Index end, const size_t grain, F&& func, ThreadPool& pool = ThreadPool::Global())
+		{
+			if(begin < end)
+			{
+				Internal::ParallelForSplit(pool, begin, end, (grain > 0U) ? grain : AutoGrain(static_cast<size_t>(end - begin)), func);
+			}
+		}
+
+		// Folds reduce(accumulator, map(index)) over [begin, end); reduce must be associative and identity its
+		// neutral element. Partial results combine in a fixed tree, so the result does not depend on scheduling.
+		template<typename Index, typename T, typename Map, typename Reduce>
+		T ParallelReduce(const Index begin, const Index end, const size_t grain, const T identity, Map&& map, Reduce&& reduce,
+			ThreadPool& pool = ThreadPool::Global())
+		{
+			if(!(begin < end))
+			{
+				return identity;
+			}
+			return Internal::ParallelReduceSplit(pool, begin, end, (grain > 0U) ? grain : AutoGrain(static_cast<size_t>(end - begin)), identity, map, reduce);
+		}
+
+		// out[i] = func(first[i]) over random-access ranges; returns the end of the output.
+		template<typename InputIt, typename OutputIt, typename F>
+		OutputIt ParallelTransform(InputIt first, InputIt last, OutputIt out, F&& func, const size_t grain = 0U, ThreadPool& pool = ThreadPool::Global())
+		{
+			const size_t count = static_cast<size_t>(last - first);
+			ParallelFor(static_cast<size_t>(0U), count, grain, [first, out, &func](const size_t index) { out[index] = func(first[index]); }, pool);
+			return out + count;
+		}
+
+		// Stable parallel merge sort, equivalent to std::stable_sort. Needs a scratch buffer the size of the range.
+		template<typename RandomIt, typename Compare>
+		void ParallelSort(RandomIt first, RandomIt last, Compare comp, const size_t grain = 0U, ThreadPool& pool = ThreadPool::Global())
+		{
+			typedef typename std::iterator_traits<RandomIt>::value_type Value;
+			const size_t count = static_cast<size_t>(last - first);
+			const size_t leaf = (grain > 0U) ? grain : AutoGrain(count, 512U);
+
+			if(count <= leaf)
+			{
+				std::stable_sort(first, last, comp);
+				return;
+			}
+
+			// Sort a moved-out copy using the input range as scratch so that the result lands back in place.
+			std::vector<Value> buffer(std::make_move_iterator(first), std::make_move_iterator(last));
+			Internal::ParallelSortSplit(pool, buffer.begin(), buffer.end(), first, true, comp, leaf);
+		}
+
+		template<typename RandomIt>
+		void ParallelSort(RandomIt first, RandomIt last)
+		{
+			ParallelSort(first, last, std::less<typename std::iterator_traits<RandomIt>::value_type>());
+		}
+
+		// Parking for the bounded queues' blocking calls. A waiter spins briefly, then counts itself in waiting and
+		// sleeps on epoch; the other side bumps epoch and wakes only while waiting is non-zero. The seq_cst fences
+		// on both sides make sure a parking thread either sees the new state on its last attempt or is woken.
+		// WakeParkedRelaxed skips the fence for hot paths, so a wake can be missed; its waiters pass sliceMicros to
+		// WaitParked and re-check at least that often.
+		namespace Internal
+		{
+			inline void WakeParked(std::atomic<unsigned int>& waiting, std::atomic<unsigned int>& epoch)
+			{
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				if(waiting.load(std::memory_order_relaxed) > 0U)
+				{
+					epoch.fetch_add(1U, std::memory_order_relaxed);
+					FutexWake(epoch, 1);
+				}
+			}
+
+			inline void WakeParkedRelaxed(std::atomic<unsigned int>& waiting, std::atomic<unsigned int>& epoch)
+			{
+				if(waiting.load(std::memory_order_relaxed) > 0U)
+				{
+					epoch.fetch_add(1U, std::memory_order_relaxed);
+					FutexWake(epoch, 1);
+				}
+			}
+
+			template<typename F>
+			bool WaitParked(F attempt, std::atomic<unsigned int>& waiting, std::atomic<unsigned int>& epoch, const long long timeoutMicros,
+				const long long sliceMicros = -1LL)
+			{
+				for(int spin = 0; spin < 128; spin++)
+				{
+					if(attempt())
+					{
+						return true;
+					}
+					if(spin < 96)
+					{
+						CpuRelax();
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+
+				const long long deadline = (timeoutMicros < 0LL) ? -1LL : Time::Nanos() + (timeoutMicros * 1000LL);
+				while(true)
+				{
+					const unsigned int observed = epoch.load(std::memory_order_relaxed);
+					waiting.fetch_add(1U, std::memory_order_relaxed);
+					std::atomic_thread_fence(std::memory_order_seq_cst);
+
+					bool done = attempt();
+					if(!done)
+					{
+						long long remaining = (deadline < 0LL) ? -1LL : (deadline - Time::Nanos()) / 1000LL;
+						if(deadline >= 0LL && remaining <= 0LL)
+						{
+							waiting.fetch_sub(1U, std::memory_order_relaxed);
+							return false;
+						}
+						if(sliceMicros > 0LL && (remaining < 0LL || remaining > sliceMicros))
+						{
+							remaining = sliceMicros;
+						}
+						FutexWait(epoch, observed, remaining);
+					}
+					waiting.fetch_sub(1U, std::memory_order_relaxed);
+
+					if(done)
+					{
+						return true;
+					}
+				}
+			}
+		}
+
+		/*
+			SpscQueue - bounded wait-free queue for exactly one producer thread and one consumer thread. The
+			capacity is rounded up to a power of two and every slot is usable. Producer and consumer indices sit
+			on separate cache lines and each side caches the other's index, so the shared line is only read when
+			the cached value says the queue looks full (or empty). Slots hold constructed objects: T must be
+			default constructible and move assignable, and ReserveWrite()/PeekRead() hand out those objects for
+			in-place access. Blocked WaitPush()/WaitPop() callers park on a futex after a short spin, as in
+			MpmcQueue, but wake up at least every millisecond so that pushes and pops need no fence.
+		*/
+		template<typename T>
+		class SpscQueue
+		{
+		public:
+			explicit SpscQueue(const size_t capacity) :
+				m_tail(0U),
+				m_cachedHead(0U),
+				m_head(0U),
+				m_cachedTail(0U),
+				m_consumerWaiting(0U),
+				m_pushEpoch(0U),
+				m_producerWaiting(0U),
+				m_popEpoch(0U),
+				m_mask(static_cast<size_t>(Numeric::NextPow2(std::max(static_cast<size_t>(2U), capacity))) - 1U),
+				m_slots(new T[m_mask + 1U])
+			{
+			}
+
+			size_t Capacity() const
+			{
+				return m_mask + 1U;
+			}
+
+			// Approximate when called while the other side is active.
+			size_t Size() const
+			{
+				return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+			}
+
+			bool Empty() const
+			{
+				return 0U == Size();
+			}
+
+			// Producer side.
+			bool TryPush(const T& value)
+			{
+				T* slot;
+				if(0U == ReserveWrite(1U, slot))
+				{
+					return false;
+				}
+				*slot = value;
+				CommitWrite(1U);
+				return true;
+			}
+
+			bool TryPush(T&& value)
+			{
+				T* slot;
+				if(0U == ReserveWrite(1U, slot))
+				{
+					return false;
+				}
+				*slot = std::move(value);
+				CommitWrite(1U);
+				return true;
+			}
+
+			template<typename... Args>
+			bool TryEmplace(Args&&... args)
+			{
+				T* slot;
+				if(0U == ReserveWrite(1U, slot))
+				{
+					return false;
+				}
+				*slot = T(std::forward<Args>(args)...);
+				CommitWrite(1U);
+				return true;
+			}
+
+			// Copies up to count items and returns how many fit.
+			size_t TryPushBulk(const T* items, const size_t count)
+			{
+				size_t pushed = 0U;
+				T* slots;
+
+				// At most two passes: up to the end of the ring, then from its start.
+				for(int pass = 0; pass < 2 && pushed < count; pass++)
+				{
+					const size_t reserved = ReserveWrite(count - pushed, slots);
+					std::copy(items + pushed, items + pushed + reserved, slots);
+					CommitWrite(reserved);
+					pushed += reserved;
+				}
+
+				return pushed;
+			}
+
+			// Returns up to count contiguous free slots for in-place writes; publish them with CommitWrite().
+			size_t ReserveWrite(const size_t count, T*& slots)
+			{
+				const size_t tail = m_tail.load(std::memory_order_relaxed);
+				size_t available = Capacity() - (tail - m_cachedHead);
+
+				if(available < count)
+				{
+					m_cachedHead = m_head.load(std::memory_order_acquire);
+					available = Capacity() - (tail - m_cachedHead);
+				}
+
+				const size_t offset = tail & m_mask;
+				slots = m_slots.get() + offset;
+				return std::min(std::min(count, available), Capacity() - offset);
+			}
+
+			void CommitWrite(const size_t count)
+			{
+				m_tail.store(m_tail.load(std::memory_order_relaxed) + count, std::memory_order_release);
+				Internal::WakeParkedRelaxed(m_consumerWaiting, m_pushEpoch);
+			}
+
+			// Spins briefly, then parks until there is room; gives up after timeoutMicros unless it is negative.
+			bool WaitPush(T value, const long long timeoutMicros = -1LL)
+			{
+				return Internal::WaitParked([this, &value]() -> bool { return TryPush(std::move(value)); }, m_producerWaiting, m_popEpoch, timeoutMicros, ParkSliceMicros);
+			}
+
+			// Consumer side.
+			bool TryPop(T& value)
+			{
+				T* slots;
+				if(0U == PeekRead(1U, slots))
+				{
+					return false;
+				}
+				value = std::move(*slots);
+				CommitRead(1U);
+				return true;
+			}
+
+			// Moves up to count items out and returns how many were available.
+			size_t TryPopBulk(T* items, const size_t count)
+			{
+				size_t popped = 0U;
+				T* slots;
+
+				for(int pass = 0; pass < 2 && popped < count; pass++)
+				{
+					const size_t peeked = PeekRead(count - popped, slots);
+					std::move(slots, slots + peeked, items + popped);
+					CommitRead(peeked);
+					popped += peeked;
+				}
+
+				return popped;
+			}
+
+			// Returns up to count contiguous readable slots for in-place reads; release them with CommitRead().
+			size_t PeekRead(const size_t count, T*& slots)
+			{
+				const size_t head = m_head.load(std::memory_order_relaxed);
+				size_t available = m_cachedTail - head;
+
+				if(available < count)
+				{
+					m_cachedTail = m_tail.load(std::memory_order_acquire);
+					available = m_cachedTail - head;
+				}
+
+				const size_t offset = head & m_mask;
+				slots = m_slots.get() + offset;
+				return std::min(std::min(count, available), Capacity() - offset);
+			}
+
+			void CommitRead(const size_t count)
+			{
+				m_head.store(m_head.load(std::memory_order_relaxed) + count, std::memory_order_release);
+				Internal::WakeParkedRelaxed(m_producerWaiting, m_popEpoch);
+			}
+
+			bool WaitPop(T& value, const long long timeoutMicros = -1LL)
+			{
+				return Internal::WaitParked([this, &value]() -> bool { return TryPop(value); }, m_consumerWaiting, m_pushEpoch, timeoutMicros, ParkSliceMicros);
+			}
+
+		private:
+			// Commits wake parked waiters without a fence, so a wake racing a waiter that is just parking can be
+			// lost; parked waiters re-check this often instead.
+			static const long long ParkSliceMicros = 1000LL;
+
+			SpscQueue(const SpscQueue&);
+			SpscQueue& operator=(const SpscQueue&);
+
+		private:
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<size_t> m_tail;
+			size_t m_cachedHead;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<size_t> m_head;
+			size_t m_cachedTail;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<unsigned int> m_consumerWaiting;
+			std::atomic<unsigned int> m_pushEpoch;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<unsigned int> m_producerWaiting;
+			std::atomic<unsigned int> m_popEpoch;
+			alignas(HELPERS_CACHE_LINE_SIZE) const size_t m_mask;
+			std::unique_ptr<T[]> m_slots;
+		};
+
+		/*
+			MpmcQueue - bounded lock-free queue for any number of producers and consumers (Dmitry Vyukov's
+			sequence-numbered ring). Each cell's sequence number says whether it is free for the producer at that
+			position or holds data for the consumer at it, so a push or pop is one CAS on the shared position plus
+			an acquire/release handoff on the cell. Bulk operations claim a run of ready cells with a single CAS.
+			Blocked WaitPush()/WaitPop() callers spin briefly and then park on a futex; the other side only pays for
+			a wakeup while someone is parked.
+		*/
+		template<typename T>
+		class MpmcQueue
+		{
+		public:
+			explicit MpmcQueue(const size_t capacity) :
+				m_enqueuePos(0U),
+				m_dequeuePos(0U),
+				m_waitingConsumers(0U),
+				m_pushEpoch(0U),
+				m_waitingProducers(0U),
+				m_popEpoch(0U),
+				m_mask(static_cast<size_t>(Numeric::NextPow2(std::max(static_cast<size_t>(2U), capacity))) - 1U),
+				m_cells(new Cell[m_mask + 1U])
+			{
+				for(size_t index = 0U; index <= m_mask; index++)
+				{
+					m_cells[index].sequence.store(index, std::memory_order_relaxed);
+				}
+			}
+
+			~MpmcQueue()
+			{
+				const size_t end = m_enqueuePos.load(std::memory_order_acquire);
+				for(size_t position = m_dequeuePos.load(std::memory_order_acquire); position != end; position++)
+				{
+					reinterpret_cast<T*>(&m_cells[position & m_mask].storage)->~T();
+				}
+			}
+
+			size_t Capacity() const
+			{
+				return m_mask + 1U;
+			}
+
+			// Approximate when called while other threads are active.
+			size_t Size() const
+			{
+				const size_t dequeued = m_dequeuePos.load(std::memory_order_acquire);
+				const size_t enqueued = m_enqueuePos.load(std::memory_order_acquire);
+				return (enqueued > dequeued) ? enqueued - dequeued : 0U;
+			}
+
+			bool TryPush(const T& value)
+			{
+				return TryEmplace(value);
+			}
+
+			bool TryPush(T&& value)
+			{
+				return TryEmplace(std::move(value));
+			}
+
+			template<typename... Args>
+			bool TryEmplace(Args&&... args)
+			{
+				size_t position;
+				if(0U == ClaimEnqueue(1U, position))
+				{
+					return false;
+				}
+				Cell& cell = m_cells[position & m_mask];
+				new (&cell.storage) T(std::forward<Args>(args)...);
+				cell.sequence.store(position + 1U, std::memory_order_release);
+				WakeConsumers();
+				return true;
+			}
+
+			// Copies up to count items and returns how many were pushed.
+			size_t TryPushBulk(const T* items, const size_t count)
+			{
+				size_t position;
+				const size_t claimed = ClaimEnqueue(count, position);
+
+				for(size_t i = 0U; i < claimed; i++)
+				{
+					Cell& cell = m_cells[(position + i) & m_mask];
+					new (&cell.storage) T(items[i]);
+					cell.sequence.store(position + i + 1U, std::memory_order_release);
+				}
+				if(claimed > 0U)
+				{
+					WakeConsumers();
+				}
+
+				return claimed;
+			}
+
+			bool TryPop(T& value)
+			{
+				return 1U == TryPopBulk(&value, 1U);
+			}
+
+			// Moves up to count items out and returns how many were popped.
+			size_t TryPopBulk(T* items, const size_t count)
+			{
+				size_t position;
+				const size_t claimed = ClaimDequeue(count, position);
+
+				for(size_t i = 0U; i < claimed; i++)
+				{
+					Cell& cell = m_cells[(position + i) & m_mask];
+					T* stored = reinterpret_cast<T*>(&cell.storage);
+					items[i] = std::move(*stored);
+					stored->~T();
+					cell.sequence.store(position + i + m_mask + 1U, std::memory_order_release);
+				}
+				if(claimed > 0U)
+				{
+					WakeProducers();
+				}
+
+				return claimed;
+			}
+
+			// Blocks until there is room; gives up after timeoutMicros unless it is negative.
+			bool WaitPush(T value, const long long timeoutMicros = -1LL)
+			{
+				return WaitFor([this, &value]() -> bool { return TryPush(std::move(value)); }, m_waitingProducers, m_popEpoch, timeoutMicros);
+			}
+
+			bool WaitPop(T& value, const long long timeoutMicros = -1LL)
+			{
+				return WaitFor([this, &value]() -> bool { return TryPop(value); }, m_waitingConsumers, m_pushEpoch, timeoutMicros);
+			}
+
+			// Blocks until at least one item is available, then takes up to count; returns 0 only on timeout.
+			size_t WaitPopBulk(T* items, const size_t count, const long long timeoutMicros = -1LL)
+			{
+				size_t popped = 0U;
+				WaitFor([this, items, count, &popped]() -> bool { return (popped = TryPopBulk(items, count)) > 0U; },
+					m_waitingConsumers, m_pushEpoch, timeoutMicros);
+				return popped;
+			}
+
+		private:
+			struct Cell
+			{
+				std::atomic<size_t> sequence;
+				typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type storage;
+			};
+
+			MpmcQueue(const MpmcQueue&);
+			MpmcQueue& operator=(const MpmcQueue&);
+
+			// Claims up to count consecutive free cells starting at the enqueue position.
+			size_t ClaimEnqueue(const size_t count, size_t& position)
+			{
+				position = m_enqueuePos.load(std::memory_order_relaxed);
+
+				while(count > 0U)
+				{
+					size_t ready = 0U;
+					while(ready < count && ready <= m_mask
+						&& m_cells[(position + ready) & m_mask].sequence.load(std::memory_order_acquire) == position + ready)
+					{
+						ready++;
+					}
+
+					if(0U == ready)
+					{
+						// Behind the position means full; ahead means another producer claimed it first.
+						const size_t sequence = m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+						if(static_cast<std::ptrdiff_t>(sequence - position) < 0)
+						{
+							return 0U;
+						}
+						position = m_enqueuePos.load(std::memory_order_relaxed);
+					}
+					else if(m_enqueuePos.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+					{
+						return ready;
+					}
+				}
+
+				return 0U;
+			}
+
+			// Claims up to count consecutive filled cells starting at the dequeue position.
+			size_t ClaimDequeue(const size_t count, size_t& position)
+			{
+				position = m_dequeuePos.load(std::memory_order_relaxed);
+
+				while(count > 0U)
+				{
+					size_t ready = 0U;
+					while(ready < count && ready <= m_mask
+						&& m_cells[(position + ready) & m_mask].sequence.load(std::memory_order_acquire) == position + ready + 1U)
+					{
+						ready++;
+					}
+
+					if(0U == ready)
+					{
+						const size_t sequence = m_cells[position & m_mask].sequence.load(std::memory_order_acquire);
+						if(static_cast<std::ptrdiff_t>(sequence - (position + 1U)) < 0)
+						{
+							return 0U;
+						}
+						position = m_dequeuePos.load(std::memory_order_relaxed);
+					}
+					else if(m_dequeuePos.compare_exchange_weak(position, position + ready, std::memory_order_relaxed))
+					{
+						return ready;
+					}
+				}
+
+				return 0U;
+			}
+
+			void WakeConsumers()
+			{
+				Internal::WakeParked(m_waitingConsumers, m_pushEpoch);
+			}
+
+			void WakeProducers()
+			{
+				Internal::WakeParked(m_waitingProducers, m_popEpoch);
+			}
+
+			template<typename F>
+			bool WaitFor(F attempt, std::atomic<unsigned int>& waiting, std::atomic<unsigned int>& epoch, const long long timeoutMicros)
+			{
+				return Internal::WaitParked(attempt, waiting, epoch, timeoutMicros);
+			}
+
+		private:
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<size_t> m_enqueuePos;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<size_t> m_dequeuePos;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<unsigned int> m_waitingConsumers;
+			std::atomic<unsigned int> m_pushEpoch;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<unsigned int> m_waitingProducers;
+			std::atomic<unsigned int> m_popEpoch;
+			alignas(HELPERS_CACHE_LINE_SIZE) const size_t m_mask;
+			std::unique_ptr<Cell[]> m_cells;
+		};
+
+		/*
+			TaskGraph - runs a DAG of named tasks on a ThreadPool. A node is submitted as soon as its last
+			dependency finishes, so independent stages overlap. If a node throws or Cancel() is called, nodes
+			that have not started yet are skipped (dependents of a skipped node are skipped too) and Run()
+			rethrows the first exception once everything has settled. A Cancel() made while the graph is idle
+			applies to the next Run(), which then skips every node. Per-node timings are relative to the start
+			of the last Run().
+		*/
+		class TaskGraph
+		{
+		public:
+			typedef size_t NodeId;
+
+			struct NodeStats
+			{
+				std::string name;
+				long long startNanos;
+				long long endNanos;
+				long long durationNanos;
+				bool ran;
+				bool skipped;
+				bool failed;
+			};
+
+		public:
+			explicit TaskGraph(ThreadPool& pool = ThreadPool::Global());
+			~TaskGraph();
+			NodeId AddNode(const std::string& name, std::function<void()> func);
+			// node runs only after dependsOn has finished.
+			void AddDependency(const NodeId node, const NodeId dependsOn);
+			// Adds a node that runs after predecessor.
+			NodeId Then(const NodeId predecessor, const std::string& name, std::function<void()> func);
+			// Blocks, helping the pool, until every node has run or been skipped. Throws std::logic_error on a cycle.
+			void Run();
+			// Safe from any thread, including from inside a node.
+			void Cancel();
+			bool IsCancelled() const;
+			size_t NodeCount() const;
+			const NodeStats& Stats(const NodeId node) const;
+			// Chain of dependent nodes with the largest summed duration in the last Run(), first node first.
+			std::vector<NodeId> CriticalPath() const;
+			long long CriticalPathNanos() const;
+
+		private:
+			struct Node;
+
+			TaskGraph(const TaskGraph&);
+			TaskGraph& operator=(const TaskGraph&);
+			Node& GetNode(const NodeId node) const;
+			std::vector<NodeId> TopologicalOrder() const;
+			void Dispatch(const NodeId node);
+			void Execute(const NodeId node);
+
+		private:
+			ThreadPool& m_pool;
+			std::vector<std::unique_ptr<Node>> m_nodes;
+			std::atomic<bool> m_running;
+			std::atomic<bool> m_cancelled;
+			std::atomic<bool> m_cancelPending;
+			std::atomic<unsigned int> m_unfinished;
+			long long m_beganNanos;
+			std::mutex m_errorMutex;
+			std::exception_ptr m_firstError;
+		};
+	}
+
+	namespace Memory
+	{
+		// Small dense number of the calling thread (0, 1, 2 ...), assigned on first use.
+		unsigned int CurrentThreadSlot();
+
+		/*
+			ObjectPool - recycles fixed-size objects that are often released on another thread than the one that
+			acquired them. Threads map onto a fixed set of cache slots, each a short free list behind a try-lock,
+			so Acquire and Release normally touch only their own slot. Slots exchange batches with a lock-free
+			global free list: a Treiber stack whose head packs a 16 bit ABA tag above the 48 bit node address
+			(x86-64 and AArch64 user space). Cached objects beyond maxCached are freed in batches of at most one
+			batch per Release, and nodes are only freed after every pop that could still read them has finished
+			(two reader counters, flipped on each trim). Objects must all be released before the pool is destroyed.
+		*/
+		template<typename T>
+		class ObjectPool
+		{
+			static_assert(alignof(T) <= alignof(std::max_align_t), "ObjectPool does not support over-aligned types");
+			static_assert(sizeof(void*) == 8U, "ObjectPool packs a tag into the upper 16 bits of 64 bit pointers");
+
+		public:
+			struct Stats
+			{
+				// Acquires served from a cache or the global list, and those that allocated a new object.
+				unsigned long long hits;
+				unsigned long long misses;
+				size_t live;
+				size_t cached;
+				// Most objects (live and cached) allocated at once.
+				size_t highWater;
+				unsigned long long freed;
+			};
+
+			explicit ObjectPool(const size_t maxCached = 4096U, const unsigned int batch = 32U) :
+				m_maxCached(maxCached),
+				m_batch(std::max(1U, batch)),
+				m_head(0ULL),
+				m_globalCount(0U),
+				m_allocatedCount(0U),
+				m_highWater(0U),
+				m_freedCount(0ULL),
+				m_contendedHits(0ULL),
+				m_contendedMisses(0ULL),
+				m_epoch(0U),
+				m_trimMutex()
+			{
+				m_readers[0].store(0U);
+				m_readers[1].store(0U);
+			}
+
+			~ObjectPool()
+			{
+				for(Cache& cache : m_caches)
+				{
+					FreeChain(cache.head);
+				}
+				FreeChain(Unpack(m_head.load()));
+			}
+
+			template<typename... Args>
+			T* Acquire(Args&&... args)
+			{
+				Node* node = Pop();
+				try
+				{
+					return new(&node->storage) T(std::forward<Args>(args)...);
+				}
+				catch(...)
+				{
+					Push(node);
+					throw;
+				}
+			}
+
+			void Release(T* object)
+			{
+				if(nullptr != object)
+				{
+					object->~T();
+					Push(reinterpret_cast<Node*>(object));
+				}
+			}
+
+			// Pre-warms the global list so that the first count acquires do not allocate.
+			void Reserve(const size_t count)
+			{
+				for(size_t i = 0U; i < count; i++)
+				{
+					PushGlobal(NewNode(), nullptr, 1U);
+				}
+			}
+
+			// Frees up to maxFree objects from the global list; returns how many were freed.
+			size_t Trim(const size_t maxFree)
+			{
+				std::lock_guard<std::mutex> lock(m_trimMutex);
+				return TrimLocked(maxFree);
+			}
+
+			Stats GetStats()
+			{
+				Stats stats;
+				stats.hits = m_contendedHits.load(std::memory_order_relaxed);
+				stats.misses = m_contendedMisses.load(std::memory_order_relaxed);
+				stats.cached = m_globalCount.load(std::memory_order_relaxed);
+				for(Cache& cache : m_caches)
+				{
+					std::lock_guard<Threading::AdaptiveMutex> lock(cache.lock);
+					stats.hits += cache.hits;
+					stats.misses += cache.misses;
+					stats.cached += cache.count;
+				}
+				const size_t allocated = m_allocatedCount.load(std::memory_order_relaxed);
+				stats.live = (allocated > stats.cached) ? allocated - stats.cached : 0U;
+				stats.highWater = m_highWater.load(std::memory_order_relaxed);
+				stats.freed = m_freedCount.load(std::memory_order_relaxed);
+				return stats;
+			}
+
+		private:
+			// Storage comes first, so a T* is also its Node*.
+			struct Node
+			{
+				typename std::aligned_storage<sizeof(T), alignof(T)>::type storage;
+				std::atomic<Node*> next;
+			};
+
+			struct alignas(HELPERS_CACHE_LINE_SIZE) Cache
+			{
+				Threading::AdaptiveMutex lock;
+				Node* head;
+				unsigned int count;
+				unsigned long long hits;
+				unsigned long long misses;
+
+				Cache() :
+					lock(),
+					head(nullptr),
+					count(0U),
+					hits(0ULL),
+					misses(0ULL)
+				{
+				}
+			};
+
+			static const unsigned int CacheSlots = 32U;
+			static const unsigned long long PointerMask = (1ULL << 48) - 1ULL;
+
+			ObjectPool(const ObjectPool&);
+			ObjectPool& operator=(const ObjectPool&);
+
+			static Node* Unpack(const unsigned long long head)
+			{
+				return reinterpret_cast<Node*>(static_cast<uintptr_t>(head & PointerMask));
+			}
+
+			static unsigned long long Pack(Node* node, const unsigned long long previous)
+			{
+				return (reinterpret_cast<uintptr_t>(node) & PointerMask) | ((previous & ~PointerMask) + (PointerMask + 1ULL));
+			}
+
+			Cache& LocalCache()
+			{
+				return m_caches[CurrentThreadSlot() % CacheSlots];
+			}
+
+			Node* Pop()
+			{
+				Cache& cache = LocalCache();
+				if(cache.lock.try_lock())
+				{
+					if(nullptr == cache.head)
+					{
+						// Move up to a batch from the global list into the cache.
+						for(unsigned int i = 0U; i < m_batch; i++)
+						{
+							Node* node = PopGlobal();
+							if(nullptr == node)
+							{
+								break;
+							}
+							node->next.store(cache.head, std::memory_order_relaxed);
+							cache.head = node;
+							cache.count++;
+						}
+					}
+					Node* node = cache.head;
+					if(nullptr != node)
+					{
+						cache.head = node->next.load(std::memory_order_relaxed);
+						cache.count--;
+						cache.hits++;
+					}
+					else
+					{
+						cache.misses++;
+					}
+					cache.lock.unlock();
+					return (nullptr != node) ? node : NewNode();
+				}
+
+				// Another thread shares the slot right now: go straight to the global list.
+				Node* node = PopGlobal();
+				if(nullptr != node)
+				{
+					m_contendedHits.fetch_add(1ULL, std::memory_order_relaxed);
+					return node;
+				}
+				m_contendedMisses.fetch_add(1ULL, std::memory_order_relaxed);
+				return NewNode();
+			}
+
+			void Push(Node* node)
+			{
+				Cache& cache = LocalCache();
+				if(cache.lock.try_lock())
+				{
+					node->next.store(cache.head, std::memory_order_relaxed);
+					cache.head = node;
+					Node* flushFirst = nullptr;
+					Node* flushLast = nullptr;
+					if(++cache.count >= 2U * m_batch)
+					{
+						// Hand the newest batch to the global list as one chain.
+						flushFirst = cache.head;
+						flushLast = flushFirst;
+						for(unsigned int i = 1U; i < m_batch; i++)
+						{
+							flushLast = flushLast->next.load(std::memory_order_relaxed);
+						}
+						cache.head = flushLast->next.load(std::memory_order_relaxed);
+						cache.count -= m_batch;
+					}
+					cache.lock.unlock();
+					if(nullptr != flushFirst)
+					{
+						PushGlobal(flushFirst, flushLast, m_batch);
+					}
+				}
+				else
+				{
+					PushGlobal(node, nullptr, 1U);
+				}
+
+				const size_t cached = m_globalCount.load(std::memory_order_relaxed);
+				if(cached > m_maxCached && m_trimMutex.try_lock())
+				{
+					TrimLocked(std::min<size_t>(m_batch, cached - m_maxCached));
+					m_trimMutex.unlock();
+				}
+			}
+
+			// Pushes the chain first..last (last == nullptr for a single node) of count nodes.
+			void PushGlobal(Node* first, Node* last, const size_t count)
+			{
+				if(nullptr == last)
+				{
+					last = first;
+				}
+				// Counted before the chain is published, so a pop of these nodes can never take the count below zero.
+				m_globalCount.fetch_add(count, std::memory_order_relaxed);
+				unsigned long long head = m_head.load(std::memory_order_relaxed);
+				do
+				{
+					last->next.store(Unpack(head), std::memory_order_relaxed);
+				}
+				while(!m_head.compare_exchange_weak(head, Pack(first, head), std::memory_order_release, std::memory_order_relaxed));
+			}
+
+			Node* PopGlobal()
+			{
+				// Registering as a reader of the current epoch keeps Trim from freeing a node this pop may still read.
+				// The epoch is checked again after registering: a trim that flipped it in between may already have
+				// waited on this counter, so the registration would not be seen.
+				unsigned int epoch = m_epoch.load() & 1U;
+				while(true)
+				{
+					m_readers[epoch].fetch_add(1U);
+					const unsigned int current = m_epoch.load() & 1U;
+					if(current == epoch)
+					{
+						break;
+					}
+					m_readers[epoch].fetch_sub(1U, std::memory_order_release);
+					epoch = current;
+				}
+
+				unsigned long long head = m_head.load();
+				Node* node = Unpack(head);
+				while(nullptr != node &&
+					!m_head.compare_exchange_weak(head, Pack(node->next.load(std::memory_order_relaxed), head), std::memory_order_acquire, std::memory_order_acquire))
+				{
+					node = Unpack(head);
+				}
+
+				m_readers[epoch].fetch_sub(1U, std::memory_order_release);
+				if(nullptr != node)
+				{
+					m_globalCount.fetch_sub(1U, std::memory_order_relaxed);
+				}
+				return node;
+			}
+
+			size_t TrimLocked(const size_t maxFree)
+			{
+				Node* victims = nullptr;
+				size_t count = 0U;
+				for(; count < maxFree; count++)
+				{
+					Node* node = PopGlobal();
+					if(nullptr == node)
+					{
+						break;
+					}
+					node->next.store(victims, std::memory_order_relaxed);
+					victims = node;
+				}
+				if(nullptr == victims)
+				{
+					return 0U;
+				}
+
+				// Pops that started before the flip may still hold one of the victims; wait until they are done.
+				const unsigned int retired = m_epoch.fetch_add(1U) & 1U;
+				Threading::Backoff backoff;
+				while(0U != m_readers[retired].load())
+				{
+					backoff.Pause();
+				}
+
+				FreeChain(victims);
+				m_allocatedCount.fetch_sub(count, std::memory_order_relaxed);
+				m_freedCount.fetch_add(count, std::memory_order_relaxed);
+				return count;
+			}
+
+			Node* NewNode()
+			{
+				Node* node = static_cast<Node*>(::operator new(sizeof(Node)));
+				if(0ULL != (reinterpret_cast<uintptr_t>(node) & ~PointerMask))
+				{
+					::operator delete(node);
+					throw std::bad_alloc();
+				}
+				new(&node->next) std::atomic<Node*>(nullptr);
+				const size_t allocated = m_allocatedCount.fetch_add(1U, std::memory_order_relaxed) + 1U;
+				size_t highWater = m_highWater.load(std::memory_order_relaxed);
+				while(allocated > highWater && !m_highWater.compare_exchange_weak(highWater, allocated, std::memory_order_relaxed))
+				{
+				}
+				return node;
+			}
+
+			static void FreeChain(Node* node)
+			{
+				while(nullptr != node)
+				{
+					Node* next = node->next.load(std::memory_order_relaxed);
+					::operator delete(node);
+					node = next;
+				}
+			}
+
+		private:
+			const size_t m_maxCached;
+			const unsigned int m_batch;
+			Cache m_caches[CacheSlots];
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<unsigned long long> m_head;
+			std::atomic<size_t> m_globalCount;
+			alignas(HELPERS_CACHE_LINE_SIZE) std::atomic<size_t> m_allocatedCount;
+			std::atomic<size_t> m_highWater;
+			std::atomic<unsigned long long> m_freedCount;
+			std::atomic<unsigned long long> m_contendedHits;
+			std::atomic<unsigned long long> m_contendedMisses;
+			std::atomic<unsigned int> m_epoch;
+			std::atomic<unsigned int> m_readers[2];
+			std::mutex m_trimMutex;
+		};
+	}
+
+	namespace Io
+	{
+		/*
+			MappedFile - read-only memory map of a whole file for zero-copy access. Hints are applied with madvise
+			after mapping; Populate pre-faults the mapping (MAP_POPULATE) and HugePages asks for transparent huge
+			pages, which only filesystems supporting them honour. Empty files open with a null Data(). Linux only;
+			elsewhere Open returns false.
+		*/
+		class MappedFile
+		{
+		public:
+			static const unsigned int Sequential = 1U;
+			static const unsigned int Random = 2U;
+			static const unsigned int WillNeed = 4U;
+			static const unsigned int Populate = 8U;
+			static const unsigned int HugePages = 16U;
+
+		public:
+			MappedFile();
+			explicit MappedFile(const std::string& path, const unsigned int hints = Sequential);
+			~MappedFile();
+			bool Open(const std::string& path, const unsigned int hints = Sequential);
+			void Close();
+			bool IsOpen() const;
+			const unsigned char* Data() const;
+			size_t Size() const;
+			// Range hints: start reading a range ahead of use, or drop pages that are no longer needed.
+			void PrefetchRange(const size_t offset, const size_t length) const;
+			void ReleaseRange(const size_t offset, const size_t length) const;
+
+		private:
+			MappedFile(const MappedFile&);
+			MappedFile& operator=(const MappedFile&);
+
+		private:
+			int m_fd;
+			unsigned char* m_data;
+			size_t m_size;
+		};
+
+		/*
+			ChunkedReader - streams a file (or a range of it) through two page-aligned buffers. A background
+			thread reads the next chunk with pread while the caller processes the current one; after the first
+			chunk, reads start on chunk-size boundaries. Works on anything that can be read sequentially,
+			including files that cannot be mapped.
+		*/
+		class ChunkedReader
+		{
+		public:
+			explicit ChunkedReader(const size_t chunkSize = 4U * 1024U * 1024U);
+			~ChunkedReader();
+			bool Open(const std::string& path, const unsigned long long offset = 0ULL, const unsigned long long length = ~0ULL);
+			// Returns the next chunk, valid until the following call; false at the end of the range or on error.
+			bool Next(const unsigned char*& data, size_t& size);
+			bool Failed() const;
+			void Close();
+
+		private:
+			ChunkedReader(const ChunkedReader&);
+			ChunkedReader& operator=(const ChunkedReader&);
+			static void InternalReadFunc(ChunkedReader* reader);
+
+		private:
+			const size_t m_chunkSize;
+			unsigned char* m_buffers[2];
+			size_t m_sizes[2];
+			int m_fd;
+			unsigned long long m_offset;
+			unsigned long long m_remaining;
+			unsigned int m_nextBuffer;
+			bool m_holdingBuffer;
+			bool m_finished;
+			std::atomic<bool> m_failed;
+			std::atomic<bool> m_stopRequested;
+			Threading::Semaphore m_freeBuffers;
+			Threading::Semaphore m_filledBuffers;
+			std::unique_ptr<std::thread> m_readThread;
+		};
+
+		// Calls func(data, size, offset) for consecutive pieces of a file, mapped when possible and streamed
+		// through a ChunkedReader otherwise (including files reporting a size of zero, such as those under /proc);
+		// returns false when the file could not be read.
+		bool ForEachChunk(const std::string& path, const std::function<void(const unsigned char*, size_t, unsigned long long)>& func);
+	} // namespace Io
+
+	/*
+		Log - asynchronous logging with the printf formatting of Text::Stringf. A call copies a timestamp, the
+		format pointer and its arguments in binary form into the calling thread's ring and returns; a background
+		thread merges the rings in timestamp order, formats the lines and writes them with writev. Formats are
+		stored by pointer and must outlive the log (string literals do); %s arguments are copied, up to
+		MaxStringBytes each. Arguments are scalars, pointers and C strings, as for printf.
+	*/
+	namespace Log
+	{
+		enum class Level
+		{
+			Trace,
+			Debug,
+			Info,
+			Warning,
+			Error,
+			Off
+		};
+
+		// What a call does when its thread's ring is full: drop the record (counted by DroppedCount) or wait
+		// for the writer to make room.
+		enum class FullPolicy
+		{
+			Drop,
+			Block
+		};
+
+		void SetLevel(const Level level);
+		Level GetLevel();
+		bool IsEnabled(const Level level);
+		void SetFullPolicy(const FullPolicy policy);
+		FullPolicy GetFullPolicy();
+		// Applies to rings created afterwards, rounded up to a power of two; a record must fit in half a ring.
+		void SetBufferCapacity(const size_t bytes);
+		// File descriptor the writer sends lines to (stdout by default). Flushes before switching.
+		void SetOutput(const int fd);
+		// Returns once every record logged before the call has been written.
+		void Flush();
+		unsigned long long DroppedCount();
+
+		namespace Internal
+		{
+			static const size_t MaxStringBytes = 8192U;
+
+			enum class ArgType : unsigned char
+			{
+				Int,
+				UInt,
+				Double,
+				String,
+				Pointer
+			};
+
+#if defined(__GNUC__)
+			inline void CheckFormat(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+#endif
+			inline void CheckFormat(const char*, ...)
+			{
+			}
+
+			// Reserves a record for the calling thread and returns where its arguments go, or null when it was
+			// dropped; CommitRecord publishes it.
+			unsigned char* BeginRecord(const Level level, const char* fmt, const size_t argBytes);
+			void CommitRecord();
+
+			inline void EncodeWord(unsigned char*& out, const ArgType type, const void* value)
+			{
+				*out++ = static_cast<unsigned char>(type);
+				memcpy(out, value, 8U);
+				out += 8U;
+			}
+
+			inline size_t EncodedSize(const char* str)
+			{
+				return 13U + ((NULL != str) ? strnlen(str, MaxStringBytes) : 0U);
+			}
+
+			template<typename T>
+			inline typename std::enable_if<std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_same<T, std::nullptr_t>::value, size_t>::type EncodedSize(const T)
+			{
+				return 9U;
+			}
+
+			template<typename T>
+			inline typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value, size_t>::type EncodedSize(const T*)
+			{
+				return 9U;
+			}
+
+			// Strings keep their pointer as well, for %p.
+			inline void Encode(unsigned char*& out, const char* str)
+			{
+				const uint32_t length = static_cast<uint32_t>((NULL != str) ? strnlen(str, MaxStringBytes) : 0U);
+				EncodeWord(out, ArgType::String, &str);
+				memcpy(out, &length, 4U);
+				if(length > 0U)
+				{
+					memcpy(out + 4U, str, length);
+				}
+				out += 4U + length;
+			}
+
+			template<typename T>
+			inline typename std::enable_if<std::is_floating_point<T>::value>::type Encode(unsigned char*& out, const T value)
+			{
+				const double converted = static_cast<double>(value);
+				EncodeWord(out, ArgType::Double, &converted);
+			}
+
+			template<typename T>
+			inline typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value>::type Encode(unsigned char*& out, const T value)
+			{
+				if(std::is_signed<T>::value || std::is_enum<T>::value)
+				{
+					const long long converted = static_cast<long long>(value);
+					EncodeWord(out, ArgType::Int, &converted);
+				}
+				else
+				{
+					const unsigned long long converted = static_cast<unsigned long long>(value);
+					EncodeWord(out, ArgType::UInt, &converted);
+				}
+			}
+
+			template<typename T>
+			inline typename std::enable_if<!std::is_same<typename std::remove_cv<T>::type, char>::value>::type Encode(unsigned char*& out, const T* value)
+			{
+				const unsigned long long converted = static_cast<unsigned long long>(reinterpret_cast<uintptr_t>(value));
+				EncodeWord(out, ArgType::Pointer, &converted);
+			}
+
+			inline void Encode(unsigned char*& out, const std::nullptr_t)
+			{
+				const unsigned long long converted = 0ULL;
+				EncodeWord(out, ArgType::Pointer, &converted);
+			}
+
+			inline size_t SumSizes()
+			{
+				return 0U;
+			}
+
+			template<typename... Sizes>
+			inline size_t SumSizes(const size_t first, const Sizes... rest)
+			{
+				return first + SumSizes(rest...);
+			}
+
+			inline void EncodeAll(unsigned char*&)
+			{
+			}
+
+			template<typename T, typename... Args>
+			inline void EncodeAll(unsigned char*& out, const T& first, const Args&... rest)
+			{
+				Encode(out, first);
+				EncodeAll(out, rest...);
+			}
+		}
+
+		// Unfiltered; the HELPERS_LOG macros check the compiled and runtime levels first.
+		template<typename... Args>
+		void Write(const Level level, const char* fmt, const Args&... args)
+		{
+			unsigned char* out = Internal::BeginRecord(level, fmt, Internal::SumSizes(Internal::EncodedSize(args)...));
+			if(NULL != out)
+			{
+				Internal::EncodeAll(out, args...);
+				Internal::CommitRecord();
+			}
+		}
+	} // namespace Log
 }
 
 #endif
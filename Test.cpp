@@ -4,19 +4,54 @@
 */
 
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <sstream>
 #include "Helpers.h"
 
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
 using namespace Helpers;
 
 // Prototypes
 bool Test_Macros();
+bool Test_Bits();
 bool Test_Text();
 bool Test_Random();
 bool Test_Numeric();
+bool Test_Fixed();
 bool Test_Checksum();
+bool Test_Clock();
+bool Test_Wait();
+bool Test_LatencyHistogram();
+bool Test_Trace();
+bool Test_CoarseClock();
 bool Test_Time();
 bool Test_Threading();
+bool Test_TimerService();
+bool Test_ThreadPool();
+bool Test_ParallelAlgorithms();
+bool Test_SpscQueue();
+bool Test_MpmcQueue();
+bool Test_TaskGraph();
+bool Test_ThreadConfig();
+bool Test_Locks();
+bool Test_SyncPrimitives();
+bool Test_Memory();
+bool Test_ObjectPool();
+bool Test_EventLoop();
+bool Test_Io();
+bool Test_Log();
 
 // ----------------------------------------------------------------------
 
@@ -25,6 +60,9 @@ int main(int argc, char* argv[])
 	bool macrosPass = Test_Macros();
 	std::cout << "Test_Macros " << (macrosPass ? "Passed" : "Failed") << "\n";
 
+	bool bitsPass = Test_Bits();
+	std::cout << "Test_Bits " << (bitsPass ? "Passed" : "Failed") << "\n";
+
 	bool textPass = Test_Text();
 	std::cout << "Test_Text " << (textPass ? "Passed" : "Failed") << "\n";
 
@@ -34,14 +72,74 @@ int main(int argc, char* argv[])
 	bool numericPass = Test_Numeric();
 	std::cout << "Test_Numeric " << (numericPass ? "Passed" : "Failed") << "\n";
 
+	bool fixedPass = Test_Fixed();
+	std::cout << "Test_Fixed " << (fixedPass ? "Passed" : "Failed") << "\n";
+
 	bool checksumPass = Test_Checksum();
 	std::cout << "Test_Checksum " << (checksumPass ? "Passed" : "Failed") << "\n";
 
+	bool clockPass = Test_Clock();
+	std::cout << "Test_Clock " << (clockPass ? "Passed" : "Failed") << "\n";
+
+	bool waitPass = Test_Wait();
+	std::cout << "Test_Wait " << (waitPass ? "Passed" : "Failed") << "\n";
+
+	bool latencyHistogramPass = Test_LatencyHistogram();
+	std::cout << "Test_LatencyHistogram " << (latencyHistogramPass ? "Passed" : "Failed") << "\n";
+
+	bool tracePass = Test_Trace();
+	std::cout << "Test_Trace " << (tracePass ? "Passed" : "Failed") << "\n";
+
+	bool coarseClockPass = Test_CoarseClock();
+	std::cout << "Test_CoarseClock " << (coarseClockPass ? "Passed" : "Failed") << "\n";
+
 	bool timePass = Test_Time();
 	std::cout << "Test_Time " << (timePass ? "Passed" : "Failed") << "\n";
 
 	bool threadingPass = Test_Threading();
 	std::cout << "Test_Threading " << (threadingPass ? "Passed" : "Failed") << "\n";
+
+	bool timerServicePass = Test_TimerService();
+	std::cout << "Test_TimerService " << (timerServicePass ? "Passed" : "Failed") << "\n";
+
+	bool threadPoolPass = Test_ThreadPool();
+	std::cout << "Test_ThreadPool " << (threadPoolPass ? "Passed" : "Failed") << "\n";
+
+	bool parallelAlgorithmsPass = Test_ParallelAlgorithms();
+	std::cout << "Test_ParallelAlgorithms " << (parallelAlgorithmsPass ? "Passed" : "Failed") << "\n";
+
+	bool spscQueuePass = Test_SpscQueue();
+	std::cout << "Test_SpscQueue " << (spscQueuePass ? "Passed" : "Failed") << "\n";
+
+	bool mpmcQueuePass = Test_MpmcQueue();
+	std::cout << "Test_MpmcQueue " << (mpmcQueuePass ? "Passed" : "Failed") << "\n";
+
+	bool taskGraphPass = Test_TaskGraph();
+	std::cout << "Test_TaskGraph " << (taskGraphPass ? "Passed" : "Failed") << "\n";
+
+	bool threadConfigPass = Test_ThreadConfig();
+	std::cout << "Test_ThreadConfig " << (threadConfigPass ? "Passed" : "Failed") << "\n";
+
+	bool locksPass = Test_Locks();
+	std::cout << "Test_Locks " << (locksPass ? "Passed" : "Failed") << "\n";
+
+	bool syncPrimitivesPass = Test_SyncPrimitives();
+	std::cout << "Test_SyncPrimitives " << (syncPrimitivesPass ? "Passed" : "Failed") << "\n";
+
+	bool memoryPass = Test_Memory();
+	std::cout << "Test_Memory " << (memoryPass ? "Passed" : "Failed") << "\n";
+
+	bool objectPoolPass = Test_ObjectPool();
+	std::cout << "Test_ObjectPool " << (objectPoolPass ? "Passed" : "Failed") << "\n";
+
+	bool eventLoopPass = Test_EventLoop();
+	std::cout << "Test_EventLoop " << (eventLoopPass ? "Passed" : "Failed") << "\n";
+
+	bool ioPass = Test_Io();
+	std::cout << "Test_Io " << (ioPass ? "Passed" : "Failed") << "\n";
+
+	bool logPass = Test_Log();
+	std::cout << "Test_Log " << (logPass ? "Passed" : "Failed") << "\n";
 	
 	return 0;
 }
@@ -87,6 +185,74 @@ bool Test_Macros()
 	return true;
 }
 
+/*
+ * Test_Bits() test case for the constexpr bit functions in the Helpers::Numeric namespace
+ */
+bool Test_Bits()
+{
+	static_assert(Numeric::IsPowerOf2(64U) && !Numeric::IsPowerOf2(0) && !Numeric::IsPowerOf2(-64), "IsPowerOf2");
+	static_assert(Numeric::NextPow2(17U) == 32U && Numeric::NextPow2(0U) == 1U && Numeric::NextPow2(0x80000001U) == 0U, "NextPow2");
+	static_assert(Numeric::AlignUp(13U, 8U) == 16U && Numeric::AlignDown(13U, 8U) == 8U, "Align");
+	static_assert(Numeric::PopCount(0xF0F0U) == 8 && Numeric::CountLeadingZeros(static_cast<uint16_t>(1)) == 15, "Counts");
+	static_assert(Numeric::CountTrailingZeros(0ULL) == 64 && Numeric::Log2Floor(1000U) == 9 && Numeric::Log2Ceil(1000U) == 10, "Log2");
+	static_assert(Numeric::RotateLeft(static_cast<uint8_t>(0x81), 1) == 0x03 && Numeric::ExtractBits(0xABCDU, 4, 8) == 0xBCU, "Rotate");
+	static_assert(Numeric::ExtractBits(~0ULL, 0, 64) == ~0ULL && Numeric::ExtractBits(~0ULL, 64, 8) == 0ULL && Numeric::DepositBits(5ULL, 1ULL, 64, 4) == 5ULL
+		&& Numeric::DepositBits(0ULL, ~0ULL, 60, 8) == 0xF000000000000000ULL && Numeric::DepositBits(1ULL, 0xABULL, 0, 64) == 0xABULL, "Full width fields");
+	static_assert(Numeric::PopCountPortable(0xFFULL) == 8 && Numeric::CountLeadingZerosPortable(1ULL, 32) == 31, "Portable");
+
+	for(int i = 1; i <= 16; i++)
+	{
+		const int powerOfTwo = 1 << i;
+
+		if(!Numeric::IsPowerOf2(powerOfTwo) || Numeric::IsPowerOf2(powerOfTwo + 1) || Numeric::IsPowerOf2(-powerOfTwo)
+			|| Numeric::IsOdd(powerOfTwo) || !Numeric::IsEven(powerOfTwo) || !Numeric::IsOdd(powerOfTwo - 1))
+		{
+			return false;
+		}
+
+		if(Numeric::NextPow2(powerOfTwo / 2 + 1) != powerOfTwo || Numeric::NextPow2(powerOfTwo) != powerOfTwo
+			|| Numeric::Log2Floor(powerOfTwo + 1) != i || Numeric::Log2Ceil(powerOfTwo + 1) != i + 1)
+		{
+			return false;
+		}
+	}
+
+	for(int i = 0; i < 1000; i++)
+	{
+		const uint64_t value = (static_cast<uint64_t>(Random::Random<uint32_t>(0U, 0xFFFFFFFFU)) << 32) | Random::Random<uint32_t>(0U, 0xFFFFFFFFU);
+		const uint64_t mask = (static_cast<uint64_t>(Random::Random<uint32_t>(0U, 0xFFFFFFFFU)) << 32) | Random::Random<uint32_t>(0U, 0xFFFFFFFFU);
+		const unsigned int rotation = Random::Random<unsigned int>(0U, 127U);
+
+		if(Numeric::PopCount(value) != Numeric::PopCountPortable(value)
+			|| Numeric::CountLeadingZeros(value >> (rotation % 64U)) != Numeric::CountLeadingZerosPortable(value >> (rotation % 64U), 64)
+			|| Numeric::CountTrailingZeros(value << (rotation % 64U)) != Numeric::CountTrailingZerosPortable(value << (rotation % 64U), 64))
+		{
+			return false;
+		}
+
+		if(Numeric::RotateRight(Numeric::RotateLeft(value, rotation), rotation) != value
+			|| !Numeric::IsAligned(Numeric::AlignUp(value >> 1, static_cast<uint64_t>(4096)), static_cast<uint64_t>(4096))
+			|| Numeric::AlignUp(value >> 1, static_cast<uint64_t>(4096)) - (value >> 1) >= 4096U)
+		{
+			return false;
+		}
+
+		if(Numeric::ParallelDeposit(Numeric::ParallelExtract(value, mask), mask) != (value & mask)
+			|| Numeric::PopCount(Numeric::ParallelExtract(value, mask)) != Numeric::PopCount(value & mask)
+			|| Numeric::ParallelExtract(static_cast<uint32_t>(value), static_cast<uint32_t>(mask)) != static_cast<uint32_t>(Numeric::ParallelExtract<uint64_t>(value & 0xFFFFFFFFU, mask & 0xFFFFFFFFU)))
+		{
+			return false;
+		}
+
+		if(Numeric::ExtractBits(Numeric::DepositBits(value, mask, rotation % 48U, 16U), rotation % 48U, 16U) != (mask & 0xFFFFULL))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /*
  * Test_Text() test case for the Helpers::Text namespace
  */
@@ -169,6 +335,151 @@ bool Test_Numeric()
 		return false;
 	}
 
+	if(0x12345678U != Numeric::DecToBCD32(12345678U) || 12345678U != Numeric::BCDToDec32(0x12345678U)
+		|| 0x99999999U != Numeric::DecToBCD32(99999999U) || 0x00000100U != Numeric::DecToBCD32(100U))
+	{
+		return false;
+	}
+
+	if(0x1234567890123456ULL != Numeric::DecToBCD64(1234567890123456ULL) || 9999999999999999ULL != Numeric::BCDToDec64(0x9999999999999999ULL))
+	{
+		return false;
+	}
+
+	if(!Numeric::IsValidBCD32(0x09909909U) || Numeric::IsValidBCD32(0x1234567AU) || Numeric::IsValidBCD64(0xA000000000000000ULL))
+	{
+		return false;
+	}
+
+	std::vector<uint64_t> decimals(515);
+	for(uint64_t& decimal : decimals)
+	{
+		decimal = static_cast<uint64_t>(Random::Random<uint32_t>(0U, 99999999U)) * 100000000ULL + Random::Random<uint32_t>(0U, 99999999U);
+	}
+
+	std::vector<uint64_t> packed64(decimals.size());
+	std::vector<uint64_t> unpacked64(decimals.size());
+	Numeric::DecToBCD64Array(&decimals[0], &packed64[0], decimals.size());
+	if(!Numeric::BCDToDec64Array(&packed64[0], &unpacked64[0], packed64.size()) || unpacked64 != decimals)
+	{
+		return false;
+	}
+
+	std::vector<uint32_t> decimals32(decimals.size());
+	std::vector<uint32_t> packed32(decimals.size());
+	std::vector<uint32_t> unpacked32(decimals.size());
+	for(size_t i = 0; i < decimals.size(); i++)
+	{
+		decimals32[i] = static_cast<uint32_t>(decimals[i] % 100000000ULL);
+	}
+	Numeric::DecToBCD32Array(&decimals32[0], &packed32[0], decimals32.size());
+	if(!Numeric::BCDToDec32Array(&packed32[0], &unpacked32[0], packed32.size()) || unpacked32 != decimals32)
+	{
+		return false;
+	}
+
+	packed32[packed32.size() / 2] |= 0x0000000FU;
+	if(Numeric::BCDToDec32Array(&packed32[0], &unpacked32[0], packed32.size()) || Numeric::IsValidBCD(&packed32[0], packed32.size() * sizeof(uint32_t)))
+	{
+		return false;
+	}
+
+	std::vector<uint8_t> decimalBytes(100 * 3 + 7);
+	std::vector<uint8_t> bcdBytes(decimalBytes.size());
+	for(size_t i = 0; i < decimalBytes.size(); i++)
+	{
+		decimalBytes[i] = static_cast<uint8_t>(i % 100);
+	}
+	std::vector<uint8_t> decodedBytes(decimalBytes.size());
+	if(!Numeric::DecToBCDBytes(&decimalBytes[0], &bcdBytes[0], decimalBytes.size())
+		|| !Numeric::IsValidBCD(&bcdBytes[0], bcdBytes.size())
+		|| !Numeric::BCDToDecBytes(&bcdBytes[0], &decodedBytes[0], bcdBytes.size())
+		|| decodedBytes != decimalBytes || 0x99 != bcdBytes[99])
+	{
+		return false;
+	}
+
+	decimalBytes[17] = 100;
+	if(Numeric::DecToBCDBytes(&decimalBytes[0], &bcdBytes[0], decimalBytes.size()))
+	{
+		return false;
+	}
+
+	if(Numeric::IsDoubleEqual(1.0, -1.0) || !Numeric::IsDoubleEqual(1.0, 1.0000001) || Numeric::IsNearlyEqualAbs(0.5f, 0.7f, 0.1f))
+	{
+		return false;
+	}
+
+	if(!Numeric::IsNearlyEqualRel(1.0e9, 1.0e9 + 1.0, 1.0e-8) || Numeric::IsNearlyEqualRel(1.0e-9, 2.0e-9, 1.0e-8)
+		|| Numeric::IsNearlyEqualRel(std::nan(""), std::nan(""), 1.0))
+	{
+		return false;
+	}
+
+	const double infinity = std::numeric_limits<double>::infinity();
+	if(Numeric::IsNearlyEqualRel(infinity, 1.0, 1.0e-9) || Numeric::IsNearlyEqualRel(infinity, -infinity, 1.0e-9)
+		|| Numeric::IsNearlyEqualRel(1.0, -infinity, 1.0e-9, 1.0) || !Numeric::IsNearlyEqualRel(infinity, infinity, 1.0e-9)
+		|| Numeric::IsNearlyEqualRel(std::numeric_limits<float>::infinity(), 1.0f, 1.0e-6f))
+	{
+		return false;
+	}
+
+	if(1U != Numeric::UlpDistance(1.0, std::nextafter(1.0, 2.0)) || 0U != Numeric::UlpDistance(0.0f, -0.0f)
+		|| 2U != Numeric::UlpDistance(std::nextafter(0.0f, 1.0f), std::nextafter(0.0f, -1.0f))
+		|| !Numeric::IsNearlyEqualUlps(1.0f, std::nextafter(1.0f, 0.0f), 1U) || Numeric::IsNearlyEqualUlps(1.0, -1.0, 1000U))
+	{
+		return false;
+	}
+
+	std::vector<double> expected(1001);
+	std::vector<float> expectedFloat(expected.size());
+	for(size_t i = 0; i < expected.size(); i++)
+	{
+		expected[i] = static_cast<double>(Random::Random<int>(-1000000, 1000000)) / 1000.0;
+		expectedFloat[i] = static_cast<float>(expected[i]);
+	}
+	std::vector<double> actual(expected);
+	std::vector<float> actualFloat(expectedFloat);
+	actual[5] *= 1.0 + 1.0e-12;
+
+	if(!Numeric::AllClose(&actual[0], &expected[0], actual.size(), 1.0e-9) || !Numeric::AllClose(&actualFloat[0], &expectedFloat[0], actualFloat.size(), 1.0e-6f))
+	{
+		return false;
+	}
+
+	actual[998] = -actual[998] - 1.0;
+	actual[333] = std::nan("");
+	actualFloat[1000] += 1.0f;
+	actualFloat[7] = -actualFloat[7] - 1.0f;
+
+	if(Numeric::AllClose(&actual[0], &expected[0], actual.size(), 1.0e-9) || 333U != Numeric::FirstMismatch(&actual[0], &expected[0], actual.size(), 1.0e-9)
+		|| 2U != Numeric::CountMismatches(&actual[0], &expected[0], actual.size(), 1.0e-9)
+		|| 7U != Numeric::FirstMismatch(&actualFloat[0], &expectedFloat[0], actualFloat.size(), 1.0e-6f)
+		|| 2U != Numeric::CountMismatches(&actualFloat[0], &expectedFloat[0], actualFloat.size(), 1.0e-6f))
+	{
+		return false;
+	}
+
+	// Infinities in every vector lane position: equal infinities match, anything else involving one does not.
+	std::vector<double> infinite(17, 1.0);
+	std::vector<double> infiniteOther(17, 1.0);
+	std::vector<float> infiniteFloat(17, 1.0f);
+	std::vector<float> infiniteFloatOther(17, 1.0f);
+	for(size_t i = 0; i < infinite.size(); i += 3)
+	{
+		infinite[i] = infinity;
+		infiniteOther[i] = (0U == i % 2U) ? infinity : ((9U == i) ? -infinity : 2.0e300);
+		infiniteFloat[i] = std::numeric_limits<float>::infinity();
+		infiniteFloatOther[i] = (0U == i % 2U) ? infiniteFloat[i] : -infiniteFloat[i];
+	}
+	if(3U != Numeric::CountMismatches(&infinite[0], &infiniteOther[0], infinite.size(), 1.0e-9)
+		|| 3U != Numeric::FirstMismatch(&infinite[0], &infiniteOther[0], infinite.size(), 1.0e-9)
+		|| 3U != Numeric::CountMismatches(&infiniteFloat[0], &infiniteFloatOther[0], infiniteFloat.size(), 1.0e-6f)
+		|| !Numeric::AllClose(&infinite[0], &infinite[0], infinite.size(), 1.0e-9))
+	{
+		return false;
+	}
+
 	uint16_t bitReflectedTestValue16 = 0x8005;
 	uint16_t testValue16 = 0xA001;
 
@@ -185,96 +496,172 @@ bool Test_Numeric()
 		return false;
 	}
 
-	return true;
-}
-
-/*
- * Test_Checksum() test case for the Helpers::Checksum namespace
- */
-bool Test_Checksum()
-{
-	std::string testString = "testing 123 456";
-	std::string testStringAppend = "789";
-
-	uint32_t crc32 = Checksum::CRC32::Calculate(testString.c_str(), testString.length(), CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
-
-	if(0x19C09AA3 != crc32)
+	if(0x80 != Numeric::BitReflect8(0x01) || 0x05 != Numeric::BitReflect8(0xA0))
 	{
 		return false;
 	}
 
-	crc32 = Checksum::CRC32::Recalculate(crc32, testStringAppend.c_str(), testStringAppend.length(), CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+	if(0x04C11DB700000000ULL != Numeric::BitReflect64(0xEDB88320ULL))
+	{
+		return false;
+	}
 
-	if(0x5D0B5DF4 != crc32)
+	if(0x2211 != Numeric::ByteSwap16(0x1122) || 0x44332211U != Numeric::ByteSwap32(0x11223344U)
+		|| 0x8877665544332211ULL != Numeric::ByteSwap64(0x1122334455667788ULL))
 	{
 		return false;
 	}
 
-	uint16_t crc16 = Checksum::CRC16::Calculate(testString.c_str(), testString.length(), CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+	// Odd lengths exercise both the vector body and the scalar tail of the bulk kernels.
+	std::vector<uint64_t> samples(1027);
+	for(uint64_t& sample : samples)
+	{
+		sample = (static_cast<uint64_t>(Random::Random<uint32_t>(0U, 0xFFFFFFFFU)) << 32) | Random::Random<uint32_t>(0U, 0xFFFFFFFFU);
+	}
 
-	if(0xDF98 != crc16)
+	std::vector<uint8_t> bytes(reinterpret_cast<const uint8_t*>(&samples[0]), reinterpret_cast<const uint8_t*>(&samples[0]) + 1021);
+	Numeric::BitReflectBytes(&bytes[0], bytes.size());
+	for(size_t i = 0; i < bytes.size(); i++)
 	{
-		return false;
+		if(bytes[i] != Numeric::BitReflect8(reinterpret_cast<const uint8_t*>(&samples[0])[i]))
+		{
+			return false;
+		}
 	}
 
-	crc16 = Checksum::CRC16::Recalculate(crc16, testStringAppend.c_str(), testStringAppend.length(), CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+	std::vector<uint16_t> words16(samples.begin(), samples.end());
+	std::vector<uint16_t> reflected16(words16);
+	std::vector<uint16_t> swapped16(words16);
+	Numeric::BitReflect16Array(&reflected16[0], reflected16.size());
+	Numeric::ByteSwap16Array(&swapped16[0], swapped16.size());
+	for(size_t i = 0; i < words16.size(); i++)
+	{
+		if(reflected16[i] != Numeric::BitReflect16(words16[i]) || swapped16[i] != Numeric::ByteSwap16(words16[i]))
+		{
+			return false;
+		}
+	}
 
-	if(0xC3BB != crc16)
+	std::vector<uint32_t> words32(samples.begin(), samples.end());
+	std::vector<uint32_t> reflected32(words32);
+	std::vector<uint32_t> swapped32(words32);
+	Numeric::BitReflect32Array(&reflected32[0], reflected32.size());
+	Numeric::ByteSwap32Array(&swapped32[0], swapped32.size());
+	for(size_t i = 0; i < words32.size(); i++)
 	{
-		return false;
+		if(reflected32[i] != Numeric::BitReflect32(words32[i]) || swapped32[i] != Numeric::ByteSwap32(words32[i]))
+		{
+			return false;
+		}
+	}
+
+	std::vector<uint64_t> reflected64(samples);
+	std::vector<uint64_t> swapped64(samples);
+	Numeric::BitReflect64Array(&reflected64[0], reflected64.size());
+	Numeric::ByteSwap64Array(&swapped64[0], swapped64.size());
+	for(size_t i = 0; i < samples.size(); i++)
+	{
+		if(reflected64[i] != Numeric::BitReflect64(samples[i]) || swapped64[i] != Numeric::ByteSwap64(samples[i])
+			|| Numeric::BitReflect64(reflected64[i]) != samples[i])
+		{
+			return false;
+		}
 	}
 
 	return true;
 }
 
 /*
- * Test_Time() test case for the Helpers::Time namespace
+ * Test_Fixed() test case for the Helpers::Numeric::Fixed fixed-point type
  */
-bool Test_Time()
+bool Test_Fixed()
 {
-	Time::Stopwatch stopwatchTest;
-
-	long long timeToWraparound = std::numeric_limits<long long>::max() - Time::Micros();
-	timeToWraparound /= 1000LL;
-	timeToWraparound += 100LL;
+	typedef Numeric::Q15_16 Q;
 
-	std::cout << "timeToWraparound = " << timeToWraparound << "\n";
+	const Q half = Q::FromDouble(0.5);
+	const Q three = Q::FromInt(3);
 
-	for(unsigned int count = 0; count <= static_cast<unsigned int>(timeToWraparound) / 10; count++)
+	if(half.Raw() != 0x8000 || three.Raw() != 0x30000 || (three * half).ToDouble() != 1.5 || (half / three).Raw() != 0x2AAA)
 	{
-		Time::WaitMillis(10);
+		return false;
 	}
 
-	std::cout << "timeWaited = " << stopwatchTest.GetMillis() << "\n";
-
-	std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-	long long micros = stopwatchTest;
-
-	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	if((three - Q::FromDouble(3.25)).ToInt() != -1 || Q::FromDouble(-2.5).ToInt() != -3 || (-three).ToInt() != -3)
+	{
+		return false;
+	}
 
-	if(stopwatchTest <= micros)
+	// Saturating operators clamp at the format limits; the wrapping functions roll over.
+	if(Q::Max() + Q::Epsilon() != Q::Max() || Q::Min() - Q::Epsilon() != Q::Min() || Q::FromInt(40000) != Q::Max()
+		|| Q::WrappingAdd(Q::Max(), Q::Epsilon()) != Q::Min() || three / Q() != Q::Max() || -three / Q() != Q::Min())
 	{
 		return false;
 	}
 
-	double seconds = stopwatchTest.GetSeconds();
+	typedef Numeric::Q0_15 Q15;
+	if(Q15::FromDouble(1.0) != Q15::Max() || Q15::FromInt(-1).Raw() != -32768
+		|| Q15::SaturatingMul(Q15::Min(), Q15::Min()) != Q15::Max() || Q15::WrappingMul(Q15::Min(), Q15::Min()) != Q15::Min())
+	{
+		return false;
+	}
 
-	if(!(micros < Time::SecondsToMicros(seconds)))
+	typedef Numeric::Fixed<3, 4, int8_t> Narrow;
+	if(Narrow::RawMax() != 127 || Narrow::WrappingAdd(Narrow::FromInt(7), Narrow::FromInt(1)).ToInt() != -8
+		|| Narrow::FromDouble(0.4375).Raw() != 7)
 	{
 		return false;
 	}
 
-	stopwatchTest = 0;
+	typedef Numeric::Fixed<4, 4, uint8_t> Unsigned;
+	if(Unsigned::SaturatingSub(Unsigned::FromInt(1), Unsigned::FromInt(2)) != Unsigned::Min() || Unsigned::FromInt(16) != Unsigned::Max()
+		|| Unsigned::WrappingSub(Unsigned::FromInt(1), Unsigned::FromInt(2)).ToInt() != 15
+		|| Unsigned::FromInt(3) / Unsigned() != Unsigned::Max() || Unsigned::WrappingDiv(Unsigned(), Unsigned()) != Unsigned::Max())
+	{
+		return false;
+	}
 
-	if(stopwatchTest.HasExceded(1000 * 250) || stopwatchTest >= 0.250)
+	// Full-width 64 bit formats, whose integer limits reach (or pass) those of long long.
+	typedef Numeric::Fixed<64, 0, uint64_t> Wide;
+	typedef Numeric::Fixed<63, 0, int64_t> SignedWide;
+	if(Wide::FromInt(5).Raw() != 5U || Wide::FromInt(std::numeric_limits<long long>::max()).Raw() != static_cast<uint64_t>(std::numeric_limits<long long>::max())
+		|| Wide::FromInt(-1) != Wide::Min() || SignedWide::FromInt(std::numeric_limits<long long>::min()) != SignedWide::Min()
+		|| SignedWide::FromInt(std::numeric_limits<long long>::max()) != SignedWide::Max() || SignedWide::FromInt(-7).ToInt() != -7)
 	{
 		return false;
 	}
 
-	std::this_thread::sleep_for(std::chrono::milliseconds(251));
+	std::vector<double> samples(257);
+	std::vector<double> coefficients(samples.size());
+	double expectedDot = 0.0;
+	for(size_t i = 0; i < samples.size(); i++)
+	{
+		samples[i] = static_cast<double>(Random::Random<int>(-65536, 65536)) / 65536.0;
+		coefficients[i] = static_cast<double>(Random::Random<int>(-256, 256)) / 1024.0;
+		expectedDot += samples[i] * coefficients[i];
+	}
 
-	if(!stopwatchTest.HasExceded(1000 * 250) || stopwatchTest <= 0.250)
+	std::vector<Q> fixedSamples(samples.size());
+	std::vector<Q> fixedCoefficients(samples.size());
+	std::vector<Q> fixedSum(samples.size());
+	std::vector<Q> fixedProduct(samples.size());
+	std::vector<double> roundTrip(samples.size());
+	Numeric::FixedFromDoubleArray(&samples[0], &fixedSamples[0], samples.size());
+	Numeric::FixedFromDoubleArray(&coefficients[0], &fixedCoefficients[0], coefficients.size());
+	Numeric::FixedToDoubleArray(&fixedSamples[0], &roundTrip[0], fixedSamples.size());
+	Numeric::FixedAddArray(&fixedSamples[0], &fixedCoefficients[0], &fixedSum[0], samples.size());
+	Numeric::FixedMulArray(&fixedSamples[0], &fixedCoefficients[0], &fixedProduct[0], samples.size());
+
+	for(size_t i = 0; i < samples.size(); i++)
+	{
+		if(roundTrip[i] != samples[i] || fixedSum[i] != fixedSamples[i] + fixedCoefficients[i]
+			|| std::fabs(fixedProduct[i].ToDouble() - samples[i] * coefficients[i]) > Q::Epsilon().ToDouble())
+		{
+			return false;
+		}
+	}
+
+	// Exact products are accumulated, so the dot product is within one rounding step of the double result.
+	if(std::fabs(Numeric::FixedDot(&fixedSamples[0], &fixedCoefficients[0], samples.size()).ToDouble() - expectedDot) > Q::Epsilon().ToDouble())
 	{
 		return false;
 	}
@@ -283,37 +670,2228 @@ bool Test_Time()
 }
 
 /*
- * Test_Thredding() test case for the Helpers::Threading namespace
+ * Test_Checksum() test case for the Helpers::Checksum namespace
  */
-bool Test_Threading()
+bool Test_Checksum()
 {
-	long long beganAtMillis = Time::Millis();
-	unsigned int timerTickCount = 0;
-	unsigned int timerInterval = 123;
-	Threading::Timer timerTest;
+	std::string testString = "testing 123 456";
+	std::string testStringAppend = "789";
 
-	timerTest.Begin(timerInterval,
-		[&](Threading::Timer* timerPtr, void* arg) -> bool{
-			unsigned int* timerTickCountPtr = (unsigned int*)arg;
-			*timerTickCountPtr = *timerTickCountPtr + 1;
-			if(*timerTickCountPtr == 3)
-			{
-				return false;
-			}
-			return true;
-		},
-	&timerTickCount);
+	uint32_t crc32 = Checksum::CRC32::Calculate(testString.c_str(), testString.length(), CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
 
-	while(timerTest.Running())
+	if(0x19C09AA3 != crc32)
 	{
-		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		return false;
 	}
 
-	if(timerTickCount != 3 || Time::Millis() - beganAtMillis > timerTickCount * timerInterval)
+	crc32 = Checksum::CRC32::Recalculate(crc32, testStringAppend.c_str(), testStringAppend.length(), CRC32_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+
+	if(0x5D0B5DF4 != crc32)
 	{
 		return false;
 	}
 
-	return true;
-}
+	uint16_t crc16 = Checksum::CRC16::Calculate(testString.c_str(), testString.length(), CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
 
+	if(0xDF98 != crc16)
+	{
+		return false;
+	}
+
+	crc16 = Checksum::CRC16::Recalculate(crc16, testStringAppend.c_str(), testStringAppend.length(), CRC16_DEFAULT_BIT_REFLECTED_POLYNOMIAL);
+
+	if(0xC3BB != crc16)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_Clock() test case for the nanosecond clock in the Helpers::Time namespace
+ */
+bool Test_Clock()
+{
+	std::cout << "tscClock = " << Time::IsTscClock() << ", ticksPerSecond = " << Time::TicksPerSecond() << "\n";
+
+	long long previous = Time::Nanos();
+	for(int i = 0; i < 100000; i++)
+	{
+		const long long now = Time::Nanos();
+		if(now < previous)
+		{
+			return false;
+		}
+		previous = now;
+	}
+
+	const std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+	const long long beganNanos = Time::Nanos();
+	const unsigned long long beganTicks = Time::Ticks();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	const unsigned long long elapsedTicks = Time::Ticks() - beganTicks;
+	const long long elapsedNanos = Time::Nanos() - beganNanos;
+	const long long reference = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - began).count();
+
+	// Allow for the reads not being simultaneous plus a generous calibration error.
+	if(std::llabs(elapsedNanos - reference) > 100000LL + reference / 1000LL
+		|| std::llabs(Time::TicksToNanos(elapsedTicks) - elapsedNanos) > 100000LL)
+	{
+		return false;
+	}
+
+	if(std::llabs(Time::Micros() - Time::Nanos() / 1000LL) > 1000LL)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_Wait() test case for the sleep-then-spin waits in the Helpers::Time namespace
+ */
+bool Test_Wait()
+{
+	if(Time::CalibrateWaitSpin() <= 0 || Time::GetWaitSpinNanos() <= 0)
+	{
+		return false;
+	}
+
+	long long totalLateness = 0;
+
+	for(int i = 0; i < 20; i++)
+	{
+		const std::chrono::steady_clock::time_point began = std::chrono::steady_clock::now();
+		Time::WaitMicros(500);
+		const long long waited = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - began).count();
+
+		if(waited < 500)
+		{
+			return false;
+		}
+		totalLateness += waited - 500;
+	}
+
+	if(totalLateness / 20 > 200)
+	{
+		return false;
+	}
+
+	// Most of a long wait is spent asleep rather than burning the core.
+	const std::clock_t cpuBegan = std::clock();
+	Time::WaitMillis(200);
+	if(std::clock() - cpuBegan > CLOCKS_PER_SEC / 20)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_LatencyHistogram() test case for Helpers::Time::LatencyHistogram
+ */
+bool Test_LatencyHistogram()
+{
+	Time::LatencyHistogram histogram;
+
+	for(long long value = 1; value <= 100000; value++)
+	{
+		histogram.Record(value);
+	}
+
+	// The default precision keeps reported values within 1/128 of the true percentile.
+	if(histogram.Count() != 100000ULL || histogram.Min() != 1 || histogram.Max() != 100000 || histogram.Mean() != 50000.5
+		|| std::llabs(histogram.Percentile(50.0) - 50000) > 50000 / 128 || std::llabs(histogram.Percentile(99.9) - 99900) > 99900 / 128
+		|| histogram.Percentile(100.0) != 100000 || histogram.Percentile(0.0) != 1)
+	{
+		return false;
+	}
+
+	Time::LatencyHistogram shared;
+	Time::LatencyHistogram merged;
+	std::vector<std::thread> recorders;
+
+	for(int t = 0; t < 4; t++)
+	{
+		recorders.push_back(std::thread([&shared, &merged, t]() {
+			Time::LatencyHistogram local;
+			for(long long value = 0; value < 50000; value++)
+			{
+				shared.Record(value * (t + 1));
+				local.Record(value * (t + 1));
+			}
+			merged.Merge(local);
+		}));
+	}
+	for(std::thread& recorder : recorders)
+	{
+		recorder.join();
+	}
+
+	if(shared.Count() != 200000ULL || merged.Count() != shared.Count() || merged.Max() != 49999LL * 4
+		|| merged.Percentile(99.0) != shared.Percentile(99.0) || merged.ToJson() != shared.ToJson())
+	{
+		return false;
+	}
+
+	Time::LatencyHistogram scoped;
+	{
+		Time::ScopedLatency latency(scoped);
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	Time::Stopwatch stopwatch;
+	std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	scoped.RecordElapsed(stopwatch);
+
+	if(scoped.Count() != 2ULL || scoped.Min() < 2000000LL || scoped.Max() > 1000000000LL || !Text::StringBeginsWith(scoped.ToJson(), "{\"count\":2,"))
+	{
+		return false;
+	}
+
+	std::cout << "latency " << histogram.ToString("us") << "\n";
+
+	return true;
+}
+
+static size_t CountOccurrences(const std::string& text, const std::string& pattern)
+{
+	size_t count = 0;
+	for(size_t at = text.find(pattern); at != std::string::npos; at = text.find(pattern, at + pattern.size()))
+	{
+		count++;
+	}
+	return count;
+}
+
+/*
+ * Test_Trace() test case for Helpers::Time::TraceScope
+ */
+bool Test_Trace()
+{
+	{
+		Time::TraceScope disabled("disabled");
+	}
+
+	Time::SetTraceEnabled(true);
+
+	std::vector<std::thread> workers;
+	for(int t = 0; t < 3; t++)
+	{
+		workers.push_back(std::thread([]() {
+			for(int i = 0; i < 100; i++)
+			{
+				Time::TraceScope span("worker");
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	{
+		Time::TraceScope outer("main \"outer\"");
+		Time::WaitMicros(50);
+	}
+
+	std::string json = Time::DrainTraceJson();
+	if(!Text::StringBeginsWith(json, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[{") || CountOccurrences(json, "\"ph\":\"X\"") != 301U
+		|| CountOccurrences(json, "\"name\":\"worker\"") != 300U || json.find("\"name\":\"main \\\"outer\\\"\"") == std::string::npos
+		|| json.find("disabled") != std::string::npos)
+	{
+		return false;
+	}
+
+	// Drained events are consumed.
+	if(Time::DrainTraceJson() != "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[]}")
+	{
+		return false;
+	}
+
+	// A full ring drops new spans instead of blocking the recording thread.
+	const unsigned long long droppedBefore = Time::TraceDroppedCount();
+	Time::SetTraceBufferCapacity(4);
+	std::thread([]() {
+		for(int i = 0; i < 10; i++)
+		{
+			Time::TraceScope span("small");
+		}
+	}).join();
+	Time::SetTraceBufferCapacity(16384);
+
+	if(Time::TraceDroppedCount() - droppedBefore != 6ULL || CountOccurrences(Time::DrainTraceJson(), "\"name\":\"small\"") != 4U)
+	{
+		return false;
+	}
+
+	const int spans = 10000;
+	const long long began = Time::Nanos();
+	for(int i = 0; i < spans; i++)
+	{
+		Time::TraceScope span("overhead");
+	}
+	std::cout << "trace span " << (Time::Nanos() - began) / spans << "ns\n";
+	Time::SetTraceEnabled(false);
+
+	if(CountOccurrences(Time::DrainTraceJson(), "\"name\":\"overhead\"") != static_cast<size_t>(spans))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_CoarseClock() test case for Helpers::Time::CoarseClock
+ */
+bool Test_CoarseClock()
+{
+	Time::CoarseClock::Source sources[] = { Time::CoarseClock::Source::Thread, Time::CoarseClock::Source::Kernel };
+
+	for(const Time::CoarseClock::Source source : sources)
+	{
+		Time::CoarseClock clock(1000LL, source);
+		long long previous = clock.Nanos();
+		long long maxLag = 0;
+		Time::Stopwatch sampling;
+
+		while(sampling.GetMillis() < 20LL)
+		{
+			const long long now = clock.ReferenceNanos();
+			const long long coarse = clock.Nanos();
+			if(coarse < previous || coarse > clock.ReferenceNanos())
+			{
+				return false;
+			}
+			maxLag = std::max(maxLag, now - coarse);
+			previous = coarse;
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+		}
+
+		// Let a late update land so that its gap is accounted, and allow for the sampling thread itself being
+		// descheduled between its two reads.
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		if(maxLag > clock.MaxStalenessNanos() + 1000000LL)
+		{
+			return false;
+		}
+
+		std::cout << "coarse " << (Time::CoarseClock::Source::Thread == clock.GetSource() ? "thread" : "kernel")
+			<< " tick=" << clock.TickNanos() << "ns maxStaleness=" << clock.MaxStalenessNanos() << "ns observedLag=" << maxLag << "ns\n";
+	}
+
+	Time::CoarseClock clock(1000000LL);
+	Time::WaitMillis(5);
+	const long long before = clock.Nanos();
+	clock.Refresh();
+	if(clock.Nanos() - before < 4000000LL || Time::Nanos() - clock.Nanos() > 1000000LL || clock.ReferenceNanos() < clock.Nanos())
+	{
+		return false;
+	}
+
+	return std::llabs(Time::CoarseClock::Global().Millis() - Time::Millis()) <= 5LL;
+}
+
+/*
+ * Test_Time() test case for the Helpers::Time namespace
+ */
+bool Test_Time()
+{
+	Time::Stopwatch stopwatchTest;
+
+	long long timeToWraparound = std::numeric_limits<long long>::max() - Time::Micros();
+	timeToWraparound /= 1000LL;
+	timeToWraparound += 100LL;
+
+	std::cout << "timeToWraparound = " << timeToWraparound << "\n";
+
+	for(unsigned int count = 0; count <= static_cast<unsigned int>(timeToWraparound) / 10; count++)
+	{
+		Time::WaitMillis(10);
+	}
+
+	std::cout << "timeWaited = " << stopwatchTest.GetMillis() << "\n";
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	long long micros = stopwatchTest;
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+	if(stopwatchTest <= micros)
+	{
+		return false;
+	}
+
+	double seconds = stopwatchTest.GetSeconds();
+
+	if(!(micros < Time::SecondsToMicros(seconds)))
+	{
+		return false;
+	}
+
+	stopwatchTest = 0;
+
+	if(stopwatchTest.HasExceded(1000 * 250) || stopwatchTest >= 0.250)
+	{
+		return false;
+	}
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(251));
+
+	if(!stopwatchTest.HasExceded(1000 * 250) || stopwatchTest <= 0.250)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_Thredding() test case for the Helpers::Threading namespace
+ */
+bool Test_Threading()
+{
+	long long beganAtMillis = Time::Millis();
+	unsigned int timerTickCount = 0;
+	unsigned int timerInterval = 123;
+	Threading::Timer timerTest;
+
+	timerTest.Begin(timerInterval,
+		[&](Threading::Timer* timerPtr, void* arg) -> bool{
+			unsigned int* timerTickCountPtr = (unsigned int*)arg;
+			*timerTickCountPtr = *timerTickCountPtr + 1;
+			if(*timerTickCountPtr == 3)
+			{
+				return false;
+			}
+			return true;
+		},
+	&timerTickCount);
+
+	while(timerTest.Running())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	if(timerTickCount != 3 || Time::Millis() - beganAtMillis > timerTickCount * timerInterval)
+	{
+		return false;
+	}
+
+	// Fixed-rate ticks stay on the start + n * interval grid even though each callback takes a third of the period.
+	std::vector<long long> tickNanos;
+	timerTest.BeginMicros(1000LL,
+		[&tickNanos](Threading::Timer*, void*) -> bool {
+			tickNanos.push_back(Time::Nanos());
+			Time::WaitMicros(300);
+			return tickNanos.size() < 200U;
+		});
+
+	while(timerTest.Running())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	Threading::Timer::Stats stats = timerTest.GetStats();
+	const long long spanNanos = tickNanos.back() - tickNanos.front();
+	std::cout << "fixed-rate 1kHz span=" << spanNanos << "ns maxJitter=" << stats.maxJitterNanos << "ns meanJitter="
+		<< stats.meanJitterNanos << "ns missed=" << stats.missed << "\n";
+
+	// Preemption may cost skipped ticks, but every tick still starts on the grid to within the jitter.
+	const long long gridNanos = 1000000LL * (199LL + static_cast<long long>(stats.missed));
+	if(tickNanos.size() != 200U || stats.ticks != 199ULL || stats.maxCallbackNanos < 290000LL
+		|| std::llabs(spanNanos - gridNanos) > stats.maxJitterNanos)
+	{
+		return false;
+	}
+
+	// A callback that overruns by two and a half periods makes the Skip policy drop the deadlines it missed.
+	unsigned int overrunTicks = 0;
+	timerTest.BeginMicros(1000LL,
+		[&overrunTicks](Threading::Timer*, void*) -> bool {
+			if(++overrunTicks == 3U)
+			{
+				Time::WaitMicros(2500);
+			}
+			return overrunTicks < 6U;
+		}, nullptr, Threading::Timer::Schedule::FixedRate, Threading::Timer::MissedTicks::Skip);
+
+	while(timerTest.Running())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+
+	stats = timerTest.GetStats();
+	if(overrunTicks != 6U || stats.overruns < 1ULL || stats.missed < 2ULL || stats.maxCallbackNanos < 2400000LL)
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/*
+ * Test_TimerService() test case for Helpers::Threading::TimerService
+ */
+bool Test_TimerService()
+{
+	// A 10 us resolution puts delays of a few milliseconds and of a second on the second and third wheel
+	// levels, so these timers only fire on time if cascading works.
+	Threading::TimerService service(2U, 10LL);
+	const int timerCount = 2000;
+	std::atomic<int> fired(0);
+	std::atomic<long long> earliestNanos(std::numeric_limits<long long>::max());
+	std::atomic<long long> latestNanos(std::numeric_limits<long long>::min());
+	std::vector<long long> dueNanos(timerCount);
+	std::vector<Threading::TimerService::Handle> handles(timerCount);
+
+	for(int i = 0; i < timerCount; i++)
+	{
+		const long long delayMicros = (i % 3 == 0) ? 1000000LL : 200LL + (i * 13 % 5000);
+		dueNanos[i] = Time::Nanos() + (delayMicros * 1000LL);
+		handles[i] = service.ScheduleOnce(delayMicros,
+			[&, i](Threading::Timer* timer, void*) -> bool {
+				const long long offset = Time::Nanos() - dueNanos[i];
+				long long extreme = earliestNanos.load();
+				while(offset < extreme && !earliestNanos.compare_exchange_weak(extreme, offset)) {}
+				extreme = latestNanos.load();
+				while(offset > extreme && !latestNanos.compare_exchange_weak(extreme, offset)) {}
+				fired++;
+				return timer == nullptr;
+			});
+	}
+
+	// Cancel every fourth short timer.
+	int cancelled = 0;
+	for(int i = 1; i < timerCount; i += 4)
+	{
+		if(i % 3 != 0 && service.Cancel(handles[i]))
+		{
+			cancelled++;
+		}
+	}
+	if(service.Cancel(handles[1]) || service.Cancel(Threading::TimerService::InvalidHandle))
+	{
+		return false;
+	}
+
+	Time::Stopwatch waited;
+	while(fired.load() < timerCount - cancelled && waited.GetSeconds() < 3.0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	std::cout << "timer service earliest=" << earliestNanos.load() << "ns latest=" << latestNanos.load() << "ns\n";
+	if(fired.load() != timerCount - cancelled || service.Pending() != 0U || earliestNanos.load() < -50000LL || latestNanos.load() > 50000000LL)
+	{
+		return false;
+	}
+
+	// Repeating timers continue while the callback returns true; a fired one-shot handle is stale.
+	std::atomic<int> repeats(0);
+	Threading::TimerService::Handle repeating = service.Schedule(2000LL,
+		[&repeats](Threading::Timer*, void*) -> bool {
+			return ++repeats < 5;
+		});
+	if(service.Reschedule(handles[0], 10LL) || Threading::TimerService::InvalidHandle == repeating)
+	{
+		return false;
+	}
+
+	// Pulling a far timer in must make it fire at the new time.
+	std::atomic<bool> pulledIn(false);
+	Threading::TimerService::Handle far = service.ScheduleOnce(60000000LL,
+		[&pulledIn](Threading::Timer*, void*) -> bool {
+			pulledIn = true;
+			return false;
+		});
+	if(!service.Reschedule(far, 5000LL))
+	{
+		return false;
+	}
+
+	waited.Reset();
+	while((repeats.load() < 5 || !pulledIn.load()) && waited.GetSeconds() < 1.0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+
+	if(repeats.load() != 5 || !pulledIn.load() || service.Pending() != 0U || service.Cancel(repeating))
+	{
+		return false;
+	}
+
+	// Two timers due in the same tick each cancel the other: whichever runs first must stop the second.
+	Threading::TimerService coarse(1U, 50000LL);
+	Threading::TimerService::Handle pair[2];
+	std::atomic<int> pairRuns(0);
+	std::atomic<int> pairCancels(0);
+	for(int i = 0; i < 2; i++)
+	{
+		pair[i] = coarse.ScheduleOnce(20000LL,
+			[&coarse, &pair, &pairRuns, &pairCancels, i](Threading::Timer*, void*) -> bool {
+				pairRuns++;
+				pairCancels += coarse.Cancel(pair[1 - i]) ? 1 : 0;
+				return false;
+			});
+	}
+	std::this_thread::sleep_for(std::chrono::milliseconds(150));
+	if(pairRuns.load() != 1 || pairCancels.load() != 1 || coarse.Pending() != 0U)
+	{
+		return false;
+	}
+
+	// A timer due exactly on a 256 tick boundary is cascaded down from the second level on that tick and must
+	// fire one tick ahead of a timer due on the tick after it.
+	const long long tickNanos = 2000000LL;
+	const long long boundaryBegan = Time::Nanos();
+	Threading::TimerService boundary(1U, tickNanos / 1000LL);
+	const long long boundaryTick = ((Time::Nanos() - boundaryBegan) / tickNanos / 256LL + 2LL) * 256LL;
+	std::atomic<long long> boundaryFiredAt[2];
+	for(int i = 0; i < 2; i++)
+	{
+		boundaryFiredAt[i].store(0LL);
+		// Half a tick before the due tick, so that the rounded-up expiry lands on it.
+		const long long dueNanos = (boundaryTick + i) * tickNanos - (tickNanos / 2LL);
+		boundary.ScheduleOnce((dueNanos - (Time::Nanos() - boundaryBegan)) / 1000LL,
+			[&boundaryFiredAt, i](Threading::Timer*, void*) -> bool {
+				boundaryFiredAt[i].store(Time::Nanos());
+				return false;
+			});
+	}
+	waited.Reset();
+	while(0LL == boundaryFiredAt[1].load() && waited.GetSeconds() < 3.0)
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	return 0LL != boundaryFiredAt[0].load() && boundaryFiredAt[1].load() - boundaryFiredAt[0].load() >= tickNanos / 2LL;
+}
+
+static long long ParallelFibonacci(Threading::ThreadPool& pool, const int n)
+{
+	if(n < 12)
+	{
+		return (n < 2) ? n : ParallelFibonacci(pool, n - 1) + ParallelFibonacci(pool, n - 2);
+	}
+
+	Threading::TaskFuture<long long> left = pool.Submit([&pool, n]() { return ParallelFibonacci(pool, n - 1); });
+	const long long right = ParallelFibonacci(pool, n - 2);
+	return left.Get() + right;
+}
+
+/*
+ * Test_ThreadPool() test case for Helpers::Threading::ThreadPool
+ */
+bool Test_ThreadPool()
+{
+	Threading::ThreadPool pool(4U);
+	std::vector<Threading::TaskFuture<long long>> squares;
+
+	for(long long i = 0; i < 1000; i++)
+	{
+		squares.push_back(pool.Submit([i]() { return i * i; }));
+	}
+
+	long long sum = 0;
+	for(Threading::TaskFuture<long long>& square : squares)
+	{
+		sum += square.Get();
+	}
+
+	// Tasks that wait on the tasks they submit must not deadlock four workers.
+	if(pool.WorkerCount() != 4U || sum != 332833500LL || ParallelFibonacci(pool, 25) != 75025LL)
+	{
+		return false;
+	}
+
+	// Poll instead of Get() so that the caller does not run the task itself.
+	Threading::TaskFuture<int> workerIndex = pool.Submit([&pool]() { return pool.CurrentWorkerIndex(); });
+	while(!workerIndex.IsReady())
+	{
+		std::this_thread::yield();
+	}
+	Threading::TaskFuture<std::string> text = pool.Submit([]() { return std::string("moved"); });
+	Threading::TaskFuture<void> throws = pool.Submit([]() { throw std::runtime_error("task failed"); });
+	bool rethrown = false;
+
+	try
+	{
+		throws.Get();
+	}
+	catch(const std::runtime_error& error)
+	{
+		rethrown = std::string(error.what()) == "task failed";
+	}
+
+	if(!rethrown || workerIndex.Get() < 0 || pool.CurrentWorkerIndex() != -1 || text.Get() != "moved")
+	{
+		return false;
+	}
+
+	// Shutdown runs what is queued; later submissions run on the caller.
+	std::atomic<int> completed(0);
+	for(int i = 0; i < 200; i++)
+	{
+		pool.Submit([&completed]() { Time::WaitMicros(20); completed++; });
+	}
+	pool.Shutdown();
+	Threading::TaskFuture<int> late = pool.Submit([]() { return 7; });
+
+	return completed.load() == 200 && late.IsReady() && late.Get() == 7 && Threading::ThreadPool::Global().WorkerCount() >= 1U;
+}
+
+/*
+ * Test_ParallelAlgorithms() test case for the Helpers::Threading parallel algorithms
+ */
+bool Test_ParallelAlgorithms()
+{
+	Threading::ThreadPool pool(4U);
+	const size_t count = 200000U;
+	std::vector<int> visits(count, 0);
+
+	Threading::ParallelFor(static_cast<size_t>(0U), count, 0U, [&visits](const size_t index) { visits[index]++; }, pool);
+	if(std::count(visits.begin(), visits.end(), 1) != static_cast<long>(count))
+	{
+		return false;
+	}
+
+	const long long sum = Threading::ParallelReduce(0LL, static_cast<long long>(count), 1000U, 0LL,
+		[](const long long index) { return index; }, [](const long long a, const long long b) { return a + b; }, pool);
+
+	// The split tree depends only on the range and grain, so a floating point reduction repeats bit-exactly
+	// whatever the pool size.
+	Threading::ThreadPool single(1U);
+	std::vector<double> values(count);
+	std::mt19937 generator(12345U);
+	std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+	for(double& value : values)
+	{
+		value = distribution(generator);
+	}
+	auto element = [&values](const size_t index) { return values[index]; };
+	auto add = [](const double a, const double b) { return a + b; };
+	const double wide = Threading::ParallelReduce(static_cast<size_t>(0U), count, 0U, 0.0, element, add, pool);
+	const double narrow = Threading::ParallelReduce(static_cast<size_t>(0U), count, 0U, 0.0, element, add, single);
+
+	if(sum != static_cast<long long>(count) * (static_cast<long long>(count) - 1LL) / 2LL || wide != narrow
+		|| std::fabs(wide - std::accumulate(values.begin(), values.end(), 0.0)) > 1e-9)
+	{
+		return false;
+	}
+
+	std::vector<double> squares(count);
+	if(Threading::ParallelTransform(values.begin(), values.end(), squares.begin(), [](const double value) { return value * value; }, 0U, pool) != squares.end())
+	{
+		return false;
+	}
+	for(size_t i = 0; i < count; i++)
+	{
+		if(squares[i] != values[i] * values[i])
+		{
+			return false;
+		}
+	}
+
+	// Sorting by a coarse key must keep equal keys in their original order, exactly like std::stable_sort.
+	std::vector<std::pair<int, size_t>> records(count);
+	for(size_t i = 0; i < count; i++)
+	{
+		records[i] = std::make_pair(static_cast<int>(generator() % 1000U), i);
+	}
+	std::vector<std::pair<int, size_t>> expected(records);
+	auto byKey = [](const std::pair<int, size_t>& a, const std::pair<int, size_t>& b) { return a.first < b.first; };
+	std::stable_sort(expected.begin(), expected.end(), byKey);
+	Threading::ParallelSort(records.begin(), records.end(), byKey, 0U, pool);
+
+	// A grain of one splits merges down to single elements, including runs of equal keys.
+	std::vector<std::pair<int, size_t>> tiny(records.begin(), records.begin() + 64);
+	for(size_t i = 0; i < tiny.size(); i++)
+	{
+		tiny[i] = std::make_pair(static_cast<int>(generator() % 8U), i);
+	}
+	std::vector<std::pair<int, size_t>> tinyExpected(tiny);
+	std::stable_sort(tinyExpected.begin(), tinyExpected.end(), byKey);
+	Threading::ParallelSort(tiny.begin(), tiny.end(), byKey, 1U, pool);
+
+	std::vector<std::string> words;
+	for(int i = 0; i < 5000; i++)
+	{
+		words.push_back(Text::Stringf("w%d", static_cast<int>(generator() % 100000U)));
+	}
+	std::vector<std::string> sortedWords(words);
+	std::sort(sortedWords.begin(), sortedWords.end());
+	Threading::ParallelSort(words.begin(), words.end());
+
+	return records == expected && tiny == tinyExpected && words == sortedWords;
+}
+
+/*
+ * Test_SpscQueue() test case for Helpers::Threading::SpscQueue
+ */
+bool Test_SpscQueue()
+{
+	Threading::SpscQueue<int> queue(1000U);
+	int value = 0;
+
+	if(queue.Capacity() != 1024U || !queue.Empty() || queue.TryPop(value))
+	{
+		return false;
+	}
+
+	for(int i = 0; i < 1024; i++)
+	{
+		if(!queue.TryPush(i))
+		{
+			return false;
+		}
+	}
+	if(queue.TryPush(1024) || queue.Size() != 1024U || !queue.TryPop(value) || value != 0)
+	{
+		return false;
+	}
+
+	// Bulk transfers wrap around the end of the ring.
+	std::vector<int> drained(1023);
+	std::vector<int> batch(1000);
+	for(int i = 0; i < 1000; i++)
+	{
+		batch[i] = 5000 + i;
+	}
+	if(queue.TryPopBulk(drained.data(), drained.size()) != 1023U || drained[0] != 1 || drained[1022] != 1023
+		|| queue.TryPushBulk(batch.data(), batch.size()) != 1000U || queue.TryPopBulk(drained.data(), drained.size()) != 1000U
+		|| !std::equal(batch.begin(), batch.end(), drained.begin()))
+	{
+		return false;
+	}
+
+	// Zero-copy writes and reads stop at the end of the ring.
+	int* slots = nullptr;
+	const size_t reserved = queue.ReserveWrite(100U, slots);
+	for(size_t i = 0; i < reserved; i++)
+	{
+		slots[i] = static_cast<int>(i);
+	}
+	queue.CommitWrite(reserved);
+	const size_t peeked = queue.PeekRead(100U, slots);
+	if(reserved != 24U || peeked != 24U || slots[23] != 23)
+	{
+		return false;
+	}
+	queue.CommitRead(peeked);
+
+	Threading::SpscQueue<std::string> strings(4U);
+	std::string text;
+	if(!strings.TryEmplace(3U, 'x') || !strings.WaitPop(text, 1000LL) || text != "xxx" || strings.WaitPop(text, 1000LL))
+	{
+		return false;
+	}
+
+	// A consumer blocked on an empty queue sleeps instead of burning the core.
+	Threading::SpscQueue<int> idle(16U);
+	int woken = 0;
+	const std::clock_t cpuBegan = std::clock();
+	std::thread sleeper([&idle, &woken]() { idle.WaitPop(woken); });
+	std::this_thread::sleep_for(std::chrono::milliseconds(200));
+	idle.TryPush(7);
+	sleeper.join();
+	if(woken != 7 || std::clock() - cpuBegan > CLOCKS_PER_SEC / 20)
+	{
+		return false;
+	}
+
+	const long long transfers = 5000000LL;
+	long long received = 0;
+	long long checksum = 0;
+	bool ordered = true;
+	const long long began = Time::Nanos();
+
+	std::thread consumer([&]() {
+		int items[256];
+		while(received < transfers)
+		{
+			const size_t count = queue.TryPopBulk(items, 256U);
+			for(size_t i = 0; i < count; i++)
+			{
+				ordered = ordered && (items[i] == static_cast<int>(received));
+				checksum += items[i];
+				received++;
+			}
+			if(0U == count && queue.WaitPop(items[0]))
+			{
+				ordered = ordered && (items[0] == static_cast<int>(received));
+				checksum += items[0];
+				received++;
+			}
+		}
+	});
+
+	for(long long i = 0; i < transfers; i++)
+	{
+		queue.WaitPush(static_cast<int>(i));
+	}
+	consumer.join();
+
+	const double seconds = static_cast<double>(Time::Nanos() - began) / 1e9;
+	std::cout << "spsc " << static_cast<double>(transfers) / seconds / 1e6 << "M ops/s\n";
+
+	return ordered && received == transfers && checksum == transfers * (transfers - 1LL) / 2LL && queue.Empty();
+}
+
+/*
+ * Test_MpmcQueue() test case for Helpers::Threading::MpmcQueue and the futex wrappers
+ */
+bool Test_MpmcQueue()
+{
+	std::atomic<unsigned int> word(0U);
+	std::thread sleeper([&word]() {
+		while(0U == word.load())
+		{
+			Threading::FutexWait(word, 0U);
+		}
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	word.store(1U);
+	Threading::FutexWakeAll(word);
+	sleeper.join();
+
+	Time::Stopwatch timeout;
+	if(!Threading::FutexWait(word, 0U, 100000LL) || Threading::FutexWait(word, 1U, 2000LL) || timeout.Get() < 2000LL)
+	{
+		return false;
+	}
+
+	Threading::MpmcQueue<std::string> strings(3U);
+	std::string text;
+	if(strings.Capacity() != 4U || !strings.TryEmplace(2U, 'a') || !strings.TryPush("b") || !strings.TryPush(std::string("c"))
+		|| !strings.TryPush("d") || strings.TryPush("e") || strings.Size() != 4U || !strings.TryPop(text) || text != "aa")
+	{
+		return false;
+	}
+
+	// Remaining strings are destroyed with the queue; a bulk pop stops at the last ready item.
+	std::string popped[8];
+	if(strings.TryPopBulk(popped, 8U) != 3U || popped[0] != "b" || popped[2] != "d" || strings.TryPop(text)
+		|| strings.WaitPop(text, 2000LL) || strings.TryPushBulk(popped, 8U) != 4U)
+	{
+		return false;
+	}
+
+	const int producers = 4;
+	const int consumers = 4;
+	const long long perProducer = 250000LL;
+	Threading::MpmcQueue<long long> queue(1024U);
+	std::atomic<long long> received(0);
+	std::atomic<long long> checksum(0);
+	std::atomic<bool> ordered(true);
+	std::vector<std::thread> threads;
+	const long long began = Time::Nanos();
+
+	for(int c = 0; c < consumers; c++)
+	{
+		threads.push_back(std::thread([&]() {
+			std::vector<long long> lastSeen(producers, -1LL);
+			long long items[64];
+			while(received.load() < producers * perProducer)
+			{
+				const size_t count = queue.WaitPopBulk(items, 64U, 1000LL);
+				for(size_t i = 0; i < count; i++)
+				{
+					// A FIFO queue hands each consumer a producer's items in increasing order.
+					const int producer = static_cast<int>(items[i] % producers);
+					if(items[i] <= lastSeen[producer])
+					{
+						ordered = false;
+					}
+					lastSeen[producer] = items[i];
+					checksum += items[i];
+				}
+				received += static_cast<long long>(count);
+			}
+		}));
+	}
+	for(int p = 0; p < producers; p++)
+	{
+		threads.push_back(std::thread([&queue, p, perProducer]() {
+			for(long long i = 0; i < perProducer; i++)
+			{
+				queue.WaitPush((i * producers) + p);
+			}
+		}));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	const long long total = producers * perProducer;
+	std::cout << "mpmc " << static_cast<double>(total) / (static_cast<double>(Time::Nanos() - began) / 1e9) / 1e6 << "M ops/s\n";
+
+	return ordered.load() && received.load() == total && checksum.load() == total * (total - 1LL) / 2LL && queue.Size() == 0U;
+}
+
+/*
+ * Test_TaskGraph() test case for Helpers::Threading::TaskGraph
+ */
+bool Test_TaskGraph()
+{
+	Threading::ThreadPool pool(4U);
+	Threading::TaskGraph graph(pool);
+	std::mutex orderMutex;
+	std::vector<std::string> order;
+	auto stage = [&](const std::string& name, const long long micros) {
+		return [&, name, micros]() {
+			Time::WaitMicros(micros);
+			std::lock_guard<std::mutex> lock(orderMutex);
+			order.push_back(name);
+		};
+	};
+
+	// read -> (parse, checksum) -> write, with checksum the long branch.
+	const Threading::TaskGraph::NodeId read = graph.AddNode("read", stage("read", 1000));
+	const Threading::TaskGraph::NodeId parse = graph.Then(read, "parse", stage("parse", 1000));
+	const Threading::TaskGraph::NodeId checksum = graph.Then(read, "checksum", stage("checksum", 5000));
+	const Threading::TaskGraph::NodeId write = graph.Then(parse, "write", stage("write", 1000));
+	graph.AddDependency(write, checksum);
+	graph.Run();
+
+	const std::vector<Threading::TaskGraph::NodeId> critical = graph.CriticalPath();
+	if(order.size() != 4U || order.front() != "read" || order.back() != "write" || !graph.Stats(write).ran
+		|| graph.Stats(write).startNanos < graph.Stats(checksum).endNanos || graph.Stats(checksum).durationNanos < 4500000LL
+		|| critical.size() != 3U || critical[0] != read || critical[1] != checksum || critical[2] != write
+		|| graph.CriticalPathNanos() < 6500000LL)
+	{
+		return false;
+	}
+
+	// A failing node skips what depends on it and Run() rethrows; independent nodes still run.
+	order.clear();
+	Threading::TaskGraph failing(pool);
+	const Threading::TaskGraph::NodeId broken = failing.AddNode("broken", []() { throw std::runtime_error("stage failed"); });
+	const Threading::TaskGraph::NodeId downstream = failing.Then(broken, "downstream", stage("downstream", 0));
+	bool rethrown = false;
+	try
+	{
+		failing.Run();
+	}
+	catch(const std::runtime_error&)
+	{
+		rethrown = true;
+	}
+	if(!rethrown || !failing.Stats(broken).failed || !failing.Stats(downstream).skipped || !order.empty())
+	{
+		return false;
+	}
+
+	// Cancelling from inside a node stops the rest of the chain.
+	Threading::TaskGraph chain(pool);
+	Threading::TaskGraph::NodeId previous = chain.AddNode("first", [&chain]() { chain.Cancel(); });
+	for(int i = 0; i < 10; i++)
+	{
+		previous = chain.Then(previous, "next", stage("next", 0));
+	}
+	chain.Run();
+	if(!chain.IsCancelled() || !chain.Stats(previous).skipped || !order.empty())
+	{
+		return false;
+	}
+
+	// Cycles are rejected before anything runs.
+	Threading::TaskGraph cyclic(pool);
+	const Threading::TaskGraph::NodeId a = cyclic.AddNode("a", stage("a", 0));
+	const Threading::TaskGraph::NodeId b = cyclic.Then(a, "b", stage("b", 0));
+	cyclic.AddDependency(a, b);
+	try
+	{
+		cyclic.Run();
+		return false;
+	}
+	catch(const std::logic_error&)
+	{
+	}
+
+	// A wide fan-out settles every node.
+	Threading::TaskGraph wide(pool);
+	std::atomic<int> leaves(0);
+	const Threading::TaskGraph::NodeId root = wide.AddNode("root", nullptr);
+	for(int i = 0; i < 1000; i++)
+	{
+		wide.Then(root, "leaf", [&leaves]() { leaves++; });
+	}
+	wide.Run();
+	wide.Run();
+
+	// A Cancel() before Run() skips that run only; the run after it is unaffected.
+	wide.Cancel();
+	wide.Run();
+	if(leaves.load() != 2000 || !wide.IsCancelled() || !wide.Stats(root).skipped)
+	{
+		return false;
+	}
+	wide.Run();
+
+	return leaves.load() == 3000 && !wide.IsCancelled() && wide.Stats(root).ran && order.empty();
+}
+
+/*
+ * Test_ThreadConfig() test case for Helpers::Threading::ThreadConfig and CpuTopology
+ */
+bool Test_ThreadConfig()
+{
+	const Threading::CpuTopology topology = Threading::CpuTopology::Query();
+	if(topology.cpus.empty() || topology.PhysicalCoreCount() < 1 || topology.PhysicalCoreCount() > static_cast<int>(topology.cpus.size()) ||
+		topology.NumaNodeCount() < 1 || topology.CpusOfNode(topology.cpus[0].numaNode).empty())
+	{
+		return false;
+	}
+	for(const Threading::CpuTopology::Cpu& cpu : topology.cpus)
+	{
+		if(std::find(cpu.siblings.begin(), cpu.siblings.end(), cpu.id) == cpu.siblings.end())
+		{
+			return false;
+		}
+	}
+
+#if defined(__linux__)
+	// Pin a thread to the last core and name it.
+	const int cpu = topology.OnePerCore().back();
+	Threading::ThreadConfig config;
+	config.cpus.push_back(cpu);
+	config.name = "helpers-pinned-thread";
+	bool applied = false;
+	int ranOn = -1;
+	std::string name;
+	std::thread pinned([&]() {
+		applied = Threading::ApplyThreadConfig(config);
+		ranOn = Threading::CurrentCpu();
+		name = Threading::CurrentThreadName();
+	});
+	pinned.join();
+	if(!applied || ranOn != cpu || name != "helpers-pinned-")
+	{
+		return false;
+	}
+
+	// Real-time priority needs privileges; only check that the call reports its result without throwing.
+	std::thread realtime([]() {
+		Threading::ThreadConfig fifo;
+		fifo.policy = Threading::ThreadConfig::Policy::Fifo;
+		fifo.priority = 10;
+		std::cout << "SCHED_FIFO " << (Threading::ApplyThreadConfig(fifo) ? "applied" : "not permitted") << "\n";
+	});
+	realtime.join();
+
+	// Timer and pool threads apply their configs when they start.
+	Threading::Timer timer;
+	config.name = "helpers-timer";
+	timer.SetThreadConfig(config);
+	std::string timerName;
+	timer.Begin(1U, [&timerName](Threading::Timer*, void*) -> bool {
+		timerName = Threading::CurrentThreadName();
+		return false;
+	});
+	while(timer.Running())
+	{
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	timer.End();
+	if(timerName != "helpers-timer")
+	{
+		return false;
+	}
+
+	std::vector<Threading::ThreadConfig> workerConfigs(2U);
+	workerConfigs[0].name = "helpers-w0";
+	workerConfigs[1].name = "helpers-w1";
+	workerConfigs[1].numaNode = topology.cpus[0].numaNode;
+	Threading::ThreadPool pool(workerConfigs);
+	std::vector<std::string> names;
+	std::mutex namesMutex;
+	for(int i = 0; i < 64; i++)
+	{
+		pool.Submit([&]() {
+			if(pool.CurrentWorkerIndex() >= 0)
+			{
+				std::lock_guard<std::mutex> lock(namesMutex);
+				names.push_back(Threading::CurrentThreadName());
+			}
+		});
+	}
+	pool.Shutdown();
+	if(pool.WorkerCount() != 2U)
+	{
+		return false;
+	}
+	for(const std::string& workerName : names)
+	{
+		if(workerName != "helpers-w0" && workerName != "helpers-w1")
+		{
+			return false;
+		}
+	}
+#endif
+
+	return true;
+}
+
+/*
+ * Test_Locks() helper: increments a plain counter under lock from several threads and reports the throughput
+ */
+template<typename L>
+static bool CountUnderLock(const char* name)
+{
+	L mutex;
+	long long counter = 0LL;
+	const int threads = 4;
+	const int iterations = 100000;
+	std::vector<std::thread> workers;
+	const long long began = Time::Nanos();
+
+	for(int t = 0; t < threads; t++)
+	{
+		workers.push_back(std::thread([&]() {
+			for(int i = 0; i < iterations; i++)
+			{
+				std::unique_lock<L> lock(mutex);
+				counter++;
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	std::cout << name << " " << static_cast<double>(Time::Nanos() - began) / (threads * iterations) << " ns/lock\n";
+	if(!mutex.try_lock())
+	{
+		return false;
+	}
+	const bool reentered = mutex.try_lock();
+	mutex.unlock();
+	return !reentered && counter == static_cast<long long>(threads) * iterations;
+}
+
+/*
+ * Test_Locks() test case for Helpers::Threading lock primitives
+ */
+bool Test_Locks()
+{
+	if(!CountUnderLock<std::mutex>("std::mutex") || !CountUnderLock<Threading::AdaptiveMutex>("AdaptiveMutex") ||
+		!CountUnderLock<Threading::TicketLock>("TicketLock") || !CountUnderLock<Threading::RWSpinLock>("RWSpinLock"))
+	{
+		return false;
+	}
+
+	// Readers never observe a half-written pair, under either the seqlock or the shared side of the RW lock.
+	struct Pair
+	{
+		long long value;
+		long long negated;
+	};
+	Threading::SeqLock<Pair> snapshot;
+	Threading::RWSpinLock rwLock;
+	Pair shared = { 0LL, 0LL };
+	std::atomic<bool> stop(false);
+	std::atomic<bool> torn(false);
+	std::vector<std::thread> readers;
+
+	for(int r = 0; r < 3; r++)
+	{
+		readers.push_back(std::thread([&]() {
+			while(!stop.load())
+			{
+				const Pair copy = snapshot.Load();
+				if(copy.value != -copy.negated)
+				{
+					torn.store(true);
+				}
+				rwLock.lock_shared();
+				if(shared.value != -shared.negated)
+				{
+					torn.store(true);
+				}
+				rwLock.unlock_shared();
+			}
+		}));
+	}
+	for(long long i = 1LL; i <= 20000LL; i++)
+	{
+		snapshot.Update([i](Pair& pair) {
+			pair.value = i;
+			pair.negated = -i;
+		});
+		std::lock_guard<Threading::RWSpinLock> lock(rwLock);
+		shared.value = i;
+		shared.negated = -i;
+	}
+	stop.store(true);
+	for(std::thread& reader : readers)
+	{
+		reader.join();
+	}
+
+	// A pending writer blocks new readers.
+	Threading::RWSpinLock pending;
+	pending.lock_shared();
+	std::thread writer([&pending]() {
+		pending.lock();
+		pending.unlock();
+	});
+	while(pending.try_lock_shared())
+	{
+		pending.unlock_shared();
+		std::this_thread::yield();
+	}
+	pending.unlock_shared();
+	writer.join();
+
+	// Ticket order: the holder's successor is the thread that queued first.
+	Threading::TicketLock ticket;
+	std::vector<int> order;
+	ticket.lock();
+	std::vector<std::thread> queued;
+	for(int t = 0; t < 3; t++)
+	{
+		queued.push_back(std::thread([&ticket, &order, t]() {
+			ticket.lock();
+			order.push_back(t);
+			ticket.unlock();
+		}));
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+	ticket.unlock();
+	for(std::thread& thread : queued)
+	{
+		thread.join();
+	}
+
+	return !torn.load() && snapshot.Load().value == 20000LL && snapshot.Version() == 20000U && order == std::vector<int>({ 0, 1, 2 });
+}
+
+/*
+ * Test_SyncPrimitives() test case for Helpers::Threading Event, Latch, Barrier and Semaphore
+ */
+bool Test_SyncPrimitives()
+{
+	// Auto-reset events release one waiter per Set; manual-reset events stay set.
+	Threading::Event autoEvent;
+	std::atomic<int> released(0);
+	std::vector<std::thread> waiters;
+	for(int i = 0; i < 3; i++)
+	{
+		waiters.push_back(std::thread([&]() {
+			autoEvent.Wait();
+			released++;
+		}));
+	}
+	for(int i = 0; i < 3; i++)
+	{
+		const int before = released.load();
+		autoEvent.Set();
+		while(released.load() == before)
+		{
+			std::this_thread::yield();
+		}
+	}
+	for(std::thread& waiter : waiters)
+	{
+		waiter.join();
+	}
+	if(released.load() != 3 || autoEvent.IsSet() || autoEvent.WaitMicros(1000LL))
+	{
+		return false;
+	}
+
+	Threading::Event manualEvent(Threading::Event::Mode::ManualReset);
+	const long long timeoutStart = Time::Nanos();
+	if(manualEvent.WaitMicros(20000LL) || Time::Nanos() - timeoutStart < 19000000LL)
+	{
+		return false;
+	}
+	manualEvent.Set();
+	if(!manualEvent.WaitMicros(0LL) || !manualEvent.IsSet())
+	{
+		return false;
+	}
+	manualEvent.Reset();
+
+	// A latch opens once every worker has counted down.
+	Threading::Latch latch(4U);
+	std::atomic<int> done(0);
+	std::vector<std::thread> workers;
+	for(int i = 0; i < 4; i++)
+	{
+		workers.push_back(std::thread([&]() {
+			done++;
+			latch.CountDown();
+		}));
+	}
+	latch.Wait();
+	const bool latchOpen = latch.TryWait() && done.load() == 4;
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	if(!latchOpen)
+	{
+		return false;
+	}
+
+	// No thread enters a barrier phase before every thread finished the previous one.
+	const unsigned int participants = 4U;
+	const int phases = 200;
+	Threading::Barrier barrier(participants);
+	std::atomic<int> arrivals(0);
+	std::atomic<int> serial(0);
+	std::atomic<bool> overtaken(false);
+	workers.clear();
+	for(unsigned int t = 0U; t < participants; t++)
+	{
+		workers.push_back(std::thread([&]() {
+			for(int phase = 0; phase < phases; phase++)
+			{
+				arrivals++;
+				if(barrier.ArriveAndWait())
+				{
+					serial++;
+				}
+				if(arrivals.load() < static_cast<int>(participants) * (phase + 1))
+				{
+					overtaken.store(true);
+				}
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	if(overtaken.load() || serial.load() != phases)
+	{
+		return false;
+	}
+
+	// A semaphore bounds concurrency.
+	Threading::Semaphore slots(2U);
+	std::atomic<int> inside(0);
+	std::atomic<int> maxInside(0);
+	workers.clear();
+	for(int t = 0; t < 6; t++)
+	{
+		workers.push_back(std::thread([&]() {
+			for(int i = 0; i < 200; i++)
+			{
+				slots.Acquire();
+				const int now = ++inside;
+				int seen = maxInside.load();
+				while(now > seen && !maxInside.compare_exchange_weak(seen, now))
+				{
+				}
+				inside--;
+				slots.Release();
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	if(maxInside.load() > 2 || slots.Available() != 2U || !slots.TryAcquire() || !slots.TryAcquire() || slots.TryAcquireMicros(1000LL))
+	{
+		return false;
+	}
+
+	// Timer start-up no longer sleeps.
+	Threading::Timer timer;
+	const long long beginAt = Time::Nanos();
+	timer.Begin(50U, [](Threading::Timer*, void*) -> bool { return true; });
+	const bool running = timer.Running();
+	const long long startupNanos = Time::Nanos() - beginAt;
+	timer.End();
+	std::cout << "timer startup " << startupNanos << "ns\n";
+
+	return running && !timer.Running() && startupNanos < 5000000LL;
+}
+
+/*
+ * Test_Memory() test case for Helpers::Memory arena and slab allocators
+ */
+bool Test_Memory()
+{
+	// Allocations are aligned and do not overlap; oversized and over-aligned requests get their own block.
+	Memory::Arena arena(4096U);
+	std::vector<std::pair<char*, size_t>> blocks;
+	for(size_t i = 1U; i < 2000U; i += 7U)
+	{
+		const size_t alignment = static_cast<size_t>(1U) << (i % 8U);
+		char* p = static_cast<char*>(arena.Allocate(i, alignment));
+		if(0U != reinterpret_cast<uintptr_t>(p) % alignment)
+		{
+			return false;
+		}
+		memset(p, static_cast<int>(i & 0xFFU), i);
+		blocks.push_back(std::make_pair(p, i));
+	}
+	void* big = arena.Allocate(100000U);
+	void* page = arena.Allocate(64U, 4096U);
+	if(0U != reinterpret_cast<uintptr_t>(page) % 4096U || nullptr == big)
+	{
+		return false;
+	}
+	for(const std::pair<char*, size_t>& block : blocks)
+	{
+		for(size_t j = 0U; j < block.second; j++)
+		{
+			if(static_cast<unsigned char>(block.first[j]) != (block.second & 0xFFU))
+			{
+				return false;
+			}
+		}
+	}
+
+	// After Reset the same work is served from the retained blocks.
+	const size_t blockCount = arena.BlockCount();
+	const size_t reserved = arena.BytesReserved();
+	for(int round = 0; round < 3; round++)
+	{
+		arena.Reset();
+		if(0U != arena.BytesUsed())
+		{
+			return false;
+		}
+		for(size_t i = 1U; i < 2000U; i += 7U)
+		{
+			arena.Allocate(i, static_cast<size_t>(1U) << (i % 8U));
+		}
+		arena.Allocate(100000U);
+		arena.Allocate(64U, 4096U);
+	}
+	if(arena.BlockCount() != blockCount || arena.BytesReserved() != reserved || arena.BytesUsed() < 100000U)
+	{
+		return false;
+	}
+
+	// Huge page arenas fall back to regular pages when none are available.
+	Memory::Arena hugeArena(1U << 20, true);
+	memset(hugeArena.Allocate(3U << 20), 0xA5, 3U << 20);
+	if(hugeArena.BytesReserved() < (3U << 20))
+	{
+		return false;
+	}
+
+	// Containers and Text overloads on an arena match their heap counterparts.
+	Memory::Arena request;
+	Memory::ArenaVector<int> numbers{Memory::ArenaAllocator<int>(request)};
+	for(int i = 0; i < 1000; i++)
+	{
+		numbers.push_back(i);
+	}
+	const Memory::ArenaString formatted = Text::Stringf(request, "%s=%d;%08x", "key", -42, 0xBEEFU);
+	const Memory::ArenaString replaced = Text::StringReplace(request, "a,b,,c,", ",", ", ");
+	const Memory::ArenaVector<Memory::ArenaString> split = Text::StringSplit(request, "one::two::::three", "::");
+	const std::vector<std::string> heapSplit = Text::StringSplit("one::two::::three", "::");
+	const unsigned char bytes[] = "Arena\n\x01\x02 hex table spanning more than one row";
+	const Memory::ArenaString table = Text::HexTable(request, bytes, sizeof(bytes));
+	if(numbers[999] != 999 || std::string(formatted.c_str()) != Text::Stringf("%s=%d;%08x", "key", -42, 0xBEEFU) ||
+		std::string(replaced.c_str()) != Text::StringReplace("a,b,,c,", ",", ", ") || split.size() != heapSplit.size() ||
+		std::string(table.c_str()) != Text::HexTable(bytes, sizeof(bytes)) || 0U != Text::StringSplit(request, "", ",").size())
+	{
+		return false;
+	}
+	for(size_t i = 0U; i < split.size(); i++)
+	{
+		if(std::string(split[i].c_str()) != heapSplit[i])
+		{
+			return false;
+		}
+	}
+
+	// Slab memory can be freed on another thread and reused.
+	std::vector<void*> allocated;
+	for(size_t size = 0U; size <= Memory::SlabMaxSize + 16U; size += 24U)
+	{
+		void* p = Memory::SlabAllocate(size);
+		memset(p, 0x5A, size);
+		if(0U != reinterpret_cast<uintptr_t>(p) % 16U)
+		{
+			return false;
+		}
+		allocated.push_back(p);
+	}
+	std::thread releaser([&allocated]() {
+		size_t size = 0U;
+		for(void* p : allocated)
+		{
+			Memory::SlabFree(p, size);
+			size += 24U;
+		}
+	});
+	releaser.join();
+
+	std::map<int, int, std::less<int>, Memory::SlabAllocator<std::pair<const int, int>>> map;
+	const long long began = Time::Nanos();
+	for(int round = 0; round < 100; round++)
+	{
+		for(int i = 0; i < 1000; i++)
+		{
+			map[i] = round;
+		}
+		map.clear();
+	}
+	std::cout << "slab map insert+erase " << static_cast<double>(Time::Nanos() - began) / 100000.0 << "ns\n";
+
+	std::vector<std::thread> workers;
+	std::atomic<bool> corrupted(false);
+	for(int t = 0; t < 4; t++)
+	{
+		workers.push_back(std::thread([&corrupted, t]() {
+			std::vector<unsigned char*> owned;
+			for(int i = 0; i < 20000; i++)
+			{
+				const size_t size = 1U + static_cast<size_t>((i * 131 + t) % 512);
+				unsigned char* p = static_cast<unsigned char*>(Memory::SlabAllocate(size));
+				p[0] = static_cast<unsigned char>(t);
+				p[size - 1U] = static_cast<unsigned char>(t);
+				owned.push_back(p);
+				if(owned.size() > 64U)
+				{
+					unsigned char* old = owned.front();
+					const size_t oldSize = 1U + static_cast<size_t>(((i - 64) * 131 + t) % 512);
+					if(old[0] != t || old[oldSize - 1U] != t)
+					{
+						corrupted.store(true);
+					}
+					Memory::SlabFree(old, oldSize);
+					owned.erase(owned.begin());
+				}
+			}
+			for(size_t k = 0U; k < owned.size(); k++)
+			{
+				Memory::SlabFree(owned[k], 1U + static_cast<size_t>(((20000 - static_cast<int>(owned.size()) + static_cast<int>(k)) * 131 + t) % 512));
+			}
+		}));
+	}
+	for(std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	return !corrupted.load() && map.empty();
+}
+
+/*
+ * Test_ObjectPool() helper: a message whose constructor can be made to throw
+ */
+struct PoolMessage
+{
+	long long sequence;
+	int producer;
+	char payload[48];
+
+	PoolMessage(const long long seq, const int from, const bool fail = false) :
+		sequence(seq),
+		producer(from)
+	{
+		if(fail)
+		{
+			throw std::runtime_error("message construction failed");
+		}
+		memset(payload, from, sizeof(payload));
+	}
+};
+
+/*
+ * Test_ObjectPool() test case for Helpers::Memory::ObjectPool
+ */
+bool Test_ObjectPool()
+{
+	// Pre-warmed objects are recycled without new allocations.
+	Memory::ObjectPool<PoolMessage> warm(1024U, 16U);
+	warm.Reserve(64U);
+	std::vector<PoolMessage*> held;
+	for(int round = 0; round < 10; round++)
+	{
+		for(int i = 0; i < 64; i++)
+		{
+			held.push_back(warm.Acquire(i, 0));
+		}
+		for(PoolMessage* message : held)
+		{
+			warm.Release(message);
+		}
+		held.clear();
+	}
+	Memory::ObjectPool<PoolMessage>::Stats stats = warm.GetStats();
+	if(stats.misses != 0ULL || stats.hits != 640ULL || stats.live != 0U || stats.highWater != 64U || stats.cached != 64U)
+	{
+		return false;
+	}
+
+	// A throwing constructor hands the storage back.
+	try
+	{
+		warm.Acquire(0LL, 0, true);
+		return false;
+	}
+	catch(const std::runtime_error&)
+	{
+	}
+	if(warm.GetStats().live != 0U || warm.Trim(1000U) == 0U)
+	{
+		return false;
+	}
+
+	// Releasing beyond maxCached frees the excess, at most one batch per Release.
+	Memory::ObjectPool<PoolMessage> bounded(16U, 8U);
+	for(int i = 0; i < 200; i++)
+	{
+		held.push_back(bounded.Acquire(i, 0));
+	}
+	for(PoolMessage* message : held)
+	{
+		bounded.Release(message);
+	}
+	held.clear();
+	stats = bounded.GetStats();
+	if(stats.live != 0U || stats.highWater != 200U || stats.freed < 150U || stats.cached > 16U + 2U * 8U)
+	{
+		return false;
+	}
+
+	// Trims racing with pops from the global list only free nodes that no pop can still read.
+	Memory::ObjectPool<PoolMessage> churned(8U, 4U);
+	std::atomic<bool> churnDone(false);
+	std::atomic<bool> churnCorrupted(false);
+	std::vector<std::thread> churners;
+	for(int t = 0; t < 4; t++)
+	{
+		churners.push_back(std::thread([&churned, &churnCorrupted, t]() {
+			std::vector<PoolMessage*> mine;
+			for(int round = 0; round < 2000; round++)
+			{
+				for(int i = 0; i < 16; i++)
+				{
+					mine.push_back(churned.Acquire(i, t + 1));
+				}
+				for(PoolMessage* message : mine)
+				{
+					if(message->payload[47] != t + 1)
+					{
+						churnCorrupted.store(true);
+					}
+					churned.Release(message);
+				}
+				mine.clear();
+			}
+		}));
+	}
+	std::thread trimmer([&churned, &churnDone]() {
+		while(!churnDone.load())
+		{
+			churned.Trim(4U);
+		}
+	});
+	for(std::thread& thread : churners)
+	{
+		thread.join();
+	}
+	churnDone.store(true);
+	trimmer.join();
+	if(churnCorrupted.load() || churned.GetStats().live != 0U)
+	{
+		return false;
+	}
+
+	// Messages created by producers and released by consumers reach a steady state without allocating.
+	Memory::ObjectPool<PoolMessage> pool(4096U, 32U);
+	Threading::MpmcQueue<PoolMessage*> queue(1024U);
+	const int producers = 2;
+	const int consumers = 2;
+	const long long perProducer = 50000LL;
+	std::atomic<bool> corrupted(false);
+	std::atomic<long long> received(0LL);
+	std::vector<std::thread> threads;
+	const long long began = Time::Nanos();
+
+	for(int p = 0; p < producers; p++)
+	{
+		threads.push_back(std::thread([&, p]() {
+			for(long long i = 0LL; i < perProducer; i++)
+			{
+				queue.WaitPush(pool.Acquire(i, p + 1));
+			}
+		}));
+	}
+	for(int c = 0; c < consumers; c++)
+	{
+		threads.push_back(std::thread([&]() {
+			PoolMessage* message = nullptr;
+			while(received.load() < producers * perProducer)
+			{
+				if(queue.WaitPop(message, 1000LL))
+				{
+					if(message->producer < 1 || message->producer > producers || message->payload[47] != message->producer)
+					{
+						corrupted.store(true);
+					}
+					pool.Release(message);
+					received++;
+				}
+			}
+		}));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+
+	stats = pool.GetStats();
+	std::cout << "object pool " << static_cast<double>(Time::Nanos() - began) / static_cast<double>(producers * perProducer) << "ns/message hits=" <<
+		stats.hits << " misses=" << stats.misses << " highWater=" << stats.highWater << " freed=" << stats.freed << "\n";
+
+	return !corrupted.load() && stats.live == 0U && stats.hits + stats.misses == static_cast<unsigned long long>(producers * perProducer) &&
+		stats.misses < 4096U && stats.freed == 0ULL;
+}
+
+/*
+ * Test_EventLoop() test case for Helpers::Threading::EventLoop
+ */
+bool Test_EventLoop()
+{
+#if defined(__linux__)
+	Threading::EventLoop loop;
+
+	// Echo over many socketpairs: every read callback echoes to its peer, which counts the replies.
+	const int pairCount = 200;
+	std::vector<int> sockets;
+	int echoed = 0;
+	int replies = 0;
+	for(int i = 0; i < pairCount; i++)
+	{
+		int pair[2];
+		if(0 != socketpair(AF_UNIX, SOCK_STREAM, 0, pair))
+		{
+			return false;
+		}
+		sockets.push_back(pair[0]);
+		sockets.push_back(pair[1]);
+		loop.Add(pair[1], Threading::EventLoop::Readable, [&echoed](int fd, unsigned int) {
+			char buf[64];
+			const ssize_t n = read(fd, buf, sizeof(buf));
+			if(n > 0 && write(fd, buf, static_cast<size_t>(n)) == n)
+			{
+				echoed++;
+			}
+		});
+		loop.Add(pair[0], Threading::EventLoop::Readable, [&replies](int fd, unsigned int) {
+			char buf[64];
+			if(read(fd, buf, sizeof(buf)) == 4 && 0 == memcmp(buf, "ping", 4U))
+			{
+				replies++;
+			}
+		});
+		if(write(pair[0], "ping", 4U) != 4)
+		{
+			return false;
+		}
+	}
+	for(int i = 0; i < 100 && replies < pairCount; i++)
+	{
+		loop.RunOnce(10000LL);
+	}
+	if(echoed != pairCount || replies != pairCount)
+	{
+		return false;
+	}
+
+	// Writable interest, Modify and a callback that removes its own descriptor.
+	int writableCount = 0;
+	const int writer = sockets[0];
+	loop.Remove(writer);
+	loop.Add(writer, Threading::EventLoop::Writable, [&loop, &writableCount](int fd, unsigned int events) {
+		if(events & Threading::EventLoop::Writable)
+		{
+			writableCount++;
+			loop.Remove(fd);
+		}
+	});
+	loop.RunOnce(10000LL);
+	loop.RunOnce(1000LL);
+	if(writableCount != 1 || loop.Modify(writer, Threading::EventLoop::Readable) || loop.Add(sockets[1], Threading::EventLoop::Readable, [](int, unsigned int) {}))
+	{
+		return false;
+	}
+
+	// Closing the peer reports Readable with Error or end of stream.
+	unsigned int hangupEvents = 0U;
+	loop.Remove(sockets[3]);
+	loop.Add(sockets[3], Threading::EventLoop::Readable, [&hangupEvents, &loop](int fd, unsigned int events) {
+		hangupEvents = events;
+		loop.Remove(fd);
+	});
+	close(sockets[2]);
+	loop.RunOnce(10000LL);
+	if(0U == (hangupEvents & Threading::EventLoop::Readable))
+	{
+		return false;
+	}
+
+	// One-shot and periodic timers, a cancelled timer, and a periodic timer stopping itself.
+	const long long began = Time::Nanos();
+	long long onceAt = 0LL;
+	int periodicTicks = 0;
+	int selfStopping = 0;
+	bool cancelledFired = false;
+	loop.ScheduleOnce(20000LL, [&onceAt](Threading::Timer*, void*) -> bool {
+		onceAt = Time::Nanos();
+		return false;
+	});
+	const Threading::EventLoop::Handle periodic = loop.Schedule(5000LL, [&periodicTicks](Threading::Timer* timer, void*) -> bool {
+		periodicTicks++;
+		return nullptr == timer;
+	});
+	const Threading::EventLoop::Handle cancelled = loop.ScheduleOnce(10000LL, [&cancelledFired](Threading::Timer*, void*) -> bool {
+		cancelledFired = true;
+		return false;
+	});
+	loop.Schedule(1000LL, [&selfStopping](Threading::Timer*, void*) -> bool { return ++selfStopping < 3; });
+	loop.Cancel(cancelled);
+	while(Time::Nanos() - began < 52000000LL)
+	{
+		loop.RunOnce(1000LL);
+	}
+	loop.Cancel(periodic);
+	const int ticksAtCancel = periodicTicks;
+	loop.RunOnce(12000LL);
+	std::cout << "event loop once=" << (onceAt - began) << "ns periodic=" << periodicTicks << "\n";
+	if(onceAt - began < 20000000LL || onceAt - began > 40000000LL || periodicTicks < 5 || periodicTicks > 11 || periodicTicks != ticksAtCancel ||
+		cancelledFired || selfStopping != 3)
+	{
+		return false;
+	}
+
+	// Post and Stop from other threads wake a loop blocked in Run; timers scheduled from another thread fire on the loop.
+	std::atomic<int> posted(0);
+	std::atomic<bool> remoteTimerOnLoop(false);
+	std::thread producer([&loop, &posted, &remoteTimerOnLoop]() {
+		for(int i = 0; i < 1000; i++)
+		{
+			loop.Post([&posted]() { posted++; });
+		}
+		loop.ScheduleOnce(1000LL, [&loop, &remoteTimerOnLoop](Threading::Timer*, void*) -> bool {
+			remoteTimerOnLoop.store(loop.IsLoopThread());
+			return false;
+		});
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		loop.Stop();
+	});
+	loop.Run();
+	producer.join();
+	if(loop.IsLoopThread())
+	{
+		return false;
+	}
+
+	// A timer added from another thread and cancelled on the loop thread before its posted add has run.
+	std::atomic<bool> lateCancelFired(false);
+	loop.Post([&loop, &lateCancelFired]() {
+		Threading::EventLoop::Handle remote = Threading::EventLoop::InvalidHandle;
+		std::thread scheduler([&loop, &lateCancelFired, &remote]() {
+			remote = loop.ScheduleOnce(0LL, [&lateCancelFired](Threading::Timer*, void*) -> bool {
+				lateCancelFired.store(true);
+				return false;
+			});
+		});
+		scheduler.join();
+		loop.Cancel(remote);
+	});
+	const long long lateBegan = Time::Nanos();
+	while(Time::Nanos() - lateBegan < 20000000LL)
+	{
+		loop.RunOnce(1000LL);
+	}
+	if(lateCancelFired.load())
+	{
+		return false;
+	}
+
+	for(const int fd : sockets)
+	{
+		if(fd != sockets[2])
+		{
+			loop.Remove(fd);
+			close(fd);
+		}
+	}
+	return posted.load() == 1000 && remoteTimerOnLoop.load();
+#else
+	try
+	{
+		Threading::EventLoop loop;
+		return false;
+	}
+	catch(const std::runtime_error&)
+	{
+		return true;
+	}
+#endif
+}
+
+/*
+ * Test_Io() test case for Helpers::Io and the file overloads built on it
+ */
+bool Test_Io()
+{
+	// An odd-sized file of a few megabytes so that windows, chunks and the last hex row are all partial.
+	const std::string path = "helpers_test_io.bin";
+	const std::string emptyPath = "helpers_test_io_empty.bin";
+	std::vector<unsigned char> data(5U * 1024U * 1024U + 4099U);
+	uint32_t seed = 0x9E3779B9U;
+	for(unsigned char& byte : data)
+	{
+		seed = seed * 1664525U + 1013904223U;
+		byte = static_cast<unsigned char>(seed >> 24);
+	}
+	// Appending the low bytes of the CRC register zeroes it, so both the first 4 MB window and the short file
+	// below have a CRC of 0xFFFFFFFF.
+	const size_t windowBytes = 4U * 1024U * 1024U;
+	const uint32_t windowRegister = Checksum::CRC32::Calculate(&data[0], windowBytes - 4U) ^ 0xFFFFFFFFU;
+	for(size_t i = 0U; i < 4U; i++)
+	{
+		data[windowBytes - 4U + i] = static_cast<unsigned char>(windowRegister >> (8U * i));
+	}
+	const std::string onesPath = "helpers_test_io_ones.bin";
+	std::vector<unsigned char> ones(data.begin(), data.begin() + 11);
+	const uint32_t onesRegister = Checksum::CRC32::Calculate(&ones[0], 7U) ^ 0xFFFFFFFFU;
+	for(size_t i = 0U; i < 4U; i++)
+	{
+		ones[7U + i] = static_cast<unsigned char>(onesRegister >> (8U * i));
+	}
+	{
+		std::ofstream file(onesPath.c_str(), std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&ones[0]), static_cast<std::streamsize>(ones.size()));
+	}
+	{
+		std::ofstream file(path.c_str(), std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&data[0]), static_cast<std::streamsize>(data.size()));
+		std::ofstream empty(emptyPath.c_str(), std::ios::binary);
+	}
+
+	bool pass = true;
+
+	uint32_t crc = 0U;
+	uint32_t emptyCrc = 1U;
+	pass = pass && Checksum::CRC32::CalculateFile(path, crc) && crc == Checksum::CRC32::Calculate(&data[0], data.size());
+	pass = pass && Checksum::CRC32::CalculateFile(emptyPath, emptyCrc) && emptyCrc == Checksum::CRC32::Calculate(NULL, 0U);
+	pass = pass && !Checksum::CRC32::CalculateFile("helpers_test_io_missing.bin", crc);
+	pass = pass && 0xFFFFFFFFU == Checksum::CRC32::Calculate(&data[0], windowBytes) && 0xFFFFFFFFU == Checksum::CRC32::Calculate(&ones[0], ones.size());
+	pass = pass && Checksum::CRC32::CalculateFile(onesPath, crc) && 0xFFFFFFFFU == crc;
+
+	// The table is built from pieces, so compare it with a single table over the first part of the file.
+	const size_t hexBytes = 200U * 1024U + 7U;
+	std::vector<unsigned char> head(data.begin(), data.begin() + hexBytes);
+	{
+		std::ofstream file("helpers_test_io_hex.bin", std::ios::binary);
+		file.write(reinterpret_cast<const char*>(&head[0]), static_cast<std::streamsize>(head.size()));
+	}
+	std::ostringstream hex;
+	pass = pass && Text::HexTableFile("helpers_test_io_hex.bin", hex) && hex.str() == Text::HexTable(&head[0], static_cast<unsigned int>(head.size()));
+
+#if defined(__linux__)
+	Io::MappedFile mapped(path, Io::MappedFile::Sequential | Io::MappedFile::WillNeed);
+	pass = pass && mapped.IsOpen() && mapped.Size() == data.size() && 0 == memcmp(mapped.Data(), &data[0], data.size());
+	mapped.PrefetchRange(1U, 100000U);
+	mapped.ReleaseRange(4097U, data.size());
+	pass = pass && 0 == memcmp(mapped.Data(), &data[0], data.size());
+	mapped.Close();
+
+	// procfs files report a size of zero but still have content.
+	std::ifstream versionFile("/proc/version", std::ios::binary);
+	const std::string version((std::istreambuf_iterator<char>(versionFile)), std::istreambuf_iterator<char>());
+	std::ostringstream versionHex;
+	pass = pass && !version.empty() && Checksum::CRC32::CalculateFile("/proc/version", crc) && crc == Checksum::CRC32::Calculate(version.data(), version.size());
+	pass = pass && Text::HexTableFile("/proc/version", versionHex) &&
+		versionHex.str() == Text::HexTable(reinterpret_cast<const unsigned char*>(version.data()), static_cast<unsigned int>(version.size()));
+
+	Io::MappedFile empty;
+	pass = pass && empty.Open(emptyPath) && empty.Size() == 0U && NULL == empty.Data() && !empty.Open("helpers_test_io_missing.bin") && !empty.IsOpen();
+
+	// A range starting off a chunk boundary, then a restart on the same reader to the end of the file.
+	Io::ChunkedReader reader(64U * 1024U);
+	const unsigned long long rangeOffset = 12345ULL;
+	const unsigned long long rangeLength = 1000000ULL;
+	for(int round = 0; round < 2 && pass; ++round)
+	{
+		const unsigned long long offset = round ? 70000ULL : rangeOffset;
+		const unsigned long long expected = round ? data.size() - offset : rangeLength;
+		pass = pass && reader.Open(path, offset, round ? ~0ULL : rangeLength);
+		std::vector<unsigned char> joined;
+		const unsigned char* chunk = NULL;
+		size_t size = 0U;
+		bool aligned = true;
+		while(reader.Next(chunk, size))
+		{
+			aligned = aligned && (joined.empty() || 0U == (offset + joined.size()) % (64U * 1024U));
+			joined.insert(joined.end(), chunk, chunk + size);
+		}
+		pass = pass && aligned && !reader.Failed() && joined.size() == expected &&
+			std::equal(joined.begin(), joined.end(), data.begin() + static_cast<std::ptrdiff_t>(offset));
+	}
+
+	// Closing mid-stream must not hang the reader thread.
+	pass = pass && reader.Open(path);
+	const unsigned char* chunk = NULL;
+	size_t size = 0U;
+	pass = pass && reader.Next(chunk, size);
+	reader.Close();
+	pass = pass && !reader.Open("helpers_test_io_missing.bin");
+#endif
+
+	std::remove(path.c_str());
+	std::remove(emptyPath.c_str());
+	std::remove(onesPath.c_str());
+	std::remove("helpers_test_io_hex.bin");
+	return pass;
+}
+
+/*
+ * Test_Log() test case for Helpers::Log
+ */
+bool Test_Log()
+{
+#if defined(__linux__)
+	const std::string path = "helpers_test_log.txt";
+	FILE* file = std::fopen(path.c_str(), "w+b");
+	if(NULL == file)
+	{
+		return false;
+	}
+	Log::SetOutput(fileno(file));
+	Log::SetLevel(Log::Level::Info);
+	Log::SetFullPolicy(Log::FullPolicy::Block);
+	const unsigned long long droppedBefore = Log::DroppedCount();
+
+	// Every message must read exactly as Stringf formats the same call.
+	std::vector<std::string> expected;
+#define LOG_AND_EXPECT(...) do { HELPERS_LOG_INFO(__VA_ARGS__); expected.push_back(Text::Stringf(__VA_ARGS__)); } while(false)
+	const char* name = "pool";
+	char array[16] = "array";
+	std::string temporary("copied before return");
+	HELPERS_LOG_DEBUG("filtered %d", 1);
+	LOG_AND_EXPECT("plain");
+	LOG_AND_EXPECT("%d %u %ld %zu %lld %x %08X %o %hhd", -5, 7U, -123456789L, sizeof(double), -1LL, 255U, 0xBEEFU, 8U, 'a');
+	LOG_AND_EXPECT("%s|%10s|%-10s|%.3s|%s", name, name, name, temporary.c_str(), array);
+	LOG_AND_EXPECT("%.2f %8.3e %g %G %a %f", 3.14159, 12345.678, 0.0001, 1e20, 1.5, 2.5f);
+	LOG_AND_EXPECT("%c%c %5.1f%% %*d|%-*d|%.*f|%+d|% d", 'o', 'k', 99.5, 6, 42, 4, 7, 2, 2.71828, 3, 4);
+	LOG_AND_EXPECT("%p %p", static_cast<void*>(&expected), static_cast<void*>(NULL));
+	temporary.assign("overwritten after the call");
+	HELPERS_LOG_WARNING("warning %d", 1);
+	HELPERS_LOG_ERROR("error %d", 2);
+#undef LOG_AND_EXPECT
+	Log::Flush();
+
+	// Worker threads on small rings block rather than drop, and each thread's lines stay in order.
+	const int workers = 4;
+	const int perWorker = 2000;
+	Log::SetBufferCapacity(4096U);
+	std::vector<std::thread> threads;
+	for(int worker = 0; worker < workers; worker++)
+	{
+		threads.push_back(std::thread([worker]() {
+			for(int sequence = 0; sequence < perWorker; sequence++)
+			{
+				HELPERS_LOG_INFO("worker %d sequence %d %s", worker, sequence, "padding to fill the ring faster");
+			}
+		}));
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	Log::Flush();
+	const bool blockedWithoutDrops = Log::DroppedCount() == droppedBefore;
+
+	// With the drop policy every call is either written or counted.
+	const int burst = 20000;
+	Log::SetFullPolicy(Log::FullPolicy::Drop);
+	std::thread burster([]() {
+		for(int i = 0; i < burst; i++)
+		{
+			HELPERS_LOG_INFO("burst %d", i);
+		}
+	});
+	burster.join();
+	Log::Flush();
+	const unsigned long long burstDropped = Log::DroppedCount() - droppedBefore;
+
+	Log::SetOutput(1);
+	Log::SetFullPolicy(Log::FullPolicy::Drop);
+	Log::SetBufferCapacity(256U * 1024U);
+	std::fclose(file);
+
+	std::ifstream input(path.c_str());
+	std::string line;
+	std::vector<std::string> messages;
+	std::vector<std::string> levels;
+	while(std::getline(input, line))
+	{
+		// "seconds.micros LEVEL [thread] message"
+		const std::string::size_type thread = line.find(" [");
+		const std::string::size_type message = line.find("] ", thread);
+		if(std::string::npos == thread || std::string::npos == message)
+		{
+			return false;
+		}
+		levels.push_back(line.substr(line.find(' ') + 1U, 5U));
+		messages.push_back(line.substr(message + 2U));
+	}
+	std::remove(path.c_str());
+
+	bool pass = blockedWithoutDrops && messages.size() >= expected.size() + 2U;
+	for(size_t i = 0U; pass && i < expected.size(); i++)
+	{
+		pass = messages[i] == expected[i] && levels[i] == "INFO ";
+	}
+	pass = pass && messages[expected.size()] == "warning 1" && levels[expected.size()] == "WARN " &&
+		messages[expected.size() + 1U] == "error 2" && levels[expected.size() + 1U] == "ERROR";
+
+	std::vector<int> nextSequence(workers, 0);
+	int burstLines = 0;
+	int lastBurst = -1;
+	for(size_t i = expected.size() + 2U; pass && i < messages.size(); i++)
+	{
+		int worker = 0;
+		int sequence = 0;
+		if(2 == std::sscanf(messages[i].c_str(), "worker %d sequence %d", &worker, &sequence))
+		{
+			pass = worker >= 0 && worker < workers && sequence == nextSequence[worker]++;
+		}
+		else if(1 == std::sscanf(messages[i].c_str(), "burst %d", &sequence))
+		{
+			pass = sequence > lastBurst;
+			lastBurst = sequence;
+			burstLines++;
+		}
+		else
+		{
+			pass = false;
+		}
+	}
+	for(int worker = 0; pass && worker < workers; worker++)
+	{
+		pass = perWorker == nextSequence[worker];
+	}
+	return pass && static_cast<unsigned long long>(burstLines) + burstDropped == static_cast<unsigned long long>(burst);
+#else
+	HELPERS_LOG_DEBUG("Test_Log %d", 1);
+	Log::Flush();
+	return true;
+#endif
+}